@@ -1,13 +1,19 @@
 #pragma once
 #include "mat3.hpp"
 #include "material.hpp"
+#include "merl.hpp"
 #include "texture.hpp"
 #include "vec3.hpp"
+#include <memory>
 class MERNBRDF : public Material {
     public:
         MERNBRDF (const char *filename, Texture *texture);
-        double *brdf;
+        std::shared_ptr<MerlBRDF> merl;
         Mat3 sph_basis (double theta, double phi);
         Vec3 compute (Mat3 tnb, Vec3 in_direction, Vec3 out_direction);
         Vec3 scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob) override;
+        bool evaluate (Ray r, HitRecord &record, Vec3 direction, Vec3 &brdf, double &pdf) override;
+
+        static Vec3 to_local (Mat3 tnb, Vec3 v);
+        static Vec3 to_world (Mat3 tnb, Vec3 v);
 };
\ No newline at end of file
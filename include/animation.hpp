@@ -0,0 +1,66 @@
+/**
+    @file animation.hpp
+
+    @brief Keyframed camera and object motion, so that rt can render a frame
+    sequence in one process instead of paying for startup, asset loading and
+    acceleration structure builds once per frame.
+
+    An animation file is JSON:
+
+        {
+            "frames": 48,
+            "shutter": 0.5,
+            "camera": {
+                "center": [[0, [0, 1, 2]], [47, [1, 1, 2]]],
+                "lookat": [[0, [0, 1, -1]]]
+            },
+            "objects": {
+                "glass_sphere": { "location": [[0, [0, 0.65, -1]], [47, [0.5, 0.65, -1]]] }
+            }
+        }
+
+    Keys are [frame, [x, y, z]] pairs. Values are linearly interpolated
+    between keys and held before the first and after the last key. Objects are
+    found by the name they were added to the World with (World::add). While a
+    frame is rendered, objects move from where they are at the frame to where
+    they are `shutter` frames later, which gives motion blur.
+
+    Moving an object only changes where rays are intersected with it (see
+    Object::place), so meshes keep their KDTree across frames and the World
+    BVH is refit rather than rebuilt (World::update).
+*/
+
+#pragma once
+
+#include "camera.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Track {
+    public:
+        // (frame, value), sorted by frame
+        std::vector<std::pair<double, Vec3> > keys;
+
+        bool empty ();
+        Vec3 at (double frame);
+};
+
+class Animation {
+    public:
+        int frames;
+        double shutter;
+
+        Track camera_center;
+        Track camera_lookat;
+        std::map<std::string, Track> object_locations;
+
+        Animation ();
+        Animation (const char *filename);
+
+        void apply (int frame, Camera &camera, World &world);
+        static std::string frame_filename (const char *filename, int frame, int frames);
+};
@@ -0,0 +1,116 @@
+/**
+    @file bvh.hpp
+
+    @brief Bounding volume hierarchy over the objects of a World.
+
+    Every node stores its bounds at time 0 and at time 1. Objects move
+    linearly (Object::move_to), so the bounds of a node at a ray's time are
+    the linear interpolation of the two: a moving object only widens the
+    nodes above it by as much as it has moved at that time, instead of by its
+    whole swept volume.
+
+    Nodes are stored depth first in a flat array, the left child of an inner
+    node directly follows it.
+
+    Leaves made up of spheres and quads only hold up to BVH_LEAF_WIDTH of
+    them. Their geometry is copied into structures of arrays (one vector per
+    coordinate, indexed like objects) and a leaf intersects all of its
+    spheres, then all of its quads, in fixed width loops the compiler
+    vectorizes. The lanes intersect with the same code as Sphere::hit and
+    Quad::hit (Sphere::intersect and Quad::intersect), the closest lambda
+    wins, and only the winner is called to fill in the HitRecord. Material ids are kept with the geometry, so the winner's
+    material is known without going through its object.
+*/
+
+#pragma once
+
+#include "hitrecord.hpp"
+#include "object.hpp"
+#include "ray.hpp"
+#include "vec3.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BVH {
+    public:
+        struct Node {
+                // bounds at time 0 and at time 1
+                Vec3 min0, max0;
+                Vec3 min1, max1;
+                // inner nodes: index of the right child, leaves: first object
+                size_t offset;
+                // number of objects in a leaf, 0 for inner nodes
+                int count;
+                // leading spheres and following quads of a leaf's objects
+                int spheres;
+                int quads;
+                // split axis of inner nodes
+                int axis;
+        };
+
+        /**
+                Sphere centers at time 0 and their motion up to time 1 (see
+                Object::move_to).
+         */
+        struct Spheres {
+                std::vector<double> x, y, z;
+                std::vector<double> dx, dy, dz;
+                std::vector<double> radius;
+                std::vector<uint32_t> material;
+        };
+
+        /**
+                Quad corners and unit normals. alpha = (p - corner) . a and
+                beta = (p - corner) . b are the quad coordinates of a point p
+                on its plane (see Quad::alpha_beta_axes).
+         */
+        struct Quads {
+                std::vector<double> x, y, z;
+                std::vector<double> nx, ny, nz;
+                std::vector<double> ax, ay, az;
+                std::vector<double> bx, by, bz;
+                // 1 for one sided quads, a double like the rest so that the lanes vectorize
+                std::vector<double> one_sided;
+                std::vector<uint32_t> material;
+        };
+
+        std::vector<Object *> objects;
+        std::vector<Node> nodes;
+
+        Spheres spheres;
+        Quads quads;
+
+        BVH ();
+        BVH (std::vector<Object *> objects);
+
+        /**
+                Closest hit with lambda in (lambda_min, lambda_max), lambda_max
+                is lowered to the lambda of the hit.
+         */
+        bool hit (Ray r, HitRecord &record, double lambda_min, double &lambda_max);
+
+        /**
+                Recomputes the node bounds from the current bounds of the
+                objects, keeping the tree topology. Returns the summed surface
+                area of the nodes relative to right after the build: the
+                factor by which the tree has degraded.
+         */
+        double refit ();
+
+    private:
+        double _built_area;
+
+        struct Entry {
+                Object *object;
+                Vec3 min0, max0;
+                Vec3 min1, max1;
+                Vec3 centroid;
+                Object::Primitive primitive;
+        };
+
+        size_t _build (std::vector<Entry> &entries, size_t begin, size_t end);
+        double _area ();
+        void _pack (size_t index);
+        bool _hit_leaf (Node &node, Ray &r, HitRecord &record, double lambda_min, double &lambda_max);
+};
@@ -1,3 +1,7 @@
+#pragma once
+#include "environment_light.hpp"
+#include "framebuffer.hpp"
+#include "heatmap.hpp"
 #include "light.hpp"
 #include "material.hpp"
 #include "ray.hpp"
@@ -5,6 +9,7 @@
 #include "texture.hpp"
 #include "vec3.hpp"
 #include "world.hpp"
+#include <cstdint>
 #include <iostream>
 #include <ostream>
 #include <vector>
@@ -21,31 +26,92 @@ class Camera {
                 double aspect_ratio;
                 double defocus_angle;
 
+                // where the camera is and what it looks at, vup is up in the image
+                Vec3 lookfrom;
+                Vec3 lookat;
+                Vec3 vup;
+                // distance of the plane in focus, 0 focuses on lookat
+                double focus_dist;
+                // of the image plane (a shift lens), in image widths and heights, right and up
+                double sensor_shift[2];
+
                 bool use_path_tracer;
                 bool use_light_sampling;
                 bool use_scene_sig;
                 bool use_importance_sampling;
+                bool use_wavefront;
                 Texture *background_texture;
+                // render statistics are written here as JSON, if built with RT_STATS
+                const char *stats_file;
+                // Heatmap::Kind flags of the cost heatmaps written next to the image
+                int heatmaps;
+                // 1 << FrameBuffer::AOV flags of the AOVs written next to the image
+                int aovs;
+                bool denoise;
+        };
+
+        /**
+                Rays cast by the integrators, by kind. Primary rays leave the
+                camera, secondary rays continue a path after a bounce, shadow
+                rays test the visibility of a light or environment sample.
+         */
+        struct RayCounts {
+                uint64_t primary;
+                uint64_t secondary;
+                uint64_t shadow;
+        };
+
+        /**
+                Placement and lens of the camera, what may change between the
+                views of one render (see views.hpp) without setting the
+                renderer up again.
+         */
+        struct View {
+                Vec3 lookfrom;
+                Vec3 lookat;
+                Vec3 vup;
+                double vfov;
+                double focus_dist;
+                double defocus_angle;
+                double sensor_shift[2];
         };
 
+        // rays cast by the calling thread so far
+        static thread_local RayCounts ray_counts;
+
         std::ostream &stream;
 
         Camera ();
+        ~Camera ();
         void initialize (struct RendererSettings settings);
+        void look (Vec3 center, Vec3 lookat);
+        Vec3 look_from ();
+        Vec3 look_at ();
+        View view ();
+        void set_view (View view);
         void render (World *world, const char *filename);
         void render_multithreaded (World *world, const char *filename, int max_threads);
         Ray ray (int i, int j);
-        Vec3 ray_color (Ray r, World *world, int depth);
-        Vec3 single_path_color (Ray starting_ray, World *world, int max_depth);
-        Vec3 scene_signature_color (Ray starting_ray, World *world);
+        Vec3 ray_color (Ray r, World *world, int depth, FrameBuffer::Sample *aov = nullptr);
+        Vec3 single_path_color (Ray starting_ray, World *world, int max_depth, FrameBuffer::Sample *aov = nullptr);
+        Vec3 scene_signature_color (Ray starting_ray, World *world, FrameBuffer::Sample *aov = nullptr);
+        void first_hit_aovs (Ray &r, HitRecord &record, World *world, FrameBuffer::Sample &aov);
         Vec3 sample_pixel (World *world, int i, int j);
         Vec3 sample_light_rays (World *world, HitRecord &record, Light *light, Material::PhongParams params, int K);
         Vec3 sample_light (World *world, HitRecord &record, SmoothObject *&hit_light);
+        Vec3 unoccluded_light (World *world, HitRecord &record, SmoothObject *&light, Vec3 &light_point);
+        bool sample_environment (Ray r, World *world, HitRecord &record, Vec3 &radiance);
+        bool unoccluded_environment (Ray r, HitRecord &record, Vec3 &direction, Vec3 &radiance);
+        Vec3 escaped (Ray &r, double mis_pdf);
         Vec3 defocus_disk_sample ();
+        Vec3 background (Ray &r);
         void print_arguments ();
         void export_p6 (const char *filename, std::vector<Vec3> pixels);
 
     private:
+        friend class WavefrontIntegrator;
+        friend class PreviewServer;
+
         int image_width;
         int image_height;
         int samples_per_pixel;
@@ -58,11 +124,13 @@ class Camera {
         double vfov;
         double defocus_angle;
         double focus_dist;
+        double sensor_shift[2];
 
         bool use_path_tracer;
         bool use_light_sampling;
         bool use_importance_sampling;
         bool use_scene_sig;
+        bool use_wavefront;
 
         Vec3 defocus_disk_u;
         Vec3 defocus_disk_v;
@@ -71,6 +139,17 @@ class Camera {
         Vec3 pixel_00;
         Vec3 center;
         Vec3 lookat;
+        Vec3 vup;
 
         Texture *background_texture;
+        EnvironmentLight *environment_light;
+
+        const char *stats_file;
+
+        int heatmaps;
+        Heatmap heatmap;
+
+        int aovs;
+        FrameBuffer framebuffer;
+        bool denoise;
 };
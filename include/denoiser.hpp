@@ -0,0 +1,63 @@
+/**
+    @file denoiser.hpp
+
+    @brief Edge-avoiding à-trous wavelet denoiser (Dammertz et al. 2010, with
+    the variance guided weights of SVGF, Schied et al. 2017).
+
+    Runs on the averaged beauty of a render (rt --denoise), guided by the
+    albedo, normal, depth and variance AOVs of the same pass (see
+    framebuffer.hpp). Emitters seen directly are taken out of the beauty and
+    what is left is divided by the albedo, so that only the lighting is
+    filtered: texture detail and the edges of lights stay sharp. Albedo and
+    emission are put back in at the end.
+
+    Each of DENOISER_ITERATIONS passes blends a pixel with its 5 x 5
+    neighbours 2^i pixels apart (1, 2, 4, 8, 16), so the filter reaches far
+    at the cost of 25 taps a pass. A neighbour's weight falls off with its
+    distance in
+
+        luminance  relative to the pixel's noise (the filtered variance),
+                   so flat noisy regions blur while real detail stays
+        normal     surfaces facing other ways are different surfaces
+        depth      relative to the depth gradient, so slanted planes blur
+                   but silhouettes do not
+        albedo     material edges
+
+    Pixels where nothing was hit (the background) are left as they are.
+    Passes are split into tiles that the threads take in turn.
+*/
+
+#pragma once
+
+#include "framebuffer.hpp"
+#include "vec3.hpp"
+#include <vector>
+
+class Denoiser {
+    public:
+        // the AOVs the denoiser reads, as FrameBuffer flags
+        static const int guides;
+
+        Denoiser (FrameBuffer &framebuffer);
+
+        // the denoised beauty, filtered on nthreads threads
+        std::vector<Vec3> run (int nthreads);
+
+    private:
+        int width;
+        int height;
+
+        std::vector<Vec3> emission;
+        std::vector<Vec3> albedo;
+        std::vector<Vec3> normal;
+        std::vector<double> depth;
+        // magnitude of the depth's screen space gradient
+        std::vector<double> depth_gradient;
+
+        // demodulated beauty (lighting) and the variance of its luminance, filtered pass by pass
+        std::vector<Vec3> lighting;
+        std::vector<double> variance;
+
+        void _pass (int step, int x0, int y0, int x1, int y1, std::vector<Vec3> &lighting,
+                    std::vector<double> &variance);
+};
@@ -6,6 +6,7 @@ class Dielectric : public Material {
         Dielectric (double refraction_index, double absorption);
         ~Dielectric ();
         Vec3 scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob) override;
+        void differentials (Ray &in, HitRecord &record, Ray &out) override;
 
         static double reflectance (double cosine, double refraction_index);
         double refraction_index, absorption;
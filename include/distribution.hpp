@@ -0,0 +1,44 @@
+/**
+    @file distribution.hpp
+
+    @brief Piecewise constant distributions for importance sampling
+    tabulated functions.
+
+    Distribution1D turns n non-negative values over [0, 1) into a CDF that
+    is inverted with a binary search. Distribution2D samples a
+    function over [0, 1)^2 by first picking a row v from the marginal
+    distribution of the row integrals and then u from that row's conditional
+    distribution, so that p(u, v) is proportional to f(u, v).
+*/
+
+#pragma once
+
+#include "vec3.hpp"
+#include <vector>
+
+class Distribution1D {
+    public:
+        std::vector<double> func;
+        // func.size () + 1 entries, cdf[0] = 0 and cdf[n] = 1
+        std::vector<double> cdf;
+        double integral;
+
+        Distribution1D (std::vector<double> func);
+
+        int count ();
+        double sample (double u, double &pdf, int &offset);
+        double pdf (double x);
+};
+
+class Distribution2D {
+    public:
+        Distribution2D (const std::vector<double> &func, int nu, int nv);
+
+        Vec3 sample (double u0, double u1, double &pdf);
+        double pdf (Vec3 uv);
+
+    private:
+        // one distribution per row v, then the distribution of row integrals
+        std::vector<Distribution1D> conditional;
+        Distribution1D marginal;
+};
@@ -0,0 +1,35 @@
+/**
+    @file environment_light.hpp
+
+    @brief Importance sampling of an environment map (the background
+    texture) for next-event estimation in the path tracer.
+
+    The texture is tabulated on a width x height grid over its
+    longitude/latitude parametrisation, weighted by luminance and by
+    sin(phi) to account for the squeezing of rows towards the poles, and
+    sampled with a Distribution2D. Directions map to texture coordinates the
+    same way the camera looks up the background.
+*/
+
+#pragma once
+
+#include "distribution.hpp"
+#include "texture.hpp"
+#include "vec3.hpp"
+
+class EnvironmentLight {
+    public:
+        Texture *texture;
+
+        EnvironmentLight (Texture *texture, int width, int height);
+
+        Vec3 radiance (Vec3 direction);
+        Vec3 sample (Vec3 &direction, double &pdf);
+        double pdf (Vec3 direction);
+
+        static Vec3 to_uv (Vec3 direction);
+        static Vec3 to_direction (Vec3 uv);
+
+    private:
+        Distribution2D distribution;
+};
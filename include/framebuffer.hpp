@@ -0,0 +1,80 @@
+/**
+    @file framebuffer.hpp
+
+    @brief Arbitrary output variables (AOVs): images rendered in the same
+    pass as the beauty image, for compositing and denoising. Each one is
+    written as a float image (PFM) named after the beauty image,
+    rt --aovs albedo,normal -f out.ppm writes out_albedo.pfm and
+    out_normal.pfm.
+
+    Every integrator fills in what it sees at the first hit of a camera
+    sample: albedo (texture colour), shading normal (in [-1, 1]), depth
+    (distance from the camera, 0 where nothing was hit) and object ID (1 +
+    index of the object in the World, 0 for the background). The path
+    tracer also splits the beauty into
+
+        emission   emitters and background seen directly
+        direct     light reaching the first hit straight from an emitter or the background
+        indirect   everything else (light that bounced at least once more)
+
+    which add up to the beauty. AOVs are averaged over the pixel's samples,
+    except for the object ID, which is that of the first sample, and the
+    variance, which is the variance of the beauty's average (how noisy the
+    pixel still is, per channel).
+*/
+
+#pragma once
+
+#include "vec3.hpp"
+#include <vector>
+
+class FrameBuffer {
+    public:
+        enum AOV { Beauty, Albedo, Normal, Depth, ObjectID, Emission, Direct, Indirect, Variance, Count };
+
+        // values of every AOV for one camera sample
+        struct Sample {
+                Vec3 values[AOV::Count];
+
+                Vec3 &operator[] (AOV aov)
+                {
+                        return this->values[aov];
+                }
+        };
+
+        static const char *names[AOV::Count];
+
+        FrameBuffer ();
+        // aovs is a set of 1 << AOV flags, samples the number of samples added to each pixel
+        FrameBuffer (int aovs, int width, int height, int samples);
+
+        int width;
+        int height;
+
+        // comma separated AOV names or all, -1 if one is unknown
+        static int parse (const char *aovs);
+        // writes a colour PFM, returns false if the file cannot be written
+        static bool write_pfm (const char *filename, int width, int height, std::vector<Vec3> &pixels);
+
+        bool enabled ()
+        {
+                return this->aovs != 0;
+        }
+
+        bool has (AOV aov)
+        {
+                return this->aovs & (1 << aov);
+        }
+
+        // adds a sample of pixel (i, j), first is true for its first sample
+        void add (int i, int j, Sample &sample, bool first);
+        // the averaged AOV, empty if it was not requested
+        std::vector<Vec3> buffer (AOV aov);
+        // writes one PFM per AOV of aovs, named after filename
+        void write (const char *filename, int aovs);
+
+    private:
+        int aovs;
+        int samples;
+        std::vector<Vec3> sums[AOV::Count];
+};
@@ -0,0 +1,74 @@
+/**
+    @file heatmap.hpp
+
+    @brief Per pixel cost of a render, written as false colour images next to
+    the rendered one: acceleration structure nodes visited, primitives tested
+    and CPU time spent on each pixel, over all of its samples and bounces.
+
+    rt --heatmap nodes,tests,time -f out.ppm writes out_nodes.ppm,
+    out_tests.ppm and out_time.ppm. Blue pixels are cheap, red ones are at the
+    99th percentile of the image or above, so a single outlier does not wash
+    out the rest.
+
+    Nodes and tests are read from the RT_STATS counters (see stats.hpp), the
+    time heatmap works in every build.
+*/
+
+#pragma once
+
+#include "vec3.hpp"
+#include <cstdint>
+#include <vector>
+
+class Heatmap {
+    public:
+        enum Kind { Nodes = 1 << 0, Tests = 1 << 1, Time = 1 << 2, All = Nodes | Tests | Time };
+
+        /**
+                Counters of the calling thread, the cost of a pixel is the
+                difference between two readings.
+         */
+        struct Cost {
+                uint64_t nodes;
+                uint64_t tests;
+                uint64_t ns;
+
+                static Cost now ();
+        };
+
+        Heatmap ();
+        Heatmap (int kinds, int width, int height);
+
+        // comma separated kinds (nodes, tests, time or all), -1 if one is unknown
+        static int parse (const char *kinds);
+        // blue through cyan, green and yellow to red as t goes from 0 to 1
+        static Vec3 false_colour (double t);
+
+        Cost start ()
+        {
+                return this->kinds ? Cost::now () : Cost{};
+        }
+
+        // charges pixel (i, j) with everything the calling thread did since start
+        void add (int i, int j, Cost start)
+        {
+                if (!this->kinds)
+                        return;
+
+                Cost end = Cost::now ();
+                Cost &pixel = this->costs[i + size_t (j) * this->width];
+
+                pixel.nodes += end.nodes - start.nodes;
+                pixel.tests += end.tests - start.tests;
+                pixel.ns += end.ns - start.ns;
+        }
+
+        // writes one image per kind, named after filename
+        void write (const char *filename);
+
+    private:
+        int kinds;
+        int width;
+        int height;
+        std::vector<Cost> costs;
+};
@@ -3,8 +3,15 @@
 #include "ray.hpp"
 #include "smooth_object.hpp"
 #include "vec3.hpp"
+#include <cstdint>
+#include <memory>
 
+// HitRecord::material of hits on objects without a material
+#define HIT_NO_MATERIAL UINT32_MAX
+
+class Object;
 class SmoothObject;
+class Instance;
 
 class HitRecord {
     public:
@@ -13,8 +20,35 @@ class HitRecord {
         double lambda;
         Vec3 normal;
         SmoothObject *object;
+        // set when the hit went through an Instance, object is then in object space
+        Instance *instance;
+        // object of the World that was hit, e.g. the mesh the triangle object belongs to
+        Object *root;
+        // MaterialTable id of object's material, set by World::hit (BVH leaves take it from their arrays)
+        uint32_t material;
+        // keeps object alive while the record is in use, if it can be freed meanwhile (the triangles of evicted meshes)
+        std::shared_ptr<void> owner;
         Vec3 uv;
         bool front_face;
+        // time of the ray, set by moving objects so that shading can undo their motion
+        double time;
+
+        /**
+                Footprint of the pixel around hit_point, set by differentials ()
+                for rays that carry differentials: dpdx/dpdy are the offsets
+                on the tangent plane, dudx ... dvdy the matching changes of
+                uv. Textures and normal maps use footprint () to pick a mip
+                level, geometry can use dpdx/dpdy to pick a level of detail.
+         */
+        bool has_differentials;
+        Vec3 dpdx;
+        Vec3 dpdy;
+        double dudx, dvdx, dudy, dvdy;
+
         void setNormal (Ray r, Vec3 normal);
         Vec3 outward_normal ();
+        void differentials (Ray &r);
+        void reflect_differentials (Ray &in, Ray &out);
+        void refract_differentials (Ray &in, Ray &out, double mu);
+        double footprint ();
 };
\ No newline at end of file
@@ -1,23 +1,21 @@
 #pragma once
 
+#include "mipmap.hpp"
 #include "texture.hpp"
 #include "vec3.hpp"
-#include <cstdint>
 
 class ImageTexture : public Texture {
     public:
-        struct rgb_pixel {
-                uint8_t red;
-                uint8_t green;
-                uint8_t blue;
-        };
         int image_width;
         int image_height;
         int image_channels;
-        struct rgb_pixel *pixels;
+        MipMap *mipmap;
 
         ImageTexture (const char *image_filename);
+        ~ImageTexture ();
         Vec3 read_texture_uv (Vec3 uv, Vec3 point) override;
         Vec3 read_rgb255 (Vec3 uv) override;
         Vec3 photon_map (Vec3 point) override;
-};
\ No newline at end of file
+        Vec3 lookup (Vec3 uv, Vec3 point, double width) override;
+        Vec3 lookup_rgb255 (Vec3 uv, double width) override;
+};
@@ -0,0 +1,57 @@
+/**
+    @file instance.hpp
+
+    @brief This file contains the definition of the Instance class. An
+    instance places a shared object, typically a Mesh, into the scene with its
+    own affine transform.
+
+    Meshes bake their location and scale into every triangle at load time, so
+    placing the same .obj file many times would otherwise load, store and
+    build a KDTree for every copy. An instance instead keeps a pointer to the
+    shared object (and therefore its acceleration structure) and transforms
+    incoming rays into object space.
+
+    Transforms compose in world space, in the order they are applied, in the
+    same way as Triangle::translate and Triangle::scale:
+
+        (new Instance (&bunny))->scale (0.5)->rotate (rotateY (45))->translate (Vec3 (1, 0, -2));
+
+    Only uniform scaling is supported so that tangents remain perpendicular to
+    normals. Instances of instances are not supported.
+*/
+
+#pragma once
+
+#include "hitrecord.hpp"
+#include "mat3.hpp"
+#include "object.hpp"
+#include "ray.hpp"
+#include "vec3.hpp"
+
+class Instance : public Object {
+    public:
+        Instance (Object *object);
+        Instance (Object *object, Vec3 location, double scale);
+
+        Object *object;
+
+        // object space -> world space linear part, and its inverse
+        Mat3 linear;
+        Mat3 linear_inverse;
+
+        bool hit (Ray r, HitRecord &record) override;
+        bool is_light_source () override;
+        bool bounds (double time, Vec3 &min, Vec3 &max) override;
+
+        Instance *rotate (Mat3 rotation);
+        Instance *scale (double s);
+        Instance *translate (Vec3 v);
+
+        Vec3 to_object_point (Vec3 point);
+        Vec3 to_world_vector (Vec3 v);
+        Vec3 to_world_normal (Vec3 n);
+
+    private:
+        void _update_motion (Vec3 motion);
+        void _update_inverse ();
+};
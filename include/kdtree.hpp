@@ -4,6 +4,7 @@
 #include "ray.hpp"
 #include "triangle.hpp"
 #include "vec3.hpp"
+#include <cstddef>
 #include <utility>
 #include <vector>
 class KDTree {
@@ -38,24 +39,42 @@ class KDTree {
 
         struct BoundingBoxNode {
                 BoundingBox box;
+                // only leaves hold triangles
                 std::vector<Triangle *> triangles;
                 struct BoundingBoxNode *left;
                 struct BoundingBoxNode *right;
         };
 
+        /**
+                Filled in by the triangle constructor.
+         */
+        struct BuildStats {
+                size_t nodes;
+                size_t leaves;
+                size_t max_depth;
+                // sum of leaf sizes, triangles straddling a split are counted once per leaf
+                size_t triangle_references;
+                double build_seconds;
+        };
+
+        BuildStats stats;
+
         KDTree ();
         ~KDTree ();
         KDTree (const KDTree &kdtree);
         KDTree &operator= (const KDTree &other);
         KDTree (std::vector<Vec3> points);
         KDTree (std::vector<Triangle *> triangles);
+        KDTree (std::vector<Triangle *> triangles, int nthreads);
 
         bool ray_hit (Ray r, HitRecord &record);
+        BoundingBox bounds ();
+        size_t memory_usage ();
+        void release ();
 
     private:
         struct BoundingBoxNode *bounding_box_root;
         bool _compute_bounding_box_tree_ray_hit (struct BoundingBoxNode *root, Ray r, HitRecord &record);
-        struct BoundingBoxNode *_construct_bounding_box_tree (BoundingBox box, std::vector<Triangle *> triangles);
-        BoundingBox _compute_bounding_box (std::vector<Vec3> points);
-        Vec3 _median_select (std::vector<Vec3> points, int axis);
+        size_t _memory_usage (struct BoundingBoxNode *root);
+        void _release (struct BoundingBoxNode *root);
 };
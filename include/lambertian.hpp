@@ -10,6 +10,7 @@ class Lambertian : public Material {
         Lambertian (Texture *texture);
 
         Vec3 scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob) override;
+        bool evaluate (Ray r, HitRecord &record, Vec3 direction, Vec3 &brdf, double &pdf) override;
         PhongParams phong (Ray r, HitRecord &record) override;
 
     private:
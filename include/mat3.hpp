@@ -30,6 +30,8 @@ class Mat3 {
         Mat3 (Vec3 c1, Vec3 c2, Vec3 c3);
 
         Mat3 transpose ();
+        Mat3 inverse ();
+        double determinant ();
         Vec3 operator* (Vec3 x);
         Mat3 operator* (double d);
         Mat3 operator* (Mat3 B);
@@ -3,13 +3,36 @@
 #include "ray.hpp"
 #include "texture.hpp"
 #include "vec3.hpp"
+#include <cstdint>
 
 class HitRecord;
 
+/**
+        Tag of the concrete material class, so that the renderer can switch
+        on it (see material_table.hpp) instead of calling virtual methods or
+        using RTTI.
+ */
+enum class MaterialType : uint8_t {
+        Generic,
+        Lambertian,
+        Metal,
+        Dielectric,
+        Phong,
+        Measured,
+};
+
 class Material {
     public:
         Material ();
         Material (Texture *texture, Texture *normal_map);
+        Material (MaterialType type, Texture *texture, Texture *normal_map);
+        Material (const Material &) = delete;
+        Material &operator= (const Material &) = delete;
+        virtual ~Material ();
+
+        MaterialType type;
+        // index of this material in the MaterialTable
+        uint32_t id;
         Texture *texture;
         Texture *normal_map;
         Vec3 emission_value;
@@ -30,6 +53,27 @@ class Material {
                 return Vec3 (0, 0, 0);
         }
 
+        /**
+                BRDF and scatter () pdf for r arriving at the hit and leaving
+                in the given direction, for light sampling; both are 0 below
+                the surface. Returns false for materials that can only be
+                sampled (mirrors, glass, ...).
+         */
+        virtual bool evaluate (Ray, HitRecord &, Vec3, Vec3 &, double &)
+        {
+                return false;
+        }
+
+        /**
+                Sets the ray differentials of out, the ray scatter () sent on
+                from the hit of in. Diffuse and glossy materials spread the
+                footprint so far that it is dropped.
+         */
+        virtual void differentials (Ray &, HitRecord &, Ray &out)
+        {
+                out.has_differentials = false;
+        }
+
         virtual PhongParams phong (Ray r, HitRecord &record)
         {
                 return PhongParams{ 0, 0, 0, 0, 0, 0, 0, 0, Vec3 (0, 0, 0) };
@@ -38,5 +82,5 @@ class Material {
         virtual void emission (Vec3 color);
         virtual Vec3 color (HitRecord &record);
         virtual Vec3 emission ();
-        virtual Vec3 normal (Mat3 tbn, Vec3 n, Vec3 uv);
+        virtual Vec3 normal (Mat3 tbn, Vec3 n, Vec3 uv, double width);
 };
\ No newline at end of file
@@ -0,0 +1,112 @@
+/**
+    @file material_table.hpp
+
+    @brief Flat table of every material, indexed by Material::id.
+
+    Each record holds the material's type tag and the values the path
+    tracer reads on every bounce (emission), plus a pointer back to the
+    material. Shading goes through MaterialRecord, which switches on the
+    tag and calls the concrete class's methods directly: there are no
+    virtual calls or dynamic_casts for the built-in materials, and hits
+    can be grouped by id (or type) to shade many of them with the same
+    code, e.g. in a wavefront renderer. Material types without a case of
+    their own (Phong, measured BRDFs, ...) fall back to the virtual
+    methods.
+
+    Materials add themselves on construction and remove themselves on
+    destruction; ids of removed materials are reused. Materials must not be
+    created or destroyed while rendering, since that may move the records.
+*/
+
+#pragma once
+
+#include "dielectric.hpp"
+#include "hitrecord.hpp"
+#include "lambertian.hpp"
+#include "material.hpp"
+#include "metal.hpp"
+#include "ray.hpp"
+#include "vec3.hpp"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct MaterialRecord {
+        MaterialType type;
+        bool emissive;
+        Vec3 emission;
+        Material *material;
+
+        Vec3 scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob);
+        bool evaluate (Ray r, HitRecord &record, Vec3 direction, Vec3 &brdf, double &pdf);
+        void differentials (Ray &in, HitRecord &record, Ray &out);
+        Vec3 color (HitRecord &record);
+};
+
+class MaterialTable {
+    public:
+        static std::vector<MaterialRecord> records;
+
+        static uint32_t add (Material *material);
+        static void update (Material *material);
+        static void remove (uint32_t id);
+
+        static MaterialRecord &get (uint32_t id)
+        {
+                return MaterialTable::records[id];
+        }
+
+    private:
+        static std::vector<uint32_t> free_ids;
+        static std::mutex lock;
+};
+
+/**
+        The qualified calls (Lambertian::scatter, ...) are resolved at compile
+        time, the switch replaces the virtual dispatch. They are defined here
+        so that the dispatch is inlined into the renderer's loops.
+ */
+inline Vec3 MaterialRecord::scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob)
+{
+        switch (this->type) {
+        case MaterialType::Lambertian:
+                return ((Lambertian *)this->material)->Lambertian::scatter (r, record, brdf, ray_prob);
+        case MaterialType::Metal: return ((Metal *)this->material)->Metal::scatter (r, record, brdf, ray_prob);
+        case MaterialType::Dielectric:
+                return ((Dielectric *)this->material)->Dielectric::scatter (r, record, brdf, ray_prob);
+        default: return this->material->scatter (r, record, brdf, ray_prob);
+        }
+}
+
+inline bool MaterialRecord::evaluate (Ray r, HitRecord &record, Vec3 direction, Vec3 &brdf, double &pdf)
+{
+        switch (this->type) {
+        case MaterialType::Lambertian:
+                return ((Lambertian *)this->material)->Lambertian::evaluate (r, record, direction, brdf, pdf);
+        case MaterialType::Metal:
+        case MaterialType::Dielectric: return false;
+        default: return this->material->evaluate (r, record, direction, brdf, pdf);
+        }
+}
+
+inline void MaterialRecord::differentials (Ray &in, HitRecord &record, Ray &out)
+{
+        switch (this->type) {
+        case MaterialType::Lambertian: out.has_differentials = false; break;
+        case MaterialType::Metal: ((Metal *)this->material)->Metal::differentials (in, record, out); break;
+        case MaterialType::Dielectric:
+                ((Dielectric *)this->material)->Dielectric::differentials (in, record, out);
+                break;
+        default: this->material->differentials (in, record, out); break;
+        }
+}
+
+inline Vec3 MaterialRecord::color (HitRecord &record)
+{
+        switch (this->type) {
+        case MaterialType::Lambertian: return ((Lambertian *)this->material)->Lambertian::color (record);
+        case MaterialType::Metal: return ((Metal *)this->material)->Metal::color (record);
+        case MaterialType::Dielectric: return ((Dielectric *)this->material)->Dielectric::color (record);
+        default: return this->material->color (record);
+        }
+}
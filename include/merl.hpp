@@ -0,0 +1,87 @@
+/**
+    @file merl.hpp
+
+    @brief Tabulated MERL measured BRDF, laid out for fast evaluation and
+    importance sampling.
+
+    The MERL database samples isotropic BRDFs on a 90 (theta_half) x 90
+    (theta_diff) x 180 (phi_diff) grid and stores the red, green and blue
+    values as three separate planes of doubles. MerlBRDF keeps them as
+    interleaved, pre-scaled floats, so that an evaluation reads 12
+    contiguous bytes instead of three doubles megabytes apart.
+
+    Directions are given in the local shading frame (z is the normal) and
+    both point away from the surface. The half and difference vectors are
+    computed directly from the two directions instead of going through
+    spherical coordinates and two axis-angle rotations.
+
+    For importance sampling, f * cos(theta_out) is tabulated over the
+    outgoing hemisphere for MERL_SAMPLING_THETA_IN incident angles and
+    sampled with a Distribution2D (distribution.hpp).
+
+    Measured files are loaded through MerlBRDF::load (), which keeps one
+    instance per file for all materials and threads. The file is memory
+    mapped while it is converted; with a cache directory set, the converted
+    float table is also written there and later loads (in this or any other
+    process) map it directly.
+*/
+
+#pragma once
+
+#include "distribution.hpp"
+#include "vec3.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#define MERL_THETA_H 90
+#define MERL_THETA_D 90
+#define MERL_PHI_D   180
+
+// number of cells of a MERL table
+#define MERL_SAMPLES (MERL_THETA_H * MERL_THETA_D * MERL_PHI_D)
+
+// resolution of the importance sampling tables
+#define MERL_SAMPLING_THETA_IN  32
+#define MERL_SAMPLING_THETA_OUT 64
+#define MERL_SAMPLING_PHI_OUT   128
+
+class MerlBRDF {
+    public:
+        // 3 * MERL_SAMPLES interleaved rgb values, owned or memory mapped
+        const float *rgb;
+
+        // where converted float tables are cached, nullptr to not cache
+        static const char *cache_directory;
+
+        MerlBRDF (const double *planes);
+        MerlBRDF (const MerlBRDF &) = delete;
+        ~MerlBRDF ();
+
+        static std::shared_ptr<MerlBRDF> load (const char *filename);
+
+        Vec3 eval (Vec3 in, Vec3 out);
+        Vec3 sample (Vec3 in, Vec3 &out, double &pdf);
+        double pdf (Vec3 in, Vec3 out);
+
+        static size_t index (Vec3 in, Vec3 out);
+        static void half_diff (Vec3 in, Vec3 out, Vec3 &half, Vec3 &diff);
+
+    private:
+        std::vector<float> storage;
+        void *mapping;
+        size_t mapping_size;
+
+        // one distribution over (phi_out, theta_out) per incident angle
+        std::vector<Distribution2D> sampling;
+
+        MerlBRDF ();
+        void _convert (const unsigned char *planes);
+        void _read (const std::string &filename);
+        bool _map_cache (const std::string &cache, struct stat &source);
+        void _write_cache (const std::string &cache, struct stat &source);
+        void _build_sampling ();
+        int _sampling_row (Vec3 in);
+};
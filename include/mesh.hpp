@@ -3,7 +3,7 @@
 
     @brief This file contains the definition of the Mesh class. Meshes are
     collections of triangles that approximate a smooth surface. They are
-    constructed from .obj files and can be used to represent complex objects
+    constructed from .obj or .ply files and can be used to represent complex objects
     in a scene.
 
     Meshes are not smooth objects, and as such do not have the ability to
@@ -15,6 +15,21 @@
     Meshes are useful for representing complex objects in a scene, but are
     not as efficient as smooth objects for rendering.
 
+    A mesh constructed without a location and scale stays in object space
+    (centred on its centroid), so that it can be shared by many Instances
+    (instance.hpp).
+
+    With Mesh::lazy_loading set, construction only reads the vertices and
+    faces of a mesh for its bounds, its triangles are created by the first
+    ray that enters them. Mesh::memory_budget caps the bytes of resident geometry: once it is
+    exceeded, the least recently hit meshes are evicted and re-loaded from
+    disk if they are hit again. A hit holds on to the geometry of its
+    triangle (HitRecord::owner), evicted geometry is freed once the last of
+    these hits is gone.
+
+    Mesh::accelerator picks the structure the triangles of a mesh are
+    intersected through: the KDTree, or a 4 or 8 wide BVH (wide_bvh.hpp).
+
 */
 
 #pragma once
@@ -24,20 +39,99 @@
 #include "object.hpp"
 #include "triangle.hpp"
 #include "vec3.hpp"
+#include "wide_bvh.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <vector>
 
 class Mesh : public Object {
     public:
+        enum class Accelerator { KDTree, BVH4, BVH8 };
+
+        /**
+                The triangles of a mesh and the structure they are
+                intersected through (only the one Mesh::accelerator selected
+                when they were loaded is built). This is the part of a mesh
+                that can be loaded on demand and evicted again.
+         */
+        struct Geometry {
+                std::vector<Triangle *> triangles;
+                // the structure that was built, Mesh::accelerator may have changed since
+                Accelerator accelerator;
+                KDTree triangle_kdtree;
+                WideBVH<4> triangle_bvh4;
+                WideBVH<8> triangle_bvh8;
+                size_t bytes;
+                ~Geometry ();
+        };
+
+        /**
+                When set, meshes only compute their bounds at construction.
+                Triangles are read and the accelerator is built by the first
+                ray that enters the bounds.
+         */
+        static bool lazy_loading;
+
+        /**
+                Bytes of resident mesh geometry allowed before the least
+                recently hit meshes are evicted (0 = unlimited). Must be set
+                before rendering starts.
+         */
+        static size_t memory_budget;
+
+        /**
+                Structure the triangles of meshes made resident from now on
+                are intersected through (default: KDTree).
+         */
+        static Accelerator accelerator;
+
         Mesh (const char *filename, Vec3 location, double scale, Material *material);
-        KDTree triangle_kdtree;
+        Mesh (const char *filename, Material *material);
+        ~Mesh ();
 
-        std::vector<Triangle *> triangles;
         char *obj_filename;
         double scale;
+        size_t triangle_count;
+        // bounds at time 0, also known while the geometry is not resident
+        KDTree::BoundingBox bounding_box;
+
         bool is_light_source () override;
         bool hit (Ray r, HitRecord &record) override;
+        bool bounds (double time, Vec3 &min, Vec3 &max) override;
+        bool is_resident ();
+        // time the accelerator over the triangles took to build, 0 while they are not resident
+        double build_seconds ();
 
     private:
-        void _load_mesh ();
-        Vec3 _transform_vertex (Vec3 v);
-};
\ No newline at end of file
+        // guarded by _residency
+        std::shared_ptr<Geometry> _geometry;
+        std::shared_mutex _residency;
+        // _geometry's pointer, read without the lock while no budget is set and nothing is evicted
+        std::atomic<Geometry *> _resident;
+        // steady clock nanoseconds of the last hit
+        std::atomic<uint64_t> _last_used;
+        Vec3 _centroid;
+        // location the triangles are baked at, the mesh can be moved afterwards
+        Vec3 _baked_location;
+        // set by the first _make_resident, guarded by _residency
+        bool _loaded;
+
+        Vec3 _offset (double time);
+
+        static std::mutex _resident_lock;
+        static std::vector<Mesh *> _resident_meshes;
+        static std::atomic<size_t> _resident_bytes;
+
+        void _read_bounds ();
+        std::vector<Triangle *> _read_triangles (bool compute_centroid);
+        void _make_resident (std::vector<Triangle *> triangles);
+        void _load ();
+        std::shared_ptr<Geometry> _acquire ();
+        bool _hit_geometry (Geometry *geometry, Ray r, HitRecord &record, Vec3 offset);
+        void _evict ();
+        static void _enforce_budget (Mesh *keep);
+};
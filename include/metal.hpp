@@ -1,3 +1,4 @@
+#pragma once
 #include "material.hpp"
 #include "vec3.hpp"
 class Metal : public Material {
@@ -5,6 +6,7 @@ class Metal : public Material {
         Metal (double fuzz, Vec3 color);
         Metal (double fuzz, Texture *texture);
         virtual Vec3 scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob) override;
+        void differentials (Ray &in, HitRecord &record, Ray &out) override;
 
     private:
         Vec3 albedo;
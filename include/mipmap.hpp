@@ -0,0 +1,55 @@
+/**
+    @file mipmap.hpp
+
+    @brief Mip-mapped, tiled texture storage with bilinear and trilinear
+    filtering.
+
+    Every level of the pyramid is stored in MIPMAP_TILE_SIZE x
+    MIPMAP_TILE_SIZE texel tiles, so that a filtered lookup touches one or a
+    few contiguous 192 byte blocks instead of rows that are a whole image
+    width apart. Levels are kept 8-bit gamma encoded like the source image
+    (colour = (value / 255)^2), so the whole pyramid takes 4/3 of the
+    decoded image, and texels are decoded to linear colour through a 256
+    entry table as they are read.
+
+    Texture coordinates repeat in u and are clamped in v, which matches the
+    longitude/latitude mapping of spheres.
+*/
+
+#pragma once
+
+#include "vec3.hpp"
+#include <cstdint>
+#include <vector>
+
+#define MIPMAP_TILE_SIZE 8
+
+class MipMap {
+    public:
+        struct Level {
+                int width;
+                int height;
+                int tiles_x;
+                int tiles_y;
+                // 8-bit rgb texels, tile after tile, row major within a tile
+                std::vector<uint8_t> texels;
+
+                const uint8_t *texel (int x, int y);
+        };
+
+        std::vector<Level> levels;
+
+        MipMap (const uint8_t *rgb, int width, int height);
+
+        Vec3 texel (int level, int x, int y);
+        Vec3 texel_rgb255 (int level, int x, int y);
+        Vec3 bilinear (int level, Vec3 uv);
+        Vec3 trilinear (Vec3 uv, double width);
+        Vec3 bilinear_rgb255 (int level, Vec3 uv);
+        Vec3 trilinear_rgb255 (Vec3 uv, double width);
+
+    private:
+        template <typename F> Vec3 _trilinear (Vec3 uv, double width, F bilinear);
+        void _store_level (Level &level, const uint8_t *rgb);
+        void _wrap (Level &level, int &x, int &y);
+};
@@ -1,64 +1,91 @@
+/**
+    @file obj.hpp
+
+    @brief Multithreaded .obj reader.
+
+    The file is memory mapped and split into newline aligned chunks which are
+    parsed in parallel (numbers are read with std::from_chars). Each chunk
+    collects its own vertices, texture coordinates, normals and fan
+    triangulated faces; once every chunk is done, the attributes are
+    concatenated into contiguous arrays and face indices (including negative,
+    relative ones) are resolved against the global attribute counts.
+
+    Statements other than v, vt, vn and f (o, g, s, usemtl, mtllib, ...) and
+    comments are skipped.
+*/
+
 #pragma once
 
 #include "vec3.hpp"
 #include <cstddef>
-#include <cstdio>
-#include <map>
-#include <optional>
+#include <cstdint>
 #include <vector>
+
 class ObjFile {
     public:
-        enum TokenType { INTEGER, FLOAT, IDENT, VERTEX, VERTEX_TEXTURE, VERTEX_NORMAL, FACE, SLASH, END };
-
-        struct Token {
-                enum TokenType type;
-
-                union {
-                        int d;
-                        double f;
-                        char ident[32];
-                };
+        /**
+                0-based attribute indices of one face corner, -1 when the
+                attribute is not given (e.g. `f 1//3 ...` has no texture
+                coordinate).
+         */
+        struct Index {
+                int vertex;
+                int texture;
+                int normal;
         };
 
-        using FaceTriple = std::tuple<std::optional<int>, std::optional<int>, std::optional<int> >;
-        using Face = std::vector<FaceTriple>;
-
         bool parsed;
-        bool is_triangular_mesh;
-        char curr_char;
-        std::map<size_t, Vec3> vertex_map;
-        std::map<size_t, Vec3> texture_map;
-        std::map<size_t, Vec3> normal_map;
-        std::vector<Face> faces;
-
-        struct Token token;
-        FILE *obj_file;
-
-        size_t vertex_index;
-        size_t vertex_texture_index;
+        int nthreads;
+
+        std::vector<Vec3> vertices;
+        std::vector<Vec3> texcoords;
+        std::vector<Vec3> normals;
+        // 3 corners per triangle, polygons are fan triangulated
+        std::vector<Index> indices;
+
         ObjFile (const char *filename);
+        ObjFile (const char *filename, int nthreads);
         ~ObjFile ();
-        char peek_char ();
-        bool match_char (char c);
-        char advance_char ();
 
-        bool match_token (TokenType type);
-        struct Token parse_token ();
-        struct Token advance_token ();
-        struct Token peek_token ();
-        struct Token consume_token (enum TokenType type, const char *error);
-        struct Token parse_numeric ();
-        struct Token parse_keyword (char *keyword);
+        size_t triangle_count ();
+        void parse ();
 
-        FaceTriple parse_face_indicies ();
+    private:
+        /**
+                Face indices inside a chunk are stored before the global
+                attribute counts are known: absolute indices are stored 0-based,
+                relative (negative) indices are stored relative to the start of
+                the chunk and tagged with RELATIVE.
+         */
+        static constexpr int64_t RELATIVE = int64_t (1) << 40;
+        static constexpr int64_t MISSING = -1;
 
-        Vec3 parse_uv ();
-        Vec3 parse_vertex_normal ();
-        Vec3 parse_vertex ();
-        Face parse_face ();
+        struct RawIndex {
+                int64_t vertex;
+                int64_t texture;
+                int64_t normal;
+        };
 
-        std::vector<Face> fan_triangulate_face (Face &face);
-        void fan_triangulate ();
+        struct Chunk {
+                const char *begin;
+                const char *end;
 
-        void parse ();
+                std::vector<Vec3> vertices;
+                std::vector<Vec3> texcoords;
+                std::vector<Vec3> normals;
+                std::vector<RawIndex> indices;
+
+                size_t vertex_offset;
+                size_t texcoord_offset;
+                size_t normal_offset;
+        };
+
+        const char *filename;
+        const char *data;
+        size_t size;
+
+        std::vector<Chunk> _split_chunks ();
+        void _parse_chunk (Chunk &chunk);
+        void _stitch_chunk (Chunk &chunk, size_t index_offset);
+        int _resolve (int64_t raw, size_t chunk_offset, size_t count);
 };
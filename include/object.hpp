@@ -9,9 +9,16 @@
 #pragma once
 #include "material.hpp"
 #include "ray.hpp"
+#include <cstdint>
 
 class Object {
     public:
+        /**
+                Shapes that BVH leaves store as structures of arrays and test
+                several at a time (see bvh.hpp), everything else is Other.
+         */
+        enum class Primitive : uint8_t { Other, Sphere, Quad };
+
         Object ();
         Object (Vec3 location, Material *material);
         Object (Vec3 location1, Vec3 location2, Material *material);
@@ -21,6 +28,23 @@ class Object {
         virtual bool is_light_source () = 0;
         Vec3 location_at_time (double time);
 
+        /**
+                Moves the object linearly from location at time 0 to location2
+                at time 1 (ray times are in [0, 1)). Spheres, meshes and
+                instances honour this when they are hit.
+         */
+        void move_to (Vec3 location2);
+        void place (Vec3 location, Vec3 location2);
+        Vec3 motion_offset (double time);
+
+        /**
+                Axis aligned bounds of the object at the given time. Returns
+                false for unbounded objects (planes), which acceleration
+                structures have to test separately.
+         */
+        virtual bool bounds (double time, Vec3 &min, Vec3 &max);
+        virtual Primitive primitive ();
+
         Vec3 location;
         Vec3 location2;
         Ray displacement;
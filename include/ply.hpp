@@ -0,0 +1,51 @@
+/**
+    @file ply.hpp
+
+    @brief Streaming reader for .ply meshes (binary little/big-endian and
+    ASCII) built on the vendored rply library.
+
+    rply calls back once per property value, and the callbacks write straight
+    into flat vertex and index arrays: there are no intermediate per-face
+    objects. Polygons with more than three vertices are fan triangulated as
+    they are read.
+*/
+
+#pragma once
+
+#include "lib/rply.h"
+#include <cstddef>
+#include <vector>
+
+class PlyFile {
+    public:
+        PlyFile (const char *filename);
+        ~PlyFile ();
+
+        bool parsed;
+        bool has_normals;
+
+        // x0 y0 z0 x1 y1 z1 ...
+        std::vector<double> vertices;
+        // nx0 ny0 nz0 ... (empty if the file has no vertex normals)
+        std::vector<double> normals;
+        // 3 vertex indices per triangle
+        std::vector<size_t> indices;
+
+        size_t vertex_count ();
+        size_t triangle_count ();
+
+        void parse ();
+
+    private:
+        p_ply ply;
+        const char *filename;
+
+        // fan triangulation state for the face currently being read
+        size_t face_first;
+        size_t face_previous;
+
+        static int vertex_cb (p_ply_argument argument);
+        static int normal_cb (p_ply_argument argument);
+        static int face_cb (p_ply_argument argument);
+        static void error_cb (p_ply ply, const char *message);
+};
@@ -0,0 +1,85 @@
+/**
+    @file preview_server.hpp
+
+    @brief Interactive preview: rt --serve /tmp/rt.sock builds the scene once,
+    then renders it progressively for clients of a Unix domain socket. Camera
+    and render parameter edits only restart the accumulation, the World, its
+    BVH and the meshes stay resident.
+
+    One client is served at a time. It sends JSON objects, one per line,
+    every field is optional:
+
+        {"lookfrom": [0, 1, 2], "lookat": [0, 1, -1], "vup": [0, 1, 0],
+         "vfov": 40, "focus_dist": 0, "defocus_angle": 0.5,
+         "sensor_shift": [0, 0.1], "image_width": 400,
+         "samples_per_pixel": 256, "max_depth": 8}
+        {"shutdown": true}      stops the server
+
+    Each edit restarts the image, which is then refined in passes of 1, 1,
+    2, 4, 8, ... samples per pixel until samples_per_pixel is reached.
+    Passes are split into PREVIEW_TILE x PREVIEW_TILE tiles rendered by the
+    server's threads. The server answers with JSON lines, a tile is followed
+    by its pixels (width * height * 3 bytes, RGB as in the rendered PPM):
+
+        {"type": "frame", "width": 400, "height": 225}   the image restarts
+        {"type": "tile", "x": 0, "y": 0, "width": 32, "height": 32, "samples": 4}
+        {"type": "pass", "samples": 4, "seconds": 0.8}   every tile has 4 samples
+        {"type": "done", "samples": 256}
+        {"type": "error", "message": "..."}
+
+    An edit that arrives during a pass cancels the tiles that have not
+    started yet.
+*/
+
+#pragma once
+
+#include "camera.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class PreviewServer {
+    public:
+        PreviewServer (Camera *camera, World *world, int nthreads);
+
+        // serves clients on a socket at path until one sends shutdown, false if it cannot listen there
+        bool serve (const char *path);
+
+    private:
+        Camera *camera;
+        World *world;
+        int nthreads;
+
+        int client;
+        bool shutdown;
+        // bumped by every edit, a pass stops once it changes
+        std::atomic<uint64_t> generation;
+
+        // lines received from the client, closed once it has gone
+        std::mutex lock;
+        std::condition_variable received;
+        std::deque<std::string> lines;
+        bool closed;
+
+        // serializes the messages of the render threads
+        std::mutex send_lock;
+
+        // samples added up per pixel, how many each pixel has and how many it should get
+        std::vector<Vec3> sum;
+        int samples;
+        int target;
+
+        void _session ();
+        void _receive ();
+        bool _apply (std::string &line);
+        void _restart ();
+        bool _pass (int samples, uint64_t generation);
+        bool _send (std::string header, const uint8_t *data = nullptr, size_t size = 0);
+};
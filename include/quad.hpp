@@ -7,9 +7,17 @@ class Quad : public SmoothObject {
     public:
         Quad (Vec3 location, Vec3 v1, Vec3 v2, Material *mat);
         bool hit (Ray r, HitRecord &record) override;
+        void hit_record (Ray r, double lambda, HitRecord &record);
+        bool bounds (double time, Vec3 &min, Vec3 &max) override;
+        Primitive primitive () override;
 
         Vec3 find_alpha_beta (Vec3 point);
-        bool &one_sided ();
+        void alpha_beta_axes (Vec3 &a, Vec3 &b);
+        bool &one_sided ()
+        {
+                return this->_one_sided;
+        }
+
         Vec3 to_uv (Vec3 point) override;
         Vec3 get_point (double alpha, double beta);
         Vec3 tangent (Vec3 point) override;
@@ -18,6 +26,31 @@ class Quad : public SmoothObject {
         double area () override;
         Vec3 v1, v2;
 
+        /**
+                Whether a ray with origin o, relative to the corner, and
+                direction d hits a quad of unit normal n and alpha/beta axes
+                a and b (see alpha_beta_axes), and at which lambda. Shared by
+                Quad::hit and the BVH's leaf lanes like Sphere::intersect.
+         */
+        static inline bool intersect (double ox, double oy, double oz, double dx, double dy, double dz, double nx,
+                                      double ny, double nz, double ax, double ay, double az, double bx, double by,
+                                      double bz, bool one_sided, double &lambda)
+        {
+                double bottom = nx * dx + ny * dy + nz * dz;
+
+                lambda = -(nx * ox + ny * oy + nz * oz) / bottom;
+
+                double px = ox + lambda * dx, py = oy + lambda * dy, pz = oz + lambda * dz;
+                double alpha = px * ax + py * ay + pz * az;
+                double beta = px * bx + py * by + pz * bz;
+
+                // one sided quads are invisible from the back
+                bool facing = !one_sided || bottom <= 0;
+                bool inside = 0 <= alpha && alpha <= 1 && 0 <= beta && beta <= 1;
+
+                return facing && bottom != 0 && inside;
+        }
+
     private:
         bool _one_sided;
         Vec3 _normal ();
@@ -12,7 +12,35 @@ class Ray {
         double time;
         Vec3 color;
 
+        /**
+                Ray differentials: the rays through the neighbouring pixel to
+                the right (x) and below (y). Only camera rays and their mirror
+                reflections and refractions carry them, has_differentials is
+                false for every other ray. The offset directions need not be
+                normalized.
+         */
+        bool has_differentials;
+        Vec3 rx_origin;
+        Vec3 rx_direction;
+        Vec3 ry_origin;
+        Vec3 ry_direction;
+
         Vec3 at (double t);
         void nudge_forward ();
         bool can_refract (Vec3 normal, double mu);
-};
\ No newline at end of file
+        void scale_differentials (double s);
+        bool footprint (Vec3 point, Vec3 normal, Vec3 &dpdx, Vec3 &dpdy);
+};
+
+/**
+        A ray prepared for slab tests against many boxes: the reciprocal of
+        its direction and, per axis, whether it is negative (the ray then
+        enters a box through its max side).
+ */
+struct RayPrecomputed {
+        double origin[3];
+        double inverse_direction[3];
+        int sign[3];
+
+        RayPrecomputed (Ray &r);
+};
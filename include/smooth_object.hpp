@@ -44,4 +44,8 @@ class SmoothObject : public Object {
         Mat3 tbn (Vec3 point);
         Mat3 tnb (HitRecord &record);
         Vec3 tbn_transform (Vec3 point, Vec3 tangent_v);
+        Vec3 shading_normal (HitRecord &record, double width);
+
+    private:
+        void _world_frame (HitRecord &record, Vec3 &tangent, Vec3 &normal);
 };
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "ray.hpp"
 #include "smooth_object.hpp"
 #include "vec3.hpp"
+#include <algorithm>
+#include <cmath>
 
 class Sphere : public SmoothObject {
     public:
@@ -10,6 +12,9 @@ class Sphere : public SmoothObject {
         Sphere (Vec3 center, double radius, Material *material);
         Sphere (Vec3 center1, Vec3 center2, double radius, Material *material);
         bool hit (Ray r, HitRecord &record) override;
+        void hit_record (Ray r, double lambda, HitRecord &record);
+        bool bounds (double time, Vec3 &min, Vec3 &max) override;
+        Primitive primitive () override;
         Vec3 to_uv (Vec3 point) override;
         Vec3 tangent (Vec3 point) override;
         Vec3 normal (Vec3 point) override;
@@ -19,6 +24,31 @@ class Sphere : public SmoothObject {
 
         double area () override;
 
+        /**
+                Whether a ray with origin o, relative to the center, and
+                direction d hits a sphere of the given radius, and at which
+                lambda. Sphere::hit and the BVH's leaf lanes (see bvh.hpp)
+                both intersect through this. Branch free, so that it
+                vectorizes.
+         */
+        static inline bool intersect (double ox, double oy, double oz, double dx, double dy, double dz,
+                                      double radius, double &lambda)
+        {
+                double a = dx * dx + dy * dy + dz * dz;
+                double b = 2 * (dx * ox + dy * oy + dz * oz);
+                double c = ox * ox + oy * oy + oz * oz - radius * radius;
+
+                // difference_of_products (b, b, 4 * a, c)
+                double ac = 4 * a * c;
+                double discriminant = std::fma (b, b, -ac) + std::fma (4 * a, c, -ac);
+
+                double root = std::sqrt (std::max (discriminant, 0.0));
+                double near = (-b - root) / (2 * a), far = (-b + root) / (2 * a);
+                lambda = near < 0 ? far : near;
+
+                return discriminant >= 0 && lambda >= 0;
+        }
+
     private:
         double argument (double y_opp, double x_adj);
 };
\ No newline at end of file
@@ -0,0 +1,136 @@
+/**
+    @file stats.hpp
+
+    @brief Render statistics: counters on the hot paths (acceleration
+    structure traversal, triangle tests, path lengths and terminations) and
+    time spent in each stage of a path.
+
+    Counting is compiled in with RT_STATS (cmake -DRT_STATS=ON). Without it
+    every STATS_* macro expands to nothing, so the hot paths are unchanged.
+
+    Each thread counts into its own RenderStats::local. Render threads
+    STATS_FLUSH () into the shared totals once they are done, which also
+    picks up their Camera::ray_counts. STATS_REPORT (file) prints the totals
+    as a table, writes them as JSON to file if it is not null, then clears
+    them for the next render.
+*/
+
+#pragma once
+
+#ifdef RT_STATS
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+// path lengths (surfaces hit) counted one by one, longer paths share the last bucket
+#define STATS_PATH_LENGTHS 32
+// bucket b counts leaves holding [2^(b - 1), 2^b) primitives, bucket 0 empty ones
+#define STATS_LEAF_SIZES 16
+
+/**
+        Generate makes camera rays, Intersect finds the closest hit of path
+        rays, Shadow tests the visibility of light samples and Shade is
+        everything else a path does.
+ */
+enum class StatsStage { Generate, Intersect, Shade, Shadow, Count };
+
+struct RenderStats {
+        uint64_t primary_rays;
+        uint64_t secondary_rays;
+        uint64_t shadow_rays;
+
+        // of the World's BVH
+        uint64_t bvh_nodes;
+        uint64_t bvh_leaf_objects;
+
+        // of the meshes' KDTrees and wide BVHs
+        uint64_t mesh_nodes;
+        uint64_t triangle_tests;
+        uint64_t triangle_hits;
+
+        // leaves of any tree whose primitives were tested, by size
+        uint64_t leaf_sizes[STATS_LEAF_SIZES];
+
+        uint64_t path_lengths[STATS_PATH_LENGTHS];
+        // why paths ended
+        uint64_t escaped;
+        uint64_t emitted;
+        uint64_t max_depth;
+
+        uint64_t stage_ns[int (StatsStage::Count)];
+
+        static thread_local RenderStats local;
+
+        // adds the calling thread's counters and Camera::ray_counts to the totals, and clears them
+        static void flush ();
+        static void report (const char *json_file);
+
+        void leaf (uint64_t size)
+        {
+                this->leaf_sizes[std::min<int> (std::bit_width (size), STATS_LEAF_SIZES - 1)]++;
+        }
+
+        void path (int length)
+        {
+                this->path_lengths[std::min (length, STATS_PATH_LENGTHS - 1)]++;
+        }
+};
+
+// defined here, so that the libraries below world count without linking stats.cpp
+inline thread_local RenderStats RenderStats::local = {};
+
+/**
+        Adds the time until it goes out of scope to a stage. Timers nest:
+        while an inner timer runs, the outer one's stage is not charged, so
+        stage times do not overlap.
+ */
+struct StatsTimer {
+        StatsStage previous;
+
+        // stage being charged on this thread, Count when none
+        static inline thread_local StatsStage current = StatsStage::Count;
+        static inline thread_local std::chrono::steady_clock::time_point since;
+
+        static void charge ()
+        {
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+
+                if (StatsTimer::current != StatsStage::Count)
+                        RenderStats::local.stage_ns[int (StatsTimer::current)] +=
+                                std::chrono::duration_cast<std::chrono::nanoseconds> (now - StatsTimer::since).count ();
+
+                StatsTimer::since = now;
+        }
+
+        StatsTimer (StatsStage stage) : previous (StatsTimer::current)
+        {
+                StatsTimer::charge ();
+                StatsTimer::current = stage;
+        }
+
+        ~StatsTimer ()
+        {
+                StatsTimer::charge ();
+                StatsTimer::current = this->previous;
+        }
+};
+
+#define STATS_ADD(counter, n) (RenderStats::local.counter += (n))
+#define STATS_LEAF(size) RenderStats::local.leaf (size)
+#define STATS_PATH(length) RenderStats::local.path (length)
+#define STATS_TIME(stage) StatsTimer stats_timer (stage)
+#define STATS_FLUSH() RenderStats::flush ()
+#define STATS_REPORT(json_file) RenderStats::report (json_file)
+
+#else
+
+#define STATS_ADD(counter, n) ((void)0)
+#define STATS_LEAF(size) ((void)0)
+#define STATS_PATH(length) ((void)0)
+#define STATS_TIME(stage) ((void)0)
+#define STATS_FLUSH() ((void)0)
+#define STATS_REPORT(json_file) ((void)0)
+
+#endif
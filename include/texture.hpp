@@ -14,4 +14,13 @@ class Texture {
         virtual Vec3 photon_map (Vec3 point) = 0;
         virtual Vec3 read_texture_uv (Vec3 uv, Vec3 point) = 0;
         virtual Vec3 read_rgb255 (Vec3 uv) = 0;
+
+        /**
+                Filtered versions of read_texture_uv and read_rgb255 over a
+                footprint of the given width in texture coordinates (see
+                HitRecord::footprint ()). Textures without prefiltered levels
+                ignore the width.
+         */
+        virtual Vec3 lookup (Vec3 uv, Vec3 point, double width);
+        virtual Vec3 lookup_rgb255 (Vec3 uv, double width);
 };
\ No newline at end of file
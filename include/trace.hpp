@@ -0,0 +1,121 @@
+/**
+    @file trace.hpp
+
+    @brief Timeline of render phases (scene load, mesh parsing, acceleration
+    structure builds, rows rendered, photon pass, image export), written in
+    the Chrome trace event format. Open the file in Perfetto
+    (ui.perfetto.dev) or chrome://tracing, each thread gets its own track.
+
+    Recording starts with Trace::start () (rt --trace out.json) and costs one
+    atomic load per scope until then. Scopes are coarse, nothing on a per ray
+    path is traced.
+
+        {
+                TRACE_SCOPE ("BVH build");
+                ...
+        }
+
+    Every thread records into its own buffer, Trace::write () merges them.
+    The recording functions are defined here so that every library can trace
+    without linking trace.cpp.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Trace {
+    public:
+        struct Event {
+                const char *name;
+                // nanoseconds since Trace::start ()
+                uint64_t start;
+                uint64_t end;
+                // optional argument shown with the event, e.g. the row rendered
+                const char *arg_name;
+                int64_t arg;
+        };
+
+        struct Buffer {
+                uint32_t thread;
+                std::vector<Event> events;
+        };
+
+        static inline std::atomic<bool> enabled = false;
+
+        // the calling thread becomes thread 1, named "main" in the trace
+        static void start ()
+        {
+                Trace::_origin = std::chrono::steady_clock::now ();
+                Trace::_buffer ();
+                Trace::enabled.store (true, std::memory_order_release);
+        }
+
+        static uint64_t now ()
+        {
+                return std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () -
+                                                                             Trace::_origin)
+                        .count ();
+        }
+
+        // records an event from start (a Trace::now ()) until now
+        static void record (const char *name, uint64_t start, const char *arg_name = nullptr, int64_t arg = 0)
+        {
+                if (!Trace::enabled.load (std::memory_order_acquire))
+                        return;
+
+                Trace::_buffer ().events.push_back ({ name, start, Trace::now (), arg_name, arg });
+        }
+
+        // writes every event recorded so far, returns false if the file cannot be written
+        static bool write (const char *filename);
+
+    private:
+        static inline std::chrono::steady_clock::time_point _origin;
+        static inline std::mutex _lock;
+        // buffers outlive their threads, render threads only live for a row
+        static inline std::vector<std::unique_ptr<Buffer>> _buffers;
+        static inline thread_local Buffer *_thread_buffer = nullptr;
+
+        static Buffer &_buffer ()
+        {
+                if (!Trace::_thread_buffer) {
+                        std::lock_guard<std::mutex> guard (Trace::_lock);
+
+                        Trace::_buffers.push_back (std::make_unique<Buffer> ());
+                        Trace::_thread_buffer = Trace::_buffers.back ().get ();
+                        Trace::_thread_buffer->thread = Trace::_buffers.size ();
+                }
+
+                return *Trace::_thread_buffer;
+        }
+};
+
+/**
+        Records an event from its construction until it goes out of scope.
+ */
+struct TraceScope {
+        const char *name;
+        const char *arg_name;
+        int64_t arg;
+        uint64_t start;
+
+        TraceScope (const char *name, const char *arg_name = nullptr, int64_t arg = 0)
+                : name (name), arg_name (arg_name), arg (arg),
+                  start (Trace::enabled.load (std::memory_order_relaxed) ? Trace::now () : 0)
+        {
+        }
+
+        ~TraceScope ()
+        {
+                Trace::record (this->name, this->start, this->arg_name, this->arg);
+        }
+};
+
+#define TRACE_SCOPE(name) TraceScope trace_scope (name)
+#define TRACE_SCOPE_ARG(name, arg_name, arg) TraceScope trace_scope (name, arg_name, arg)
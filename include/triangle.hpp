@@ -22,6 +22,7 @@ class Triangle : public SmoothObject {
         void load_texture_coordinates (Vec3 t1, Vec3 t2, Vec3 t3);
         bool inside (Vec3 point);
         bool hit (Ray r, HitRecord &record) override;
+        bool bounds (double time, Vec3 &min, Vec3 &max) override;
         void center (Vec3 point);
         Vec3 center ();
         Vec3 to_uv (Vec3 point) override;
@@ -21,45 +21,181 @@ unsigned char help_txt[] = {
         0x61, 0x6e, 0x67, 0x6c, 0x65, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x44,
         0x65, 0x66, 0x6f, 0x63, 0x75, 0x73, 0x20, 0x62, 0x6c, 0x75, 0x72, 0x20, 0x6c, 0x65, 0x6e, 0x73, 0x20, 0x72,
         0x61, 0x64, 0x69, 0x75, 0x73, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x30, 0x2e,
-        0x30, 0x20, 0x2d, 0x20, 0x6e, 0x6f, 0x20, 0x62, 0x6c, 0x75, 0x72, 0x29, 0x2c, 0x0a, 0x2d, 0x68, 0x20, 0x7c,
-        0x20, 0x2d, 0x2d, 0x68, 0x65, 0x6c, 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x53, 0x68, 0x6f, 0x77, 0x20, 0x74, 0x68, 0x69,
-        0x73, 0x20, 0x68, 0x65, 0x6c, 0x70, 0x20, 0x6d, 0x65, 0x73, 0x73, 0x61, 0x67, 0x65, 0x0a, 0x2d, 0x6e, 0x20,
-        0x7c, 0x20, 0x2d, 0x2d, 0x6e, 0x74, 0x68, 0x72, 0x65, 0x61, 0x64, 0x73, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4d, 0x75, 0x6c, 0x74, 0x69, 0x74, 0x68,
-        0x72, 0x65, 0x61, 0x64, 0x69, 0x6e, 0x67, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20,
-        0x4f, 0x53, 0x20, 0x73, 0x75, 0x67, 0x67, 0x65, 0x73, 0x74, 0x65, 0x64, 0x20, 0x76, 0x61, 0x6c, 0x75, 0x65,
-        0x29, 0x0a, 0x2d, 0x61, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x61, 0x72, 0x65, 0x61, 0x6c, 0x69, 0x67, 0x68, 0x74,
-        0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4e, 0x75,
-        0x6d, 0x62, 0x65, 0x72, 0x20, 0x6f, 0x66, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x20, 0x66, 0x6f,
-        0x72, 0x20, 0x61, 0x72, 0x65, 0x61, 0x20, 0x6c, 0x69, 0x67, 0x68, 0x74, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61,
-        0x75, 0x6c, 0x74, 0x3a, 0x20, 0x31, 0x30, 0x29, 0x0a, 0x2d, 0x64, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x6d, 0x61,
-        0x78, 0x5f, 0x64, 0x65, 0x70, 0x74, 0x68, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-        0x20, 0x20, 0x20, 0x20, 0x20, 0x4d, 0x61, 0x78, 0x20, 0x72, 0x61, 0x79, 0x20, 0x62, 0x6f, 0x75, 0x6e, 0x63,
-        0x65, 0x20, 0x64, 0x65, 0x70, 0x74, 0x68, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20,
-        0x35, 0x29, 0x0a, 0x2d, 0x73, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x5f,
-        0x70, 0x65, 0x72, 0x5f, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4e,
-        0x75, 0x6d, 0x62, 0x65, 0x72, 0x20, 0x6f, 0x66, 0x20, 0x72, 0x61, 0x79, 0x73, 0x20, 0x63, 0x61, 0x73, 0x74,
-        0x20, 0x66, 0x6f, 0x72, 0x20, 0x65, 0x61, 0x63, 0x68, 0x20, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x20, 0x28, 0x64,
-        0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x31, 0x30, 0x30, 0x30, 0x29, 0x0a, 0x2d, 0x78, 0x20, 0x7c,
-        0x20, 0x2d, 0x2d, 0x75, 0x73, 0x65, 0x5f, 0x73, 0x63, 0x65, 0x6e, 0x65, 0x5f, 0x73, 0x69, 0x67, 0x20, 0x20,
-        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74, 0x65,
-        0x20, 0x53, 0x63, 0x65, 0x6e, 0x65, 0x20, 0x53, 0x69, 0x67, 0x6e, 0x61, 0x74, 0x75, 0x72, 0x65, 0x20, 0x28,
-        0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x20, 0x73, 0x68, 0x61, 0x64, 0x69, 0x6e, 0x67, 0x29, 0x0a, 0x2d, 0x70,
-        0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x75, 0x73, 0x65, 0x5f, 0x70, 0x61, 0x74, 0x68, 0x5f, 0x74, 0x72, 0x61, 0x63,
-        0x65, 0x72, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x55, 0x73, 0x65, 0x20, 0x70, 0x61,
-        0x74, 0x68, 0x20, 0x74, 0x72, 0x61, 0x63, 0x65, 0x72, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x65, 0x61, 0x64, 0x20,
-        0x6f, 0x66, 0x20, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x20, 0x72, 0x61, 0x79, 0x20, 0x74, 0x72, 0x61,
-        0x63, 0x65, 0x72, 0x0a, 0x2d, 0x6c, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x75, 0x73, 0x65, 0x5f, 0x6c, 0x69, 0x67,
-        0x68, 0x74, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x69, 0x6e, 0x67, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-        0x55, 0x73, 0x65, 0x20, 0x65, 0x78, 0x70, 0x6c, 0x69, 0x63, 0x69, 0x74, 0x20, 0x6c, 0x69, 0x67, 0x68, 0x74,
-        0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x69, 0x6e, 0x67, 0x20, 0x0a, 0x2d, 0x69, 0x20, 0x7c, 0x20, 0x2d, 0x2d,
-        0x75, 0x73, 0x65, 0x5f, 0x69, 0x6d, 0x70, 0x6f, 0x72, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x5f, 0x73, 0x61, 0x6d,
-        0x70, 0x6c, 0x69, 0x6e, 0x67, 0x20, 0x20, 0x55, 0x73, 0x65, 0x20, 0x69, 0x6d, 0x70, 0x6f, 0x72, 0x74, 0x61,
-        0x6e, 0x63, 0x65, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x69, 0x6e, 0x67, 0x0a, 0x2d, 0x62, 0x20, 0x7c, 0x20,
-        0x2d, 0x2d, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65,
-        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x53, 0x65, 0x74, 0x20, 0x62, 0x61, 0x63, 0x6b, 0x67,
-        0x72, 0x6f, 0x75, 0x6e, 0x64, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75,
-        0x6c, 0x74, 0x3a, 0x20, 0x62, 0x6c, 0x61, 0x63, 0x6b, 0x29
+        0x30, 0x20, 0x2d, 0x20, 0x6e, 0x6f, 0x20, 0x62, 0x6c, 0x75, 0x72, 0x29, 0x2c, 0x0a, 0x2d, 0x45, 0x20, 0x7c,
+        0x20, 0x2d, 0x2d, 0x6c, 0x6f, 0x6f, 0x6b, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x43, 0x61, 0x6d, 0x65, 0x72, 0x61, 0x20, 0x70,
+        0x6f, 0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x78, 0x2c, 0x79, 0x2c, 0x7a, 0x20, 0x28, 0x64, 0x65, 0x66,
+        0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x30, 0x2c, 0x31, 0x2c, 0x32, 0x29, 0x0a, 0x2d, 0x51, 0x20, 0x7c, 0x20,
+        0x2d, 0x2d, 0x6c, 0x6f, 0x6f, 0x6b, 0x61, 0x74, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x50, 0x6f, 0x69, 0x6e, 0x74, 0x20, 0x74, 0x68, 0x65,
+        0x20, 0x63, 0x61, 0x6d, 0x65, 0x72, 0x61, 0x20, 0x6c, 0x6f, 0x6f, 0x6b, 0x73, 0x20, 0x61, 0x74, 0x20, 0x78,
+        0x2c, 0x79, 0x2c, 0x7a, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x30, 0x2c, 0x31,
+        0x2c, 0x2d, 0x31, 0x29, 0x0a, 0x2d, 0x55, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x76, 0x75, 0x70, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x55, 0x70, 0x20, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x6f, 0x66, 0x20, 0x74,
+        0x68, 0x65, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x20, 0x78, 0x2c, 0x79, 0x2c, 0x7a, 0x20, 0x28, 0x64, 0x65,
+        0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x30, 0x2c, 0x31, 0x2c, 0x30, 0x29, 0x0a, 0x2d, 0x5a, 0x20, 0x7c,
+        0x20, 0x2d, 0x2d, 0x66, 0x6f, 0x63, 0x75, 0x73, 0x5f, 0x64, 0x69, 0x73, 0x74, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x44, 0x69, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65,
+        0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x70, 0x6c, 0x61, 0x6e, 0x65, 0x20, 0x69, 0x6e, 0x20, 0x66,
+        0x6f, 0x63, 0x75, 0x73, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x31, 0x2c, 0x20,
+        0x30, 0x20, 0x2d, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6c, 0x6f, 0x6f, 0x6b, 0x2d, 0x61, 0x74, 0x20, 0x70, 0x6f,
+        0x69, 0x6e, 0x74, 0x29, 0x0a, 0x2d, 0x58, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x73, 0x65, 0x6e, 0x73, 0x6f, 0x72,
+        0x5f, 0x73, 0x68, 0x69, 0x66, 0x74, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x53, 0x68, 0x69, 0x66, 0x74, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d, 0x61, 0x67,
+        0x65, 0x20, 0x70, 0x6c, 0x61, 0x6e, 0x65, 0x20, 0x78, 0x2c, 0x79, 0x20, 0x69, 0x6e, 0x20, 0x69, 0x6d, 0x61,
+        0x67, 0x65, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x73, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x68, 0x65, 0x69, 0x67,
+        0x68, 0x74, 0x73, 0x2c, 0x20, 0x72, 0x69, 0x67, 0x68, 0x74, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x75, 0x70, 0x20,
+        0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x30, 0x2c, 0x30, 0x29, 0x0a, 0x2d, 0x68, 0x20,
+        0x7c, 0x20, 0x2d, 0x2d, 0x68, 0x65, 0x6c, 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x53, 0x68, 0x6f, 0x77, 0x20, 0x74, 0x68,
+        0x69, 0x73, 0x20, 0x68, 0x65, 0x6c, 0x70, 0x20, 0x6d, 0x65, 0x73, 0x73, 0x61, 0x67, 0x65, 0x0a, 0x2d, 0x6e,
+        0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x6e, 0x74, 0x68, 0x72, 0x65, 0x61, 0x64, 0x73, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4d, 0x75, 0x6c, 0x74, 0x69, 0x74,
+        0x68, 0x72, 0x65, 0x61, 0x64, 0x69, 0x6e, 0x67, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a,
+        0x20, 0x4f, 0x53, 0x20, 0x73, 0x75, 0x67, 0x67, 0x65, 0x73, 0x74, 0x65, 0x64, 0x20, 0x76, 0x61, 0x6c, 0x75,
+        0x65, 0x29, 0x0a, 0x2d, 0x61, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x61, 0x72, 0x65, 0x61, 0x6c, 0x69, 0x67, 0x68,
+        0x74, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4e,
+        0x75, 0x6d, 0x62, 0x65, 0x72, 0x20, 0x6f, 0x66, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73, 0x20, 0x66,
+        0x6f, 0x72, 0x20, 0x61, 0x72, 0x65, 0x61, 0x20, 0x6c, 0x69, 0x67, 0x68, 0x74, 0x20, 0x28, 0x64, 0x65, 0x66,
+        0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x31, 0x30, 0x29, 0x0a, 0x2d, 0x64, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x6d,
+        0x61, 0x78, 0x5f, 0x64, 0x65, 0x70, 0x74, 0x68, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4d, 0x61, 0x78, 0x20, 0x72, 0x61, 0x79, 0x20, 0x62, 0x6f, 0x75, 0x6e,
+        0x63, 0x65, 0x20, 0x64, 0x65, 0x70, 0x74, 0x68, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a,
+        0x20, 0x35, 0x29, 0x0a, 0x2d, 0x73, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x73,
+        0x5f, 0x70, 0x65, 0x72, 0x5f, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x4e, 0x75, 0x6d, 0x62, 0x65, 0x72, 0x20, 0x6f, 0x66, 0x20, 0x72, 0x61, 0x79, 0x73, 0x20, 0x63, 0x61, 0x73,
+        0x74, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x65, 0x61, 0x63, 0x68, 0x20, 0x70, 0x69, 0x78, 0x65, 0x6c, 0x20, 0x28,
+        0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x31, 0x30, 0x30, 0x30, 0x29, 0x0a, 0x2d, 0x78, 0x20,
+        0x7c, 0x20, 0x2d, 0x2d, 0x75, 0x73, 0x65, 0x5f, 0x73, 0x63, 0x65, 0x6e, 0x65, 0x5f, 0x73, 0x69, 0x67, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x74,
+        0x65, 0x20, 0x53, 0x63, 0x65, 0x6e, 0x65, 0x20, 0x53, 0x69, 0x67, 0x6e, 0x61, 0x74, 0x75, 0x72, 0x65, 0x20,
+        0x28, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x20, 0x73, 0x68, 0x61, 0x64, 0x69, 0x6e, 0x67, 0x29, 0x0a, 0x2d,
+        0x70, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x75, 0x73, 0x65, 0x5f, 0x70, 0x61, 0x74, 0x68, 0x5f, 0x74, 0x72, 0x61,
+        0x63, 0x65, 0x72, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x55, 0x73, 0x65, 0x20, 0x70,
+        0x61, 0x74, 0x68, 0x20, 0x74, 0x72, 0x61, 0x63, 0x65, 0x72, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x65, 0x61, 0x64,
+        0x20, 0x6f, 0x66, 0x20, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x20, 0x72, 0x61, 0x79, 0x20, 0x74, 0x72,
+        0x61, 0x63, 0x65, 0x72, 0x0a, 0x2d, 0x6c, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x75, 0x73, 0x65, 0x5f, 0x6c, 0x69,
+        0x67, 0x68, 0x74, 0x5f, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x69, 0x6e, 0x67, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x55, 0x73, 0x65, 0x20, 0x65, 0x78, 0x70, 0x6c, 0x69, 0x63, 0x69, 0x74, 0x20, 0x6c, 0x69, 0x67, 0x68,
+        0x74, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x69, 0x6e, 0x67, 0x20, 0x28, 0x61, 0x72, 0x65, 0x61, 0x20, 0x6c,
+        0x69, 0x67, 0x68, 0x74, 0x73, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75,
+        0x6e, 0x64, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x29, 0x0a, 0x2d, 0x69, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x75,
+        0x73, 0x65, 0x5f, 0x69, 0x6d, 0x70, 0x6f, 0x72, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x5f, 0x73, 0x61, 0x6d, 0x70,
+        0x6c, 0x69, 0x6e, 0x67, 0x20, 0x20, 0x55, 0x73, 0x65, 0x20, 0x69, 0x6d, 0x70, 0x6f, 0x72, 0x74, 0x61, 0x6e,
+        0x63, 0x65, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x69, 0x6e, 0x67, 0x0a, 0x2d, 0x57, 0x20, 0x7c, 0x20, 0x2d,
+        0x2d, 0x75, 0x73, 0x65, 0x5f, 0x77, 0x61, 0x76, 0x65, 0x66, 0x72, 0x6f, 0x6e, 0x74, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x50, 0x61, 0x74, 0x68, 0x20, 0x74, 0x72, 0x61, 0x63, 0x65,
+        0x20, 0x69, 0x6e, 0x20, 0x73, 0x74, 0x61, 0x67, 0x65, 0x73, 0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x71, 0x75,
+        0x65, 0x75, 0x65, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x70, 0x61, 0x74, 0x68, 0x73, 0x20, 0x28, 0x77, 0x61, 0x76,
+        0x65, 0x66, 0x72, 0x6f, 0x6e, 0x74, 0x29, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x65, 0x61, 0x64, 0x20, 0x6f, 0x66,
+        0x20, 0x6f, 0x6e, 0x65, 0x20, 0x70, 0x61, 0x74, 0x68, 0x20, 0x61, 0x74, 0x20, 0x61, 0x20, 0x74, 0x69, 0x6d,
+        0x65, 0x0a, 0x2d, 0x62, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e,
+        0x64, 0x5f, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x53, 0x65,
+        0x74, 0x20, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65,
+        0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x62, 0x6c, 0x61, 0x63, 0x6b, 0x29, 0x0a,
+        0x2d, 0x4c, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x6c, 0x61, 0x7a, 0x79, 0x5f, 0x6d, 0x65, 0x73, 0x68, 0x65, 0x73,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4c, 0x6f, 0x61, 0x64,
+        0x20, 0x6d, 0x65, 0x73, 0x68, 0x20, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67, 0x6c, 0x65, 0x73, 0x20, 0x77, 0x68,
+        0x65, 0x6e, 0x20, 0x66, 0x69, 0x72, 0x73, 0x74, 0x20, 0x68, 0x69, 0x74, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x65,
+        0x61, 0x64, 0x20, 0x6f, 0x66, 0x20, 0x61, 0x74, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74, 0x75, 0x70, 0x0a, 0x2d,
+        0x4d, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x6d, 0x65, 0x73, 0x68, 0x5f, 0x6d, 0x65, 0x6d, 0x6f, 0x72, 0x79, 0x5f,
+        0x62, 0x75, 0x64, 0x67, 0x65, 0x74, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x52, 0x65, 0x73, 0x69, 0x64,
+        0x65, 0x6e, 0x74, 0x20, 0x6d, 0x65, 0x73, 0x68, 0x20, 0x67, 0x65, 0x6f, 0x6d, 0x65, 0x74, 0x72, 0x79, 0x20,
+        0x62, 0x75, 0x64, 0x67, 0x65, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x4d, 0x42, 0x2c, 0x20, 0x6c, 0x65, 0x61, 0x73,
+        0x74, 0x20, 0x72, 0x65, 0x63, 0x65, 0x6e, 0x74, 0x6c, 0x79, 0x20, 0x68, 0x69, 0x74, 0x20, 0x6d, 0x65, 0x73,
+        0x68, 0x65, 0x73, 0x20, 0x61, 0x72, 0x65, 0x20, 0x65, 0x76, 0x69, 0x63, 0x74, 0x65, 0x64, 0x20, 0x28, 0x64,
+        0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a, 0x20, 0x30, 0x20, 0x2d, 0x20, 0x75, 0x6e, 0x6c, 0x69, 0x6d, 0x69,
+        0x74, 0x65, 0x64, 0x29, 0x0a, 0x2d, 0x42, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x6d, 0x65, 0x73, 0x68, 0x5f, 0x61,
+        0x63, 0x63, 0x65, 0x6c, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x4d, 0x65, 0x73, 0x68, 0x20, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67, 0x6c, 0x65, 0x20, 0x61, 0x63, 0x63,
+        0x65, 0x6c, 0x65, 0x72, 0x61, 0x74, 0x6f, 0x72, 0x3a, 0x20, 0x6b, 0x64, 0x74, 0x72, 0x65, 0x65, 0x2c, 0x20,
+        0x62, 0x76, 0x68, 0x34, 0x20, 0x6f, 0x72, 0x20, 0x62, 0x76, 0x68, 0x38, 0x20, 0x28, 0x34, 0x2f, 0x38, 0x20,
+        0x77, 0x69, 0x64, 0x65, 0x20, 0x42, 0x56, 0x48, 0x29, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74,
+        0x3a, 0x20, 0x6b, 0x64, 0x74, 0x72, 0x65, 0x65, 0x29, 0x0a, 0x2d, 0x53, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x73,
+        0x74, 0x61, 0x74, 0x73, 0x5f, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x57, 0x72, 0x69, 0x74, 0x65, 0x20, 0x72, 0x65, 0x6e, 0x64, 0x65, 0x72,
+        0x20, 0x73, 0x74, 0x61, 0x74, 0x69, 0x73, 0x74, 0x69, 0x63, 0x73, 0x20, 0x28, 0x72, 0x61, 0x79, 0x73, 0x2c,
+        0x20, 0x74, 0x72, 0x61, 0x76, 0x65, 0x72, 0x73, 0x61, 0x6c, 0x2c, 0x20, 0x70, 0x61, 0x74, 0x68, 0x20, 0x6c,
+        0x65, 0x6e, 0x67, 0x74, 0x68, 0x73, 0x2c, 0x20, 0x73, 0x74, 0x61, 0x67, 0x65, 0x20, 0x74, 0x69, 0x6d, 0x65,
+        0x73, 0x29, 0x20, 0x61, 0x73, 0x20, 0x4a, 0x53, 0x4f, 0x4e, 0x2c, 0x20, 0x6e, 0x65, 0x65, 0x64, 0x73, 0x20,
+        0x61, 0x20, 0x62, 0x75, 0x69, 0x6c, 0x64, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x2d, 0x44, 0x52, 0x54, 0x5f,
+        0x53, 0x54, 0x41, 0x54, 0x53, 0x3d, 0x4f, 0x4e, 0x0a, 0x2d, 0x48, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x68, 0x65,
+        0x61, 0x74, 0x6d, 0x61, 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x57, 0x72, 0x69, 0x74, 0x65, 0x20, 0x66, 0x61, 0x6c, 0x73, 0x65, 0x20, 0x63,
+        0x6f, 0x6c, 0x6f, 0x75, 0x72, 0x20, 0x63, 0x6f, 0x73, 0x74, 0x20, 0x68, 0x65, 0x61, 0x74, 0x6d, 0x61, 0x70,
+        0x73, 0x20, 0x6e, 0x65, 0x78, 0x74, 0x20, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d, 0x61, 0x67,
+        0x65, 0x3a, 0x20, 0x6e, 0x6f, 0x64, 0x65, 0x73, 0x2c, 0x20, 0x74, 0x65, 0x73, 0x74, 0x73, 0x2c, 0x20, 0x74,
+        0x69, 0x6d, 0x65, 0x20, 0x6f, 0x72, 0x20, 0x61, 0x6c, 0x6c, 0x20, 0x28, 0x63, 0x6f, 0x6d, 0x6d, 0x61, 0x20,
+        0x73, 0x65, 0x70, 0x61, 0x72, 0x61, 0x74, 0x65, 0x64, 0x29, 0x2c, 0x20, 0x6e, 0x6f, 0x64, 0x65, 0x73, 0x20,
+        0x61, 0x6e, 0x64, 0x20, 0x74, 0x65, 0x73, 0x74, 0x73, 0x20, 0x6e, 0x65, 0x65, 0x64, 0x20, 0x2d, 0x44, 0x52,
+        0x54, 0x5f, 0x53, 0x54, 0x41, 0x54, 0x53, 0x3d, 0x4f, 0x4e, 0x0a, 0x2d, 0x44, 0x20, 0x7c, 0x20, 0x2d, 0x2d,
+        0x64, 0x65, 0x6e, 0x6f, 0x69, 0x73, 0x65, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x44, 0x65, 0x6e, 0x6f, 0x69, 0x73, 0x65, 0x20, 0x74, 0x68, 0x65,
+        0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x2c, 0x20, 0x67, 0x75, 0x69, 0x64, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20,
+        0x61, 0x6c, 0x62, 0x65, 0x64, 0x6f, 0x2c, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x20, 0x61, 0x6e, 0x64,
+        0x20, 0x64, 0x65, 0x70, 0x74, 0x68, 0x20, 0x28, 0x65, 0x64, 0x67, 0x65, 0x2d, 0x61, 0x76, 0x6f, 0x69, 0x64,
+        0x69, 0x6e, 0x67, 0x20, 0x61, 0x2d, 0x74, 0x72, 0x6f, 0x75, 0x73, 0x20, 0x77, 0x61, 0x76, 0x65, 0x6c, 0x65,
+        0x74, 0x20, 0x66, 0x69, 0x6c, 0x74, 0x65, 0x72, 0x29, 0x0a, 0x2d, 0x4f, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x61,
+        0x6f, 0x76, 0x73, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x57, 0x72, 0x69, 0x74, 0x65, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x20,
+        0x28, 0x50, 0x46, 0x4d, 0x29, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x73, 0x20, 0x6e, 0x65, 0x78, 0x74, 0x20,
+        0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x2c, 0x20, 0x72, 0x65, 0x6e, 0x64,
+        0x65, 0x72, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x61, 0x6d, 0x65, 0x20, 0x70,
+        0x61, 0x73, 0x73, 0x3a, 0x20, 0x62, 0x65, 0x61, 0x75, 0x74, 0x79, 0x2c, 0x20, 0x61, 0x6c, 0x62, 0x65, 0x64,
+        0x6f, 0x2c, 0x20, 0x6e, 0x6f, 0x72, 0x6d, 0x61, 0x6c, 0x2c, 0x20, 0x64, 0x65, 0x70, 0x74, 0x68, 0x2c, 0x20,
+        0x69, 0x64, 0x2c, 0x20, 0x65, 0x6d, 0x69, 0x73, 0x73, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x64, 0x69, 0x72, 0x65,
+        0x63, 0x74, 0x2c, 0x20, 0x69, 0x6e, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x2c, 0x20, 0x76, 0x61, 0x72, 0x69,
+        0x61, 0x6e, 0x63, 0x65, 0x20, 0x6f, 0x72, 0x20, 0x61, 0x6c, 0x6c, 0x20, 0x28, 0x63, 0x6f, 0x6d, 0x6d, 0x61,
+        0x20, 0x73, 0x65, 0x70, 0x61, 0x72, 0x61, 0x74, 0x65, 0x64, 0x29, 0x0a, 0x2d, 0x56, 0x20, 0x7c, 0x20, 0x2d,
+        0x2d, 0x73, 0x65, 0x72, 0x76, 0x65, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4b, 0x65, 0x65, 0x70, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73,
+        0x63, 0x65, 0x6e, 0x65, 0x20, 0x6c, 0x6f, 0x61, 0x64, 0x65, 0x64, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x72, 0x65,
+        0x6e, 0x64, 0x65, 0x72, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x65, 0x73, 0x73, 0x69, 0x76, 0x65, 0x20, 0x70,
+        0x72, 0x65, 0x76, 0x69, 0x65, 0x77, 0x73, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x63, 0x6c, 0x69, 0x65, 0x6e, 0x74,
+        0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x69, 0x73, 0x20, 0x55, 0x6e, 0x69, 0x78, 0x20, 0x73, 0x6f, 0x63,
+        0x6b, 0x65, 0x74, 0x20, 0x28, 0x73, 0x65, 0x65, 0x20, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x2f, 0x70,
+        0x72, 0x65, 0x76, 0x69, 0x65, 0x77, 0x5f, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x2e, 0x68, 0x70, 0x70, 0x29,
+        0x0a, 0x2d, 0x47, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x74, 0x72, 0x61, 0x63, 0x65, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x57, 0x72, 0x69,
+        0x74, 0x65, 0x20, 0x61, 0x20, 0x74, 0x69, 0x6d, 0x65, 0x6c, 0x69, 0x6e, 0x65, 0x20, 0x6f, 0x66, 0x20, 0x72,
+        0x65, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x70, 0x68, 0x61, 0x73, 0x65, 0x73, 0x20, 0x28, 0x73, 0x63, 0x65, 0x6e,
+        0x65, 0x20, 0x6c, 0x6f, 0x61, 0x64, 0x2c, 0x20, 0x6d, 0x65, 0x73, 0x68, 0x20, 0x70, 0x61, 0x72, 0x73, 0x65,
+        0x2c, 0x20, 0x62, 0x75, 0x69, 0x6c, 0x64, 0x73, 0x2c, 0x20, 0x72, 0x6f, 0x77, 0x73, 0x2c, 0x20, 0x65, 0x78,
+        0x70, 0x6f, 0x72, 0x74, 0x29, 0x20, 0x61, 0x73, 0x20, 0x61, 0x20, 0x43, 0x68, 0x72, 0x6f, 0x6d, 0x65, 0x20,
+        0x74, 0x72, 0x61, 0x63, 0x65, 0x20, 0x4a, 0x53, 0x4f, 0x4e, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x0a, 0x2d, 0x41,
+        0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x61, 0x6e, 0x69, 0x6d, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4b, 0x65, 0x79, 0x66, 0x72, 0x61,
+        0x6d, 0x65, 0x64, 0x20, 0x63, 0x61, 0x6d, 0x65, 0x72, 0x61, 0x2f, 0x6f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x20,
+        0x61, 0x6e, 0x69, 0x6d, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x28, 0x4a, 0x53,
+        0x4f, 0x4e, 0x2c, 0x20, 0x73, 0x65, 0x65, 0x20, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x2f, 0x61, 0x6e,
+        0x69, 0x6d, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x2e, 0x68, 0x70, 0x70, 0x29, 0x0a, 0x2d, 0x46, 0x20, 0x7c, 0x20,
+        0x2d, 0x2d, 0x66, 0x72, 0x61, 0x6d, 0x65, 0x73, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4e, 0x75, 0x6d, 0x62, 0x65, 0x72, 0x20, 0x6f, 0x66,
+        0x20, 0x66, 0x72, 0x61, 0x6d, 0x65, 0x73, 0x20, 0x74, 0x6f, 0x20, 0x72, 0x65, 0x6e, 0x64, 0x65, 0x72, 0x2c,
+        0x20, 0x6f, 0x6e, 0x65, 0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x70,
+        0x65, 0x72, 0x20, 0x66, 0x72, 0x61, 0x6d, 0x65, 0x20, 0x28, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x3a,
+        0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x61, 0x6e, 0x69, 0x6d, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x6f,
+        0x72, 0x20, 0x31, 0x29, 0x0a, 0x2d, 0x59, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x76, 0x69, 0x65, 0x77, 0x73, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x52, 0x65, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x73, 0x65, 0x76, 0x65, 0x72, 0x61, 0x6c, 0x20, 0x63, 0x61,
+        0x6d, 0x65, 0x72, 0x61, 0x20, 0x76, 0x69, 0x65, 0x77, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20,
+        0x73, 0x63, 0x65, 0x6e, 0x65, 0x20, 0x69, 0x6e, 0x20, 0x6f, 0x6e, 0x65, 0x20, 0x70, 0x72, 0x6f, 0x63, 0x65,
+        0x73, 0x73, 0x2c, 0x20, 0x6f, 0x6e, 0x65, 0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74, 0x20, 0x66, 0x69, 0x6c,
+        0x65, 0x20, 0x70, 0x65, 0x72, 0x20, 0x76, 0x69, 0x65, 0x77, 0x20, 0x28, 0x4a, 0x53, 0x4f, 0x4e, 0x2c, 0x20,
+        0x73, 0x65, 0x65, 0x20, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x2f, 0x76, 0x69, 0x65, 0x77, 0x73, 0x2e,
+        0x68, 0x70, 0x70, 0x29, 0x0a, 0x2d, 0x4e, 0x20, 0x7c, 0x20, 0x2d, 0x2d, 0x74, 0x75, 0x72, 0x6e, 0x74, 0x61,
+        0x62, 0x6c, 0x65, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x52, 0x65, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x4e, 0x20, 0x76, 0x69, 0x65, 0x77, 0x73, 0x20, 0x6f, 0x72,
+        0x62, 0x69, 0x74, 0x69, 0x6e, 0x67, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x61, 0x6d, 0x65, 0x72, 0x61, 0x20,
+        0x61, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6c, 0x6f, 0x6f, 0x6b, 0x2d, 0x61, 0x74,
+        0x20, 0x70, 0x6f, 0x69, 0x6e, 0x74, 0x2c, 0x20, 0x6f, 0x6e, 0x65, 0x20, 0x6f, 0x75, 0x74, 0x70, 0x75, 0x74,
+        0x20, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x70, 0x65, 0x72, 0x20, 0x76, 0x69, 0x65, 0x77, 0x0a, 0x2d, 0x43, 0x20,
+        0x7c, 0x20, 0x2d, 0x2d, 0x62, 0x72, 0x64, 0x66, 0x5f, 0x63, 0x61, 0x63, 0x68, 0x65, 0x20, 0x20, 0x20, 0x20,
+        0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x44, 0x69, 0x72, 0x65, 0x63, 0x74, 0x6f,
+        0x72, 0x79, 0x20, 0x74, 0x6f, 0x20, 0x63, 0x61, 0x63, 0x68, 0x65, 0x20, 0x6d, 0x65, 0x61, 0x73, 0x75, 0x72,
+        0x65, 0x64, 0x20, 0x42, 0x52, 0x44, 0x46, 0x73, 0x20, 0x63, 0x6f, 0x6e, 0x76, 0x65, 0x72, 0x74, 0x65, 0x64,
+        0x20, 0x74, 0x6f, 0x20, 0x66, 0x6c, 0x6f, 0x61, 0x74, 0x73, 0x20, 0x69, 0x6e, 0x2c, 0x20, 0x72, 0x65, 0x75,
+        0x73, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20, 0x6c, 0x61, 0x74, 0x65, 0x72, 0x20, 0x72, 0x75, 0x6e, 0x73
 };
-unsigned int help_txt_len = 1108;
+unsigned int help_txt_len = 3563;
@@ -4,8 +4,10 @@
 #include "ray.hpp"
 #include "triangle.hpp"
 #include "vec3.hpp"
+#include <cstdint>
 double clamp (double min, double x, double max);
 double random_double (double min, double max);
+void seed_random (uint64_t seed);
 double deg2rad (double deg);
 Vec3 random_in_unit_disk ();
 bool hit_box (Vec3 point,
@@ -20,9 +22,14 @@ bool hit_box (Vec3 point,
 void log_error (const char *message, ...);
 void log_warn (const char *message, ...);
 void log_info (const char *message, ...);
+Mat3 rotateX (double deg);
+Mat3 rotateY (double deg);
+Mat3 rotateZ (double deg);
 Mat3 texture_projection_matrix (Vec3 xy1, Vec3 xy2, Vec3 xy3, Vec3 uv1, Vec3 uv2, Vec3 uv3);
 std::vector<Triangle *> load_obj_mesh (char *obj_filename, Material *material);
+std::vector<Triangle *> load_ply_mesh (char *ply_filename, Material *material);
 Vec3 compute_mesh_centroid (std::vector<Triangle *> mesh_triangles);
+bool degenerate_triangle (Vec3 v1, Vec3 v2, Vec3 v3);
 double difference_of_products (double a, double b, double c, double d);
 double sum_of_products (double a, double b, double c, double d);
 bool nearlyEqual (double a, double b);
\ No newline at end of file
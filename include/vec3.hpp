@@ -70,6 +70,8 @@ class Vec3 {
         static Vec3 random ();
         static Vec3 zero ();
         static Vec3 inf ();
+        static Vec3 min (Vec3 a, Vec3 b);
+        static Vec3 max (Vec3 a, Vec3 b);
 
         // friends
         friend Vec3 operator* (double scalar, Vec3 a);
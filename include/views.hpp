@@ -0,0 +1,49 @@
+/**
+    @file views.hpp
+
+    @brief Batch views: rt --views views.json renders one scene from several
+    cameras in one process, so that the scene is loaded and its acceleration
+    structures are built once for all of them (multi-angle shots,
+    turntables).
+
+    A views file is JSON. Every field of a view is optional and defaults to
+    the camera given on the command line:
+
+        {
+            "views": [
+                { "name": "front", "lookfrom": [0, 1, 2], "lookat": [0, 1, -1] },
+                { "name": "top", "lookfrom": [0, 1.9, -1], "lookat": [0, 0, -1], "vup": [0, 0, -1],
+                  "vfov": 90, "focus_dist": 0, "defocus_angle": 2, "sensor_shift": [0, 0.1] }
+            ],
+            "turntable": { "views": 36, "lookat": [0, 0.65, -1] }
+        }
+
+    A turntable adds views that orbit lookfrom around the vup axis through
+    lookat, evenly spaced over a full turn. Both also default to the command
+    line camera, rt --turntable N is a turntable of N views around it.
+
+    A view is written to the output file name with its name inserted before
+    the extension (out.ppm -> out_front.ppm). Views without a name are
+    numbered like the frames of an animation (out_0003.ppm).
+*/
+
+#pragma once
+
+#include "camera.hpp"
+#include "vec3.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+class Views {
+    public:
+        // (name, view), the name may be empty
+        std::vector<std::pair<std::string, Camera::View> > views;
+
+        Views ();
+        Views (const char *filename, Camera::View camera);
+
+        bool empty ();
+        void turntable (int n, Camera::View camera);
+        std::string filename (const char *filename, size_t view);
+};
@@ -0,0 +1,122 @@
+/**
+    @file wavefront.hpp
+
+    @brief Wavefront path tracer.
+
+    Camera::single_path_color follows one path at a time, interleaving
+    intersection and shading for every bounce. The wavefront integrator
+    instead keeps a queue of in-flight paths per thread and advances all of
+    them one stage at a time:
+
+        generate  camera rays for the pixels of the rows the thread owns,
+                  into the slots freed by finished paths
+        extend    intersects every active path's ray with the world
+        shade     scatters the paths that hit something, grouped by
+                  material id so that each material's code runs over a
+                  contiguous batch
+        shadow    traces the shadow rays queued by shade for explicit light
+                  and environment sampling
+        retire    adds finished paths to their pixel
+
+    Each stage is a tight loop over the queue. Path state is kept as a
+    structure of arrays (one vector per field) so that a stage only touches
+    the fields it needs. Rays stay whole Ray objects because World::hit
+    consumes them one at a time.
+
+    The estimator is the same as single_path_color's (throughput, light and
+    environment sampling with MIS), only the order in which the work is
+    done differs.
+*/
+
+#pragma once
+
+#include "camera.hpp"
+#include "hitrecord.hpp"
+#include "ray.hpp"
+#include "smooth_object.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+#include <atomic>
+#include <cstdint>
+#include <semaphore>
+#include <vector>
+
+class WavefrontIntegrator {
+    public:
+        WavefrontIntegrator (Camera *camera, World *world);
+
+        // renders the camera's image on nthreads threads, one pixel per element
+        std::vector<Vec3> render (int nthreads);
+
+    private:
+        /**
+                One thread's paths, slot s of every vector belongs to the
+                same path. radiance is what the path has gathered so far,
+                throughput the product of the bounces' brdf * cos / pdf.
+
+                A light sample only counts if the path's next ray does not
+                hit the sampled light itself (the scattered ray already
+                accounts for it): it waits in pending until the next extend
+                stage. Paths that reached max_depth or an emitter are
+                terminal, they are retired by the next extend stage.
+         */
+        struct Paths {
+                std::vector<Ray> rays;
+                std::vector<HitRecord> records;
+                std::vector<Vec3> throughput;
+                std::vector<Vec3> radiance;
+                std::vector<Vec3> pending;
+                std::vector<SmoothObject *> pending_light;
+                std::vector<double> mis_pdf;
+                std::vector<int> depth;
+                std::vector<uint8_t> terminal;
+                std::vector<uint32_t> pixel;
+        };
+
+        /**
+                Shadow rays queued by the shade stage. A light sample tests
+                the segment from origin to target and becomes the path's
+                pending sample, an environment sample tests the ray from
+                origin along direction and is added to the path's radiance.
+         */
+        struct ShadowRays {
+                std::vector<uint32_t> slot;
+                std::vector<Vec3> origin;
+                std::vector<Vec3> target;
+                std::vector<Vec3> direction;
+                std::vector<Vec3> radiance;
+                std::vector<SmoothObject *> light;
+        };
+
+        struct Queue {
+                Paths paths;
+                ShadowRays shadows;
+
+                std::vector<uint32_t> free;
+                std::vector<uint32_t> active;
+                std::vector<uint32_t> hits;
+                std::vector<uint32_t> shade;
+                std::vector<uint32_t> counts;
+
+                // row being generated, next pixel and sample in it
+                int row;
+                int column;
+                int sample;
+        };
+
+        Camera *camera;
+        World *world;
+
+        std::vector<Vec3> pixels;
+        // samples of each row that are still in flight
+        std::vector<int> row_samples;
+        std::atomic<int> next_row;
+        std::counting_semaphore<> progress;
+
+        void _worker (Queue &queue);
+        bool _generate (Queue &queue);
+        void _extend (Queue &queue);
+        void _shade (Queue &queue);
+        void _shadow (Queue &queue);
+        void _retire (Queue &queue, uint32_t slot);
+};
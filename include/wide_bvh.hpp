@@ -0,0 +1,68 @@
+/**
+    @file wide_bvh.hpp
+
+    @brief N-ary (4 or 8 wide) bounding volume hierarchy over the triangles of
+    a mesh.
+
+    The tree is first built as a binary BVH with the binned surface area
+    heuristic, then collapsed: each wide node takes the two children of a
+    binary node and keeps replacing its largest inner child by that child's
+    own children until it has N of them.
+
+    The boxes of a node's children are stored as structures of arrays
+    (min_x[N], min_y[N], ...), so one loop over the N lanes, which the
+    compiler vectorizes, tests all of them against a RayPrecomputed.
+    Children that are hit are visited nearest first, and skipped once a
+    triangle closer than their entry distance has been found.
+
+    Meshes use it instead of their KDTree when Mesh::accelerator asks for
+    it.
+*/
+
+#pragma once
+
+#include "hitrecord.hpp"
+#include "ray.hpp"
+#include "triangle.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct WideBVHBuilder;
+
+template <int N> class WideBVH {
+    public:
+        struct alignas (64) Node {
+                double min_x[N], min_y[N], min_z[N];
+                double max_x[N], max_y[N], max_z[N];
+                // inner children: index of their node, leaves: first triangle
+                uint32_t child[N];
+                // triangles of leaf children, 0 for inner children
+                uint32_t count[N];
+                // used lanes, the children are packed at the front
+                int size;
+        };
+
+        struct BuildStats {
+                size_t nodes;
+                size_t leaves;
+                // of the binary tree
+                size_t max_depth;
+                double build_seconds;
+        };
+
+        BuildStats stats;
+
+        std::vector<Node> nodes;
+        // in leaf order
+        std::vector<Triangle *> triangles;
+
+        WideBVH ();
+        WideBVH (std::vector<Triangle *> triangles);
+
+        bool ray_hit (Ray r, HitRecord &record);
+        size_t memory_usage ();
+
+    private:
+        uint32_t _collapse (WideBVHBuilder &builder, int binary);
+};
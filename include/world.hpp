@@ -1,9 +1,14 @@
 #pragma once
+#include "bvh.hpp"
 #include "light.hpp"
 #include "object.hpp"
 #include "ray.hpp"
 #include "smooth_object.hpp"
 #include "vec3.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class World {
@@ -17,8 +22,22 @@ class World {
         std::vector<Light *> lights;
         std::vector<SmoothObject *> emissives;
         std::vector<struct Photon> photons;
+
+        // built by build (), objects without bounds are tested one by one
+        BVH bvh;
+        std::vector<Object *> unbounded;
+
+        // objects added with a name, e.g. to be moved by an Animation
+        std::map<std::string, Object *> named_objects;
+
         World ();
         void add (Object *obj);
+        void add (Object *obj, std::string name);
+        Object *find (std::string name);
+        // 1 + index of obj in objects, 0 if it was not added (see HitRecord::root)
+        uint32_t id (Object *obj);
+        void build ();
+        void update ();
         bool hit (Ray r, HitRecord &record);
         SmoothObject *random_light ();
         bool has_path (Ray r, Object *obj);
@@ -26,4 +45,8 @@ class World {
         void add_light (Light *light);
         Vec3 photon_map_color (Vec3 point);
         void photon_map_forward_pass ();
+
+    private:
+        bool _built;
+        std::unordered_map<Object *, uint32_t> _ids;
 };
\ No newline at end of file
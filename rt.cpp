@@ -1,28 +1,40 @@
 #include "MERNBRDF.hpp"
+#include "animation.hpp"
 #include "camera.hpp"
+#include "heatmap.hpp"
 #include "checkerboard.hpp"
 #include "dielectric.hpp"
+#include "framebuffer.hpp"
 #include "image_texture.hpp"
 #include "lambertian.hpp"
+#include "merl.hpp"
+#include "mesh.hpp"
 #include "metal.hpp"
 #include "phong.hpp"
 #include "plane.hpp"
 #include "point_light.hpp"
+#include "preview_server.hpp"
 #include "quad.hpp"
 #include "quad_light.hpp"
 #include "solid_texture.hpp"
 #include "sphere.hpp"
+#include "trace.hpp"
 #include "usage.hpp"
 #include "utils.hpp"
 #include "vec3.hpp"
+#include "views.hpp"
 #include "world.hpp"
 
+#include <cerrno>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <getopt.h>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <time.h>
 #include <unistd.h>
@@ -34,9 +46,39 @@ void usage ()
         fprintf (stderr, "%s", help_txt);
 }
 
-struct Camera::RendererSettings process_arguments (int argc, char **argv, char *&filename, int &nthreads)
+/**
+        Reads n comma separated numbers (x,y,z) of an option, exits if it
+        has more or fewer.
+ */
+static void parse_doubles (const char *option, const char *arg, double *values, int n)
 {
-        memset (&config, 0, sizeof (struct Camera::RendererSettings));
+        char *end = (char *)arg;
+
+        for (int k = 0; k < n; k++) {
+                values[k] = strtod (k ? end + 1 : end, &end);
+
+                if ((k < n - 1 && *end != ',') || (k == n - 1 && *end != '\0')) {
+                        log_error ("Error reading --%s, must be %d comma separated numbers (eg %s)", option, n,
+                                   n == 3 ? "0,1,2" : "0,0.1");
+                        exit (EXIT_FAILURE);
+                }
+        }
+}
+
+static Vec3 parse_vec3 (const char *option, const char *arg)
+{
+        double xyz[3];
+
+        parse_doubles (option, arg, xyz, 3);
+
+        return Vec3 (xyz[0], xyz[1], xyz[2]);
+}
+
+struct Camera::RendererSettings process_arguments (int argc, char **argv, char *&filename, int &nthreads,
+                                                   char *&animation_file, int &frames, char *&trace_file,
+                                                   char *&serve_path, char *&views_file, int &turntable)
+{
+        config = Camera::RendererSettings ();
 
         config.image_width = 600;
         config.aspect_ratio = 16.0 / 9;
@@ -44,10 +86,19 @@ struct Camera::RendererSettings process_arguments (int argc, char **argv, char *
         config.arealight_samples = 10;
         config.samples_per_pixel = 1000;
         config.max_depth = 8;
+        config.lookfrom = Vec3 (0, 1, 2);
+        config.lookat = Vec3 (0, 1, -1);
+        config.vup = Vec3 (0, 1, 0);
+        config.focus_dist = 1;
         config.use_light_sampling = false;
         config.use_path_tracer = false;
         config.use_importance_sampling = false;
         config.use_scene_sig = false;
+        config.use_wavefront = false;
+        config.stats_file = NULL;
+        config.heatmaps = 0;
+        config.aovs = 0;
+        config.denoise = false;
         config.background_texture = new SolidTexture (Vec3 (0, 0, 0));
 
         struct option longopts[] = {
@@ -66,6 +117,26 @@ struct Camera::RendererSettings process_arguments (int argc, char **argv, char *
                 { .name = "use_scene_sig", .has_arg = 0, .val = 'x' },
                 { .name = "background_image", .has_arg = 1, .val = 'b' },
                 { .name = "use_importance_sampling", .has_arg = 0, .val = 'i' },
+                { .name = "lazy_meshes", .has_arg = 0, .val = 'L' },
+                { .name = "mesh_memory_budget", .has_arg = 1, .val = 'M' },
+                { .name = "animation", .has_arg = 1, .val = 'A' },
+                { .name = "frames", .has_arg = 1, .val = 'F' },
+                { .name = "brdf_cache", .has_arg = 1, .val = 'C' },
+                { .name = "use_wavefront", .has_arg = 0, .val = 'W' },
+                { .name = "mesh_accel", .has_arg = 1, .val = 'B' },
+                { .name = "stats_file", .has_arg = 1, .val = 'S' },
+                { .name = "trace", .has_arg = 1, .val = 'G' },
+                { .name = "heatmap", .has_arg = 1, .val = 'H' },
+                { .name = "aovs", .has_arg = 1, .val = 'O' },
+                { .name = "denoise", .has_arg = 0, .val = 'D' },
+                { .name = "serve", .has_arg = 1, .val = 'V' },
+                { .name = "lookfrom", .has_arg = 1, .val = 'E' },
+                { .name = "lookat", .has_arg = 1, .val = 'Q' },
+                { .name = "vup", .has_arg = 1, .val = 'U' },
+                { .name = "focus_dist", .has_arg = 1, .val = 'Z' },
+                { .name = "sensor_shift", .has_arg = 1, .val = 'X' },
+                { .name = "views", .has_arg = 1, .val = 'Y' },
+                { .name = "turntable", .has_arg = 1, .val = 'N' },
                 { 0 }
         };
         int c, optidx;
@@ -132,6 +203,84 @@ struct Camera::RendererSettings process_arguments (int argc, char **argv, char *
                         config.use_scene_sig = true;
                         break;
                 }
+                case 'L': {
+                        Mesh::lazy_loading = true;
+                        break;
+                }
+                case 'M': {
+                        // megabytes
+                        Mesh::memory_budget = strtoull (optarg, NULL, 10) << 20;
+                        break;
+                }
+                case 'A': animation_file = optarg; break;
+                case 'F': frames = strtol (optarg, NULL, 10); break;
+                case 'C': MerlBRDF::cache_directory = optarg; break;
+                case 'W': {
+                        config.use_wavefront = true;
+                        break;
+                }
+                case 'B': {
+                        if (!strcmp (optarg, "kdtree")) {
+                                Mesh::accelerator = Mesh::Accelerator::KDTree;
+                        } else if (!strcmp (optarg, "bvh4")) {
+                                Mesh::accelerator = Mesh::Accelerator::BVH4;
+                        } else if (!strcmp (optarg, "bvh8")) {
+                                Mesh::accelerator = Mesh::Accelerator::BVH8;
+                        } else {
+                                log_error ("Unknown mesh accelerator `%s`, must be one of kdtree, bvh4, bvh8", optarg);
+                                exit (EXIT_FAILURE);
+                        }
+                        break;
+                }
+                case 'S': {
+#ifndef RT_STATS
+                        log_warn ("rt was built without RT_STATS, no render statistics will be written to %s", optarg);
+#endif
+                        config.stats_file = optarg;
+                        break;
+                }
+                case 'G': trace_file = optarg; break;
+                case 'V': serve_path = optarg; break;
+                case 'E': config.lookfrom = parse_vec3 ("lookfrom", optarg); break;
+                case 'Q': config.lookat = parse_vec3 ("lookat", optarg); break;
+                case 'U': config.vup = parse_vec3 ("vup", optarg); break;
+                case 'Z': config.focus_dist = strtod (optarg, NULL); break;
+                case 'X': parse_doubles ("sensor_shift", optarg, config.sensor_shift, 2); break;
+                case 'Y': views_file = optarg; break;
+                case 'N': turntable = strtol (optarg, NULL, 10); break;
+                case 'H': {
+                        config.heatmaps = Heatmap::parse (optarg);
+
+                        if (config.heatmaps < 0) {
+                                log_error ("Unknown heatmap in `%s`, must be a comma separated list of nodes, tests, "
+                                           "time or all",
+                                           optarg);
+                                exit (EXIT_FAILURE);
+                        }
+#ifndef RT_STATS
+                        if (config.heatmaps & (Heatmap::Kind::Nodes | Heatmap::Kind::Tests)) {
+                                log_warn ("rt was built without RT_STATS, the nodes and tests heatmaps need its "
+                                          "counters and are left out");
+                                config.heatmaps &= Heatmap::Kind::Time;
+                        }
+#endif
+                        break;
+                }
+                case 'O': {
+                        config.aovs = FrameBuffer::parse (optarg);
+
+                        if (config.aovs < 0) {
+                                log_error ("Unknown AOV in `%s`, must be a comma separated list of beauty, albedo, "
+                                           "normal, depth, id, emission, direct, indirect, variance or all",
+                                           optarg);
+                                exit (EXIT_FAILURE);
+                        }
+                        break;
+                }
+                case 'D': {
+                        config.denoise = true;
+                        break;
+                }
                 case 'h': {
                         usage ();
                         exit (EXIT_SUCCESS);
@@ -142,15 +291,42 @@ struct Camera::RendererSettings process_arguments (int argc, char **argv, char *
         return config;
 }
 
+static void write_trace (const char *trace_file)
+{
+        if (!trace_file)
+                return;
+
+        if (Trace::write (trace_file))
+                log_info ("Wrote trace to %s, open it in ui.perfetto.dev or chrome://tracing", trace_file);
+        else
+                log_error ("Failed to write trace file %s: %s", trace_file, strerror (errno));
+}
+
+static void render (Camera &camera, World &world, const char *filename, int nthreads)
+{
+        if (nthreads > 1) {
+                camera.render_multithreaded (&world, filename, nthreads);
+        } else {
+                camera.render (&world, filename);
+        }
+}
+
 int main (int argc, char **argv)
 {
         int nthreads = -1;
 
         char *filename = NULL;
+        char *animation_file = NULL;
+        char *trace_file = NULL;
+        char *serve_path = NULL;
+        char *views_file = NULL;
+        int frames = 0;
+        int turntable = 0;
 
-        struct Camera::RendererSettings config = process_arguments (argc, argv, filename, nthreads);
+        struct Camera::RendererSettings config = process_arguments (
+                argc, argv, filename, nthreads, animation_file, frames, trace_file, serve_path, views_file, turntable);
 
-        if (!filename) {
+        if (!filename && !serve_path) {
                 log_error ("Must provide --out_file | -f argument");
                 usage ();
                 exit (EXIT_FAILURE);
@@ -162,6 +338,11 @@ int main (int argc, char **argv)
                 exit (EXIT_FAILURE);
         }
 
+        if ((views_file || turntable > 0) && (animation_file || frames > 0)) {
+                log_error ("--views and --turntable cannot be combined with --animation or --frames");
+                exit (EXIT_FAILURE);
+        }
+
         if (config.use_path_tracer && config.samples_per_pixel < 500)
                 log_warn ("Path tracer is enabled, pixel sample count %d < 500. Consider setting sample count >= 500.",
                           config.samples_per_pixel);
@@ -171,6 +352,11 @@ int main (int argc, char **argv)
          */
         std::srand (time (NULL));
 
+        if (trace_file)
+                Trace::start ();
+
+        uint64_t scene_start = Trace::now ();
+
         Camera camera;
         camera.initialize (config);
 
@@ -242,18 +428,100 @@ int main (int argc, char **argv)
         world.add (&floor);
         world.add (&light_panel);
 
-        world.add (&sp3);
+        world.add (&sp3, "glass_sphere");
         // world.add (&sp4);
         // world.add (&sp5);
 
+        Animation animation;
+
+        if (animation_file) {
+                try {
+                        animation = Animation (animation_file);
+                } catch (std::runtime_error &e) {
+                        log_error ("%s", e.what ());
+                        exit (EXIT_FAILURE);
+                }
+        }
+
+        if (frames > 0)
+                animation.frames = frames;
+
+        Views views;
+
+        try {
+                if (views_file)
+                        views = Views (views_file, camera.view ());
+        } catch (std::runtime_error &e) {
+                log_error ("%s", e.what ());
+                exit (EXIT_FAILURE);
+        }
+
+        if (turntable > 0)
+                views.turntable (turntable, camera.view ());
+
         if (nthreads < 0)
                 nthreads = std::thread::hardware_concurrency ();
 
-        if (nthreads > 1) {
-                camera.render_multithreaded (&world, filename, nthreads);
-        } else {
-                camera.render (&world, filename);
+        Trace::record ("scene load", scene_start);
+
+        /**
+                The scene stays loaded while clients edit the camera, see
+                preview_server.hpp.
+         */
+        if (serve_path) {
+                animation.apply (0, camera, world);
+                world.update ();
+
+                PreviewServer server (&camera, &world, nthreads);
+
+                if (!server.serve (serve_path))
+                        exit (EXIT_FAILURE);
+
+                write_trace (trace_file);
+                return 0;
         }
 
+        /**
+                Views share everything but the camera, the BVH is built once
+                for all of them.
+         */
+        if (!views.empty ()) {
+                world.update ();
+
+                for (size_t view = 0; view < views.views.size (); view++) {
+                        TRACE_SCOPE_ARG ("view", "view", int (view));
+
+                        std::string view_file = views.filename (filename, view);
+
+                        camera.set_view (views.views[view].second);
+
+                        log_info ("Rendering view %zu/%zu to %s", view + 1, views.views.size (), view_file.c_str ());
+                        render (camera, world, view_file.c_str (), nthreads);
+                }
+
+                write_trace (trace_file);
+                return 0;
+        }
+
+        /**
+                Everything above is set up once: every frame only moves the
+                camera and objects, and refits the BVH.
+         */
+        for (int frame = 0; frame < animation.frames; frame++) {
+                TRACE_SCOPE_ARG ("frame", "frame", frame);
+
+                std::string frame_file = Animation::frame_filename (filename, frame, animation.frames);
+
+                animation.apply (frame, camera, world);
+                world.update ();
+
+                if (animation.frames > 1)
+                        log_info ("Rendering frame %d/%d to %s", frame + 1, animation.frames, frame_file.c_str ());
+
+                render (camera, world, frame_file.c_str (), nthreads);
+        }
+
+        write_trace (trace_file);
+
         return 0;
 }
@@ -0,0 +1,536 @@
+/**
+    rt-bench renders a fixed set of scenes with fixed seeds and prints a JSON
+    report: setup and acceleration structure build times, primary, secondary
+    and shadow rays per second, how busy each render thread was and the
+    memory high-water mark. Compare reports between commits to catch
+    regressions, or between machines.
+
+        $ ./bin/rt-bench --nthreads 8 --out_file bench.json
+        $ ./bin/rt-bench --scene dragon --samples_per_pixel 64
+
+    Images are rendered in memory and not written, the report carries each
+    image's mean so that a change in the output does not go unnoticed.
+    Every pixel seeds its own random numbers from the seed and its index,
+    so the images do not depend on which thread renders which row. Every
+    scene runs in a process of its own, so that its max_rss_bytes is its
+    own peak and not the largest of the scenes before it.
+*/
+
+#include "camera.hpp"
+#include "checkerboard.hpp"
+#include "dielectric.hpp"
+#include "image_texture.hpp"
+#include "lambertian.hpp"
+#include "lib/json.hpp"
+#include "mesh.hpp"
+#include "metal.hpp"
+#include "quad.hpp"
+#include "solid_texture.hpp"
+#include "sphere.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using json = nlohmann::json;
+
+Camera::RendererSettings config;
+
+struct BenchOptions {
+        int nthreads;
+        int image_width;
+        int samples_per_pixel;
+        int max_depth;
+        unsigned seed;
+        const char *scene;
+        const char *out_file;
+};
+
+static const char *usage_text =
+        "usage: rt-bench [ARGUMENTS]\n"
+        "\n"
+        "ARGUMENTS:\n"
+        "--nthreads             Render threads (default: OS suggested value)\n"
+        "--image_width          Image width, the aspect ratio is 16/9 (default: 320)\n"
+        "--samples_per_pixel    Samples per pixel (default: 8)\n"
+        "--max_depth            Max ray bounce depth (default: 8)\n"
+        "--seed                 Seed of the random number generator (default: 1)\n"
+        "--mesh_accel           Mesh triangle accelerator: kdtree, bvh4 or bvh8 (default: kdtree)\n"
+        "--scene                Only run this scene: cornell_glass, dragon, bunny, spheres, environment\n"
+        "--out_file             Write the JSON report here instead of stdout\n"
+        "--help                 Show this help message\n";
+
+static double seconds_since (std::chrono::steady_clock::time_point start)
+{
+        return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+// peak resident set size of the process so far, see run_isolated
+static uint64_t max_rss_bytes ()
+{
+        struct rusage usage;
+
+        getrusage (RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+        return uint64_t (usage.ru_maxrss);
+#else
+        return uint64_t (usage.ru_maxrss) * 1024;
+#endif
+}
+
+/**
+        Renders world from the given point of view and reports on it. Each
+        thread takes rows from a shared counter; the time it spends
+        sampling pixels over the wall clock time of the render is its
+        utilization.
+ */
+static json run (const char *name, BenchOptions &options, World &world, Camera::RendererSettings settings,
+                 Vec3 look_from, Vec3 look_at, double setup_seconds, std::vector<Mesh *> meshes)
+{
+        // random numbers drawn outside the render threads, which seed per pixel
+        std::srand (options.seed);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+        world.build ();
+        double bvh_seconds = seconds_since (start);
+
+        double mesh_seconds = 0;
+
+        for (Mesh *mesh : meshes)
+                mesh_seconds += mesh->build_seconds ();
+
+        Camera camera;
+        camera.initialize (settings);
+        camera.look (look_from, look_at);
+
+        int image_width = settings.image_width;
+        int image_height = int (image_width / settings.aspect_ratio);
+
+        std::vector<Vec3> pixels (size_t (image_width) * image_height);
+        std::vector<Camera::RayCounts> counts (options.nthreads);
+        std::vector<double> busy (options.nthreads);
+        std::vector<std::thread> threads;
+        std::atomic<int> next_row (0);
+
+        log_info ("Running %s: %d x %d, %d samples per pixel, %d threads", name, image_width, image_height,
+                  settings.samples_per_pixel, options.nthreads);
+
+        start = std::chrono::steady_clock::now ();
+
+        for (int t = 0; t < options.nthreads; t++) {
+                threads.push_back (std::thread ([&, t] {
+                        std::chrono::steady_clock::time_point thread_start = std::chrono::steady_clock::now ();
+
+                        Camera::ray_counts = {};
+
+                        for (int j = next_row++; j < image_height; j = next_row++)
+                                for (int i = 0; i < image_width; i++) {
+                                        size_t pixel = i + size_t (j) * image_width;
+
+                                        seed_random ((uint64_t (options.seed) << 32) | pixel);
+                                        pixels[pixel] = camera.sample_pixel (&world, i, j);
+                                }
+
+                        counts[t] = Camera::ray_counts;
+                        busy[t] = seconds_since (thread_start);
+                }));
+        }
+
+        for (std::thread &t : threads)
+                t.join ();
+
+        double render_seconds = seconds_since (start);
+
+        Camera::RayCounts total = {};
+        json utilization = json::array ();
+
+        for (int t = 0; t < options.nthreads; t++) {
+                total.primary += counts[t].primary;
+                total.secondary += counts[t].secondary;
+                total.shadow += counts[t].shadow;
+                utilization.push_back (render_seconds > 0 ? busy[t] / render_seconds : 0);
+        }
+
+        Vec3 mean (0, 0, 0);
+
+        for (Vec3 &p : pixels)
+                mean += p / double (pixels.size ());
+
+        uint64_t rays = total.primary + total.secondary + total.shadow;
+
+        json report;
+
+        report["name"] = name;
+        report["objects"] = world.objects.size ();
+        report["setup_seconds"] = setup_seconds;
+        report["bvh_build_seconds"] = bvh_seconds;
+        report["mesh_build_seconds"] = mesh_seconds;
+        report["render_seconds"] = render_seconds;
+        report["rays"] = { { "primary", total.primary },
+                           { "secondary", total.secondary },
+                           { "shadow", total.shadow },
+                           { "total", rays } };
+        report["rays_per_second"] = { { "primary", total.primary / render_seconds },
+                                      { "secondary", total.secondary / render_seconds },
+                                      { "shadow", total.shadow / render_seconds },
+                                      { "total", rays / render_seconds } };
+        report["thread_utilization"] = utilization;
+        report["max_rss_bytes"] = max_rss_bytes ();
+        report["image_mean"] = { mean[0], mean[1], mean[2] };
+
+        log_info ("%s: %.3fs, %.2f Mrays/s", name, render_seconds, rays / render_seconds / 1e6);
+
+        return report;
+}
+
+/**
+        Runs bench in a child process and returns its report. The child
+        starts out as small as the parent before any scene was loaded, so
+        the peak memory it reports is that of its scene alone.
+ */
+static json run_isolated (const char *name, std::function<json (BenchOptions &)> bench, BenchOptions &options)
+{
+        int fds[2];
+
+        if (pipe (fds) != 0) {
+                log_error ("Failed to create a pipe for scene %s: %s", name, strerror (errno));
+                exit (EXIT_FAILURE);
+        }
+
+        // or the child flushes the parent's buffered output a second time
+        fflush (stdout);
+        fflush (stderr);
+
+        pid_t pid = fork ();
+
+        if (pid < 0) {
+                log_error ("Failed to fork for scene %s: %s", name, strerror (errno));
+                exit (EXIT_FAILURE);
+        }
+
+        if (pid == 0) {
+                close (fds[0]);
+
+                std::string report = bench (options).dump ();
+
+                for (size_t written = 0; written < report.size ();) {
+                        ssize_t n = write (fds[1], report.data () + written, report.size () - written);
+
+                        if (n <= 0)
+                                _exit (EXIT_FAILURE);
+
+                        written += n;
+                }
+
+                fflush (stdout);
+                fflush (stderr);
+                _exit (EXIT_SUCCESS);
+        }
+
+        close (fds[1]);
+
+        std::string report;
+        char buffer[4096];
+        ssize_t n;
+
+        while ((n = read (fds[0], buffer, sizeof (buffer))) > 0)
+                report.append (buffer, n);
+
+        close (fds[0]);
+
+        int status;
+
+        if (waitpid (pid, &status, 0) < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != EXIT_SUCCESS ||
+            report.empty ()) {
+                log_error ("Scene %s failed", name);
+                exit (EXIT_FAILURE);
+        }
+
+        return json::parse (report);
+}
+
+static Camera::RendererSettings settings_for (BenchOptions &options)
+{
+        static SolidTexture black (Vec3 (0, 0, 0));
+
+        Camera::RendererSettings settings = Camera::RendererSettings ();
+
+        settings.image_width = options.image_width;
+        settings.aspect_ratio = 16.0 / 9;
+        settings.vfov = 60;
+        settings.arealight_samples = 10;
+        settings.samples_per_pixel = options.samples_per_pixel;
+        settings.max_depth = options.max_depth;
+        settings.use_path_tracer = true;
+        settings.use_light_sampling = true;
+        settings.background_texture = &black;
+
+        return settings;
+}
+
+/**
+        The box rt renders by default: coloured walls, a light panel in the
+        ceiling and whatever the scene puts inside.
+ */
+struct CornellBox {
+        Lambertian red_diffuse{ Vec3 (1, 0.44, 0.45) };
+        Lambertian green_diffuse{ Vec3 (0.42, 0.77, 0.09) };
+        Lambertian blue_diffuse{ Vec3 (0.01, 0.86, 0.91) };
+        Lambertian white_diffuse{ Vec3 (0.8, 0.8, 0.8) };
+        Lambertian light{ Vec3 (1, 1, 1) };
+
+        Quad left_wall{ Vec3 (-1, 0, 0), Vec3 (0, 0, -2), Vec3 (0, 2, 0), &red_diffuse };
+        Quad right_wall{ Vec3 (1, 2, 0), Vec3 (0, 0, -2), Vec3 (0, -2, 0), &green_diffuse };
+        Quad back_wall{ Vec3 (1, 0, -2), Vec3 (0, 2, 0), Vec3 (-2, 0, 0), &blue_diffuse };
+        Quad ceiling{ Vec3 (1, 2, 0), Vec3 (-2, 0, 0), Vec3 (0, 0, -2), &white_diffuse };
+        Quad floor{ Vec3 (1, 0, 0), Vec3 (0, 0, -2), Vec3 (-2, 0, 0), &white_diffuse };
+        Quad light_panel{ Vec3 (0.5, 1.98, -0.5), Vec3 (-0.5, 0, 0), Vec3 (0, 0, -0.5), &light };
+
+        CornellBox (World &world)
+        {
+                light.emission (Vec3 (5, 5, 5));
+                light_panel.one_sided () = true;
+
+                world.add (&left_wall);
+                world.add (&right_wall);
+                world.add (&back_wall);
+                world.add (&ceiling);
+                world.add (&floor);
+                world.add (&light_panel);
+        }
+};
+
+static json bench_cornell_glass (BenchOptions &options)
+{
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+        World world;
+        CornellBox box (world);
+        Dielectric glass (2.5, 0);
+        Sphere sphere (Vec3 (0, 0.65, -1), 0.5, &glass);
+
+        world.add (&sphere);
+
+        return run ("cornell_glass", options, world, settings_for (options), Vec3 (0, 1, 2), Vec3 (0, 1, -1),
+                    seconds_since (start), {});
+}
+
+static json bench_dragon (BenchOptions &options)
+{
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+        World world;
+        CornellBox box (world);
+        Mesh dragon ("assets/dragon.obj", Vec3 (0, 0.35, -1), 1.0 / 15, &box.white_diffuse);
+
+        world.add (&dragon);
+
+        return run ("dragon", options, world, settings_for (options), Vec3 (0, 1, 2), Vec3 (0, 1, -1),
+                    seconds_since (start), { &dragon });
+}
+
+static json bench_bunny (BenchOptions &options)
+{
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+        World world;
+        CornellBox box (world);
+        Metal metal (0.1, Vec3 (0.8, 0.8, 0.8));
+        Mesh bunny ("assets/stanford-bunny.obj", Vec3 (0, 0.39, -1), 5, &metal);
+
+        world.add (&bunny);
+
+        return run ("bunny", options, world, settings_for (options), Vec3 (0, 1, 2), Vec3 (0, 1, -1),
+                    seconds_since (start), { &bunny });
+}
+
+static json bench_spheres (BenchOptions &options)
+{
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+        World world;
+        CornellBox box (world);
+        Dielectric glass (1.5, 0);
+        Metal metal (0.05, Vec3 (0.9, 0.8, 0.6));
+        std::vector<Sphere *> spheres;
+
+        // a 32 x 32 grid on the floor, every material in turn
+        for (int i = 0; i < 32; i++)
+                for (int j = 0; j < 32; j++) {
+                        Material *material = (i + j) % 3 == 0   ? (Material *)&glass
+                                             : (i + j) % 3 == 1 ? (Material *)&metal
+                                                                : (Material *)&box.white_diffuse;
+
+                        spheres.push_back (new Sphere (Vec3 (-0.97 + i * 0.0625, 0.025, -0.03 - j * 0.0625), 0.025,
+                                                       material));
+                        world.add (spheres.back ());
+                }
+
+        json report = run ("spheres", options, world, settings_for (options), Vec3 (0, 1, 2), Vec3 (0, 0.5, -1),
+                           seconds_since (start), {});
+
+        for (Sphere *sphere : spheres)
+                delete sphere;
+
+        return report;
+}
+
+static json bench_environment (BenchOptions &options)
+{
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+        World world;
+        CheckerboardTexture checkers (Vec3 (0.1, 0.1, 0.1), Vec3 (0.9, 0.9, 0.9));
+        Lambertian ground_material (&checkers);
+        Lambertian diffuse (Vec3 (0.7, 0.3, 0.3));
+        Dielectric glass (1.5, 0);
+        Metal metal (0, Vec3 (0.8, 0.8, 0.8));
+
+        Quad ground (Vec3 (20, 0, 20), Vec3 (0, 0, -40), Vec3 (-40, 0, 0), &ground_material);
+        Sphere left (Vec3 (-1.1, 0.5, -1), 0.5, &diffuse);
+        Sphere middle (Vec3 (0, 0.5, -1), 0.5, &glass);
+        Sphere right (Vec3 (1.1, 0.5, -1), 0.5, &metal);
+
+        world.add (&ground);
+        world.add (&left);
+        world.add (&middle);
+        world.add (&right);
+
+        ImageTexture environment ("assets/pano2.jpg");
+        Camera::RendererSettings settings = settings_for (options);
+
+        settings.background_texture = &environment;
+
+        return run ("environment", options, world, settings, Vec3 (0, 1, 2), Vec3 (0, 0.5, -1), seconds_since (start),
+                    {});
+}
+
+int main (int argc, char **argv)
+{
+        BenchOptions options = { int (std::thread::hardware_concurrency ()), 320, 8, 8, 1, nullptr, nullptr };
+        const char *mesh_accel = "kdtree";
+
+        struct option longopts[] = {
+                { .name = "nthreads", .has_arg = 1, .val = 'n' },
+                { .name = "image_width", .has_arg = 1, .val = 'w' },
+                { .name = "samples_per_pixel", .has_arg = 1, .val = 's' },
+                { .name = "max_depth", .has_arg = 1, .val = 'd' },
+                { .name = "seed", .has_arg = 1, .val = 'S' },
+                { .name = "mesh_accel", .has_arg = 1, .val = 'B' },
+                { .name = "scene", .has_arg = 1, .val = 'c' },
+                { .name = "out_file", .has_arg = 1, .val = 'f' },
+                { .name = "help", .has_arg = 0, .val = 'h' },
+                { 0 }
+        };
+        int c, optidx;
+        while ((c = getopt_long (argc, argv, "", longopts, &optidx)) != -1) {
+                switch (c) {
+                case 'n': options.nthreads = strtol (optarg, NULL, 10); break;
+                case 'w': options.image_width = strtol (optarg, NULL, 10); break;
+                case 's': options.samples_per_pixel = strtol (optarg, NULL, 10); break;
+                case 'd': options.max_depth = strtol (optarg, NULL, 10); break;
+                case 'S': options.seed = strtoul (optarg, NULL, 10); break;
+                case 'B': {
+                        mesh_accel = optarg;
+
+                        if (!strcmp (optarg, "kdtree")) {
+                                Mesh::accelerator = Mesh::Accelerator::KDTree;
+                        } else if (!strcmp (optarg, "bvh4")) {
+                                Mesh::accelerator = Mesh::Accelerator::BVH4;
+                        } else if (!strcmp (optarg, "bvh8")) {
+                                Mesh::accelerator = Mesh::Accelerator::BVH8;
+                        } else {
+                                log_error ("Unknown mesh accelerator `%s`, must be one of kdtree, bvh4, bvh8", optarg);
+                                exit (EXIT_FAILURE);
+                        }
+                        break;
+                }
+                case 'c': options.scene = optarg; break;
+                case 'f': options.out_file = optarg; break;
+                case 'h': {
+                        fprintf (stderr, "%s", usage_text);
+                        exit (EXIT_SUCCESS);
+                }
+                default: {
+                        fprintf (stderr, "%s", usage_text);
+                        exit (EXIT_FAILURE);
+                }
+                }
+        }
+
+        if (options.nthreads < 1)
+                options.nthreads = 1;
+
+        // Lambertian reads use_importance_sampling from the global settings
+        config = settings_for (options);
+
+        std::vector<std::pair<const char *, std::function<json (BenchOptions &)>>> scenes = {
+                { "cornell_glass", bench_cornell_glass },
+                { "dragon", bench_dragon },
+                { "bunny", bench_bunny },
+                { "spheres", bench_spheres },
+                { "environment", bench_environment },
+        };
+
+        json report;
+
+        report["nthreads"] = options.nthreads;
+        report["image_width"] = options.image_width;
+        report["samples_per_pixel"] = options.samples_per_pixel;
+        report["max_depth"] = options.max_depth;
+        report["seed"] = options.seed;
+        report["mesh_accel"] = mesh_accel;
+        report["scenes"] = json::array ();
+
+        uint64_t max_rss = 0;
+
+        for (auto &[name, bench] : scenes)
+                if (!options.scene || !strcmp (options.scene, name)) {
+                        json scene = run_isolated (name, bench, options);
+
+                        max_rss = std::max (max_rss, scene["max_rss_bytes"].get<uint64_t> ());
+                        report["scenes"].push_back (scene);
+                }
+
+        if (report["scenes"].empty ()) {
+                log_error ("Unknown scene `%s`", options.scene);
+                exit (EXIT_FAILURE);
+        }
+
+        report["max_rss_bytes"] = max_rss;
+
+        if (!options.out_file) {
+                std::cout << report.dump (4) << std::endl;
+                return 0;
+        }
+
+        std::ofstream out (options.out_file);
+
+        if (!out) {
+                log_error ("Failed to write report to %s", options.out_file);
+                exit (EXIT_FAILURE);
+        }
+
+        out << report.dump (4) << std::endl;
+
+        return 0;
+}
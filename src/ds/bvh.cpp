@@ -0,0 +1,439 @@
+#include "bvh.hpp"
+#include "hitrecord.hpp"
+#include "object.hpp"
+#include "quad.hpp"
+#include "ray.hpp"
+#include "sphere.hpp"
+#include "stats.hpp"
+#include "vec3.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <vector>
+
+#define BVH_MAX_LEAF_SIZE 2
+#define BVH_MAX_DEPTH 64
+
+// spheres and quads per leaf, the lane count of the leaf tests: 4 doubles fill an AVX2 register
+#define BVH_LEAF_WIDTH 4
+
+static_assert (BVH_MAX_LEAF_SIZE <= 2 * BVH_LEAF_WIDTH, "BVH::_hit_leaf expects generic leaves to fit its lanes");
+
+BVH::BVH () : _built_area (0)
+{
+}
+
+/**
+        Objects without bounds (see Object::bounds) must not be passed in.
+ */
+BVH::BVH (std::vector<Object *> objects) : _built_area (0)
+{
+        std::vector<Entry> entries;
+
+        for (Object *obj : objects) {
+                Entry entry;
+
+                entry.object = obj;
+                obj->bounds (0, entry.min0, entry.max0);
+                obj->bounds (1, entry.min1, entry.max1);
+                entry.centroid = (entry.min0 + entry.max0 + entry.min1 + entry.max1) / 4;
+                entry.primitive = obj->primitive ();
+
+                entries.push_back (entry);
+        }
+
+        if (entries.empty ())
+                return;
+
+        this->nodes.reserve (2 * entries.size ());
+        this->_build (entries, 0, entries.size ());
+
+        bool has_spheres = false, has_quads = false;
+
+        for (Entry &entry : entries) {
+                this->objects.push_back (entry.object);
+                has_spheres |= entry.primitive == Object::Primitive::Sphere;
+                has_quads |= entry.primitive == Object::Primitive::Quad;
+        }
+
+        // padded so that a leaf's lanes never read past the end
+        size_t slots = this->objects.size () + BVH_LEAF_WIDTH;
+
+        Spheres &s = this->spheres;
+        Quads &q = this->quads;
+
+        if (has_spheres) {
+                for (std::vector<double> *column : { &s.x, &s.y, &s.z, &s.dx, &s.dy, &s.dz, &s.radius })
+                        column->resize (slots);
+
+                this->spheres.material.resize (slots);
+        }
+
+        if (has_quads) {
+                for (std::vector<double> *column :
+                     { &q.x, &q.y, &q.z, &q.nx, &q.ny, &q.nz, &q.ax, &q.ay, &q.az, &q.bx, &q.by, &q.bz, &q.one_sided })
+                        column->resize (slots);
+
+                this->quads.material.resize (slots);
+        }
+
+        for (size_t i = 0; i < this->objects.size (); i++)
+                this->_pack (i);
+
+        this->_built_area = this->_area ();
+}
+
+/**
+        Copies the geometry and material id of objects[index] into the sphere
+        or quad arrays.
+ */
+void BVH::_pack (size_t index)
+{
+        Object *obj = this->objects[index];
+        uint32_t material = obj->material ? obj->material->id : HIT_NO_MATERIAL;
+
+        switch (obj->primitive ()) {
+        case Object::Primitive::Sphere: {
+                Sphere *sphere = static_cast<Sphere *> (obj);
+                Vec3 motion = sphere->displacement.direction;
+
+                this->spheres.x[index] = sphere->location[0];
+                this->spheres.y[index] = sphere->location[1];
+                this->spheres.z[index] = sphere->location[2];
+                this->spheres.dx[index] = motion[0];
+                this->spheres.dy[index] = motion[1];
+                this->spheres.dz[index] = motion[2];
+                this->spheres.radius[index] = sphere->radius;
+                this->spheres.material[index] = material;
+                break;
+        }
+        case Object::Primitive::Quad: {
+                Quad *quad = static_cast<Quad *> (obj);
+                Vec3 normal = quad->normal (quad->location);
+                Vec3 a, b;
+
+                quad->alpha_beta_axes (a, b);
+
+                this->quads.x[index] = quad->location[0];
+                this->quads.y[index] = quad->location[1];
+                this->quads.z[index] = quad->location[2];
+                this->quads.nx[index] = normal[0];
+                this->quads.ny[index] = normal[1];
+                this->quads.nz[index] = normal[2];
+                this->quads.ax[index] = a[0];
+                this->quads.ay[index] = a[1];
+                this->quads.az[index] = a[2];
+                this->quads.bx[index] = b[0];
+                this->quads.by[index] = b[1];
+                this->quads.bz[index] = b[2];
+                this->quads.one_sided[index] = quad->one_sided ();
+                this->quads.material[index] = material;
+                break;
+        }
+        default: break;
+        }
+}
+
+static inline double surface_area (Vec3 min, Vec3 max)
+{
+        Vec3 d = max - min;
+
+        return 2 * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+}
+
+/**
+        Sum of the node surface areas, averaged over time 0 and time 1. This is
+        proportional to the expected traversal cost of a random ray.
+ */
+double BVH::_area ()
+{
+        double area = 0;
+
+        for (Node &node : this->nodes)
+                area += (surface_area (node.min0, node.max0) + surface_area (node.min1, node.max1)) / 2;
+
+        return area;
+}
+
+double BVH::refit ()
+{
+        // children are stored after their parent, so a reverse sweep visits them first
+        for (size_t i = this->nodes.size (); i-- > 0;) {
+                Node &node = this->nodes[i];
+
+                if (node.count > 0) {
+                        node.min0 = node.min1 = Vec3::inf ();
+                        node.max0 = node.max1 = -Vec3::inf ();
+
+                        for (int k = 0; k < node.count; k++) {
+                                Vec3 min, max;
+                                Object *obj = this->objects[node.offset + k];
+
+                                this->_pack (node.offset + k);
+
+                                obj->bounds (0, min, max);
+                                node.min0 = Vec3::min (node.min0, min);
+                                node.max0 = Vec3::max (node.max0, max);
+
+                                obj->bounds (1, min, max);
+                                node.min1 = Vec3::min (node.min1, min);
+                                node.max1 = Vec3::max (node.max1, max);
+                        }
+
+                        continue;
+                }
+
+                Node &left = this->nodes[i + 1], &right = this->nodes[node.offset];
+
+                node.min0 = Vec3::min (left.min0, right.min0);
+                node.max0 = Vec3::max (left.max0, right.max0);
+                node.min1 = Vec3::min (left.min1, right.min1);
+                node.max1 = Vec3::max (left.max1, right.max1);
+        }
+
+        if (this->_built_area <= 0)
+                return 1;
+
+        return this->_area () / this->_built_area;
+}
+
+/**
+        Splits at the median centroid along the axis in which the centroids
+        are spread the most, down to leaves of BVH_MAX_LEAF_SIZE objects, or
+        BVH_LEAF_WIDTH if they are all spheres and quads.
+ */
+size_t BVH::_build (std::vector<Entry> &entries, size_t begin, size_t end)
+{
+        size_t index = this->nodes.size ();
+        Node node;
+
+        node.min0 = node.min1 = Vec3::inf ();
+        node.max0 = node.max1 = -Vec3::inf ();
+
+        Vec3 centroid_min = Vec3::inf (), centroid_max = -Vec3::inf ();
+        bool packed = true;
+
+        for (size_t i = begin; i < end; i++) {
+                packed &= entries[i].primitive != Object::Primitive::Other;
+
+                node.min0 = Vec3::min (node.min0, entries[i].min0);
+                node.max0 = Vec3::max (node.max0, entries[i].max0);
+                node.min1 = Vec3::min (node.min1, entries[i].min1);
+                node.max1 = Vec3::max (node.max1, entries[i].max1);
+
+                centroid_min = Vec3::min (centroid_min, entries[i].centroid);
+                centroid_max = Vec3::max (centroid_max, entries[i].centroid);
+        }
+
+        node.spheres = node.quads = 0;
+        this->nodes.push_back (node);
+
+        if (end - begin <= BVH_MAX_LEAF_SIZE || (packed && end - begin <= BVH_LEAF_WIDTH)) {
+                // spheres first, then quads, then everything else
+                auto is = [] (Object::Primitive primitive) {
+                        return [primitive] (Entry &entry) { return entry.primitive == primitive; };
+                };
+
+                auto spheres_end = std::stable_partition (entries.begin () + begin, entries.begin () + end,
+                                                          is (Object::Primitive::Sphere));
+                auto quads_end = std::stable_partition (spheres_end, entries.begin () + end, is (Object::Primitive::Quad));
+
+                this->nodes[index].offset = begin;
+                this->nodes[index].count = end - begin;
+                this->nodes[index].spheres = spheres_end - (entries.begin () + begin);
+                this->nodes[index].quads = quads_end - spheres_end;
+                this->nodes[index].axis = 0;
+
+                return index;
+        }
+
+        Vec3 extent = centroid_max - centroid_min;
+        int axis = 0;
+
+        for (int i = 1; i < 3; i++)
+                if (extent[i] > extent[axis])
+                        axis = i;
+
+        size_t middle = begin + (end - begin) / 2;
+
+        std::nth_element (entries.begin () + begin, entries.begin () + middle, entries.begin () + end,
+                          [axis] (Entry &a, Entry &b) { return a.centroid[axis] < b.centroid[axis]; });
+
+        this->_build (entries, begin, middle);
+        size_t right = this->_build (entries, middle, end);
+
+        this->nodes[index].offset = right;
+        this->nodes[index].count = 0;
+        this->nodes[index].axis = axis;
+
+        return index;
+}
+
+static inline bool hit_node (BVH::Node &node, Ray &r, Vec3 &inverse_direction, double lambda_min, double lambda_max)
+{
+        double t = r.time;
+
+        for (int i = 0; i < 3; i++) {
+                double min = node.min0[i] + t * (node.min1[i] - node.min0[i]);
+                double max = node.max0[i] + t * (node.max1[i] - node.max0[i]);
+
+                double t0 = (min - r.origin[i]) * inverse_direction[i];
+                double t1 = (max - r.origin[i]) * inverse_direction[i];
+
+                if (inverse_direction[i] < 0)
+                        std::swap (t0, t1);
+
+                lambda_min = t0 > lambda_min ? t0 : lambda_min;
+                lambda_max = t1 < lambda_max ? t1 : lambda_max;
+
+                if (lambda_max < lambda_min)
+                        return false;
+        }
+
+        return true;
+}
+
+/**
+        lambdas of the ray's hits with the spheres in slots first ... first +
+        BVH_LEAF_WIDTH - 1, DBL_MAX for misses (see Sphere::intersect).
+ */
+static inline void intersect_spheres (BVH::Spheres &s, size_t first, Ray &r, double *lambdas)
+{
+        // Vec3::operator[] is not inlined, read the ray once outside the lanes
+        double px = r.origin[0], py = r.origin[1], pz = r.origin[2], time = r.time;
+        double dx = r.direction[0], dy = r.direction[1], dz = r.direction[2];
+
+        for (int k = 0; k < BVH_LEAF_WIDTH; k++) {
+                size_t i = first + k;
+
+                // ray origin relative to the center at the ray's time
+                double ox = px - s.dx[i] * time - s.x[i];
+                double oy = py - s.dy[i] * time - s.y[i];
+                double oz = pz - s.dz[i] * time - s.z[i];
+
+                double lambda;
+                bool hit = Sphere::intersect (ox, oy, oz, dx, dy, dz, s.radius[i], lambda);
+
+                lambdas[k] = hit ? lambda : DBL_MAX;
+        }
+}
+
+/**
+        lambdas of the ray's hits with the quads in slots first ... first +
+        BVH_LEAF_WIDTH - 1, see intersect_spheres and Quad::intersect.
+ */
+static inline void intersect_quads (BVH::Quads &q, size_t first, Ray &r, double *lambdas)
+{
+        double px = r.origin[0], py = r.origin[1], pz = r.origin[2];
+        double dx = r.direction[0], dy = r.direction[1], dz = r.direction[2];
+
+        for (int k = 0; k < BVH_LEAF_WIDTH; k++) {
+                size_t i = first + k;
+
+                double lambda;
+                bool hit = Quad::intersect (px - q.x[i], py - q.y[i], pz - q.z[i], dx, dy, dz, q.nx[i], q.ny[i],
+                                            q.nz[i], q.ax[i], q.ay[i], q.az[i], q.bx[i], q.by[i], q.bz[i],
+                                            q.one_sided[i] != 0, lambda);
+
+                lambdas[k] = hit ? lambda : DBL_MAX;
+        }
+}
+
+/**
+        The leaf's spheres and quads are intersected BVH_LEAF_WIDTH at a
+        time and only the closest of them fills in the record, any other
+        objects are intersected one by one.
+ */
+bool BVH::_hit_leaf (Node &node, Ray &r, HitRecord &record, double lambda_min, double &lambda_max)
+{
+        double lambdas[2 * BVH_LEAF_WIDTH];
+        int packed = node.spheres + node.quads, closest = -1;
+        bool hit_anything = false;
+
+        if (node.spheres > 0)
+                intersect_spheres (this->spheres, node.offset, r, lambdas);
+
+        if (node.quads > 0)
+                intersect_quads (this->quads, node.offset + node.spheres, r, lambdas + node.spheres);
+
+        for (int i = 0; i < packed; i++)
+                if (lambdas[i] < lambda_max && lambdas[i] > lambda_min) {
+                        lambda_max = lambdas[i];
+                        closest = i;
+                }
+
+        if (closest >= 0) {
+                HitRecord curr_record;
+                size_t index = node.offset + closest;
+
+                if (closest < node.spheres) {
+                        static_cast<Sphere *> (this->objects[index])->hit_record (r, lambda_max, curr_record);
+                        curr_record.material = this->spheres.material[index];
+                } else {
+                        static_cast<Quad *> (this->objects[index])->hit_record (r, lambda_max, curr_record);
+                        curr_record.material = this->quads.material[index];
+                }
+
+                record = curr_record;
+                record.root = this->objects[index];
+                hit_anything = true;
+        }
+
+        for (int i = packed; i < node.count; i++) {
+                HitRecord curr_record;
+
+                if (!this->objects[node.offset + i]->hit (r, curr_record))
+                        continue;
+
+                if (curr_record.lambda < lambda_max && curr_record.lambda > lambda_min) {
+                        lambda_max = curr_record.lambda;
+                        record = curr_record;
+                        record.root = this->objects[node.offset + i];
+                        hit_anything = true;
+                }
+        }
+
+        return hit_anything;
+}
+
+bool BVH::hit (Ray r, HitRecord &record, double lambda_min, double &lambda_max)
+{
+        if (this->nodes.empty ())
+                return false;
+
+        Vec3 inverse_direction (1 / r.direction[0], 1 / r.direction[1], 1 / r.direction[2]);
+
+        size_t stack[BVH_MAX_DEPTH];
+        int top = 0;
+        bool hit_anything = false;
+
+        stack[top++] = 0;
+
+        while (top > 0) {
+                Node &node = this->nodes[stack[--top]];
+
+                STATS_ADD (bvh_nodes, 1);
+
+                if (!hit_node (node, r, inverse_direction, lambda_min, lambda_max))
+                        continue;
+
+                if (node.count > 0) {
+                        STATS_ADD (bvh_leaf_objects, node.count);
+                        STATS_LEAF (node.count);
+
+                        hit_anything |= this->_hit_leaf (node, r, record, lambda_min, lambda_max);
+                        continue;
+                }
+
+                size_t left = &node - this->nodes.data () + 1, right = node.offset;
+
+                // visit the near child first so that the far one is more likely to be culled
+                if (r.direction[node.axis] < 0)
+                        std::swap (left, right);
+
+                stack[top++] = right;
+                stack[top++] = left;
+        }
+
+        return hit_anything;
+}
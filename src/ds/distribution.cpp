@@ -0,0 +1,112 @@
+#include "distribution.hpp"
+#include "vec3.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+        All-zero functions (e.g. a black image) fall back to a uniform
+        distribution so that sampling stays well defined.
+ */
+Distribution1D::Distribution1D (std::vector<double> func) : func (std::move (func))
+{
+        size_t n = this->func.size ();
+
+        this->cdf.resize (n + 1);
+        this->cdf[0] = 0;
+
+        for (size_t i = 0; i < n; i++)
+                this->cdf[i + 1] = this->cdf[i] + this->func[i] / n;
+
+        this->integral = this->cdf[n];
+
+        for (size_t i = 1; i <= n; i++)
+                this->cdf[i] = this->integral > 0 ? this->cdf[i] / this->integral : double (i) / n;
+}
+
+int Distribution1D::count ()
+{
+        return int (this->func.size ());
+}
+
+/**
+        Returns x in [0, 1) with density pdf, offset is the segment x lies in.
+ */
+double Distribution1D::sample (double u, double &pdf, int &offset)
+{
+        // last cdf entry <= u, skipping empty segments
+        offset = int (std::upper_bound (this->cdf.begin (), this->cdf.end (), u) - this->cdf.begin ()) - 1;
+        offset = std::clamp (offset, 0, this->count () - 1);
+
+        double width = this->cdf[offset + 1] - this->cdf[offset];
+        double du = width > 0 ? (u - this->cdf[offset]) / width : 0;
+
+        pdf = this->pdf ((offset + 0.5) / this->count ());
+
+        return std::min ((offset + du) / this->count (), 1 - 1e-12);
+}
+
+double Distribution1D::pdf (double x)
+{
+        int offset = std::clamp (int (x * this->count ()), 0, this->count () - 1);
+
+        if (!(this->integral > 0))
+                return 1;
+
+        return this->func[offset] / this->integral;
+}
+
+static std::vector<Distribution1D> rows (const std::vector<double> &func, int nu, int nv)
+{
+        std::vector<Distribution1D> rows;
+
+        rows.reserve (nv);
+
+        for (int v = 0; v < nv; v++)
+                rows.emplace_back (std::vector<double> (func.begin () + size_t (v) * nu,
+                                                        func.begin () + size_t (v + 1) * nu));
+
+        return rows;
+}
+
+static std::vector<double> row_integrals (std::vector<Distribution1D> &rows)
+{
+        std::vector<double> integrals;
+
+        for (Distribution1D &row : rows)
+                integrals.push_back (row.integral);
+
+        return integrals;
+}
+
+/**
+        func holds nv rows of nu values, row after row.
+ */
+Distribution2D::Distribution2D (const std::vector<double> &func, int nu, int nv)
+        : conditional (rows (func, nu, nv)), marginal (row_integrals (this->conditional))
+{
+}
+
+/**
+        Returns (u, v, 0) with density pdf over [0, 1)^2.
+ */
+Vec3 Distribution2D::sample (double u0, double u1, double &pdf)
+{
+        double pdf_v, pdf_u;
+        int row, column;
+
+        double v = this->marginal.sample (u1, pdf_v, row);
+        double u = this->conditional[row].sample (u0, pdf_u, column);
+
+        pdf = pdf_u * pdf_v;
+
+        return Vec3 (u, v, 0);
+}
+
+double Distribution2D::pdf (Vec3 uv)
+{
+        int row = std::clamp (int (uv[1] * this->marginal.count ()), 0, this->marginal.count () - 1);
+
+        return this->conditional[row].pdf (uv[0]) * this->marginal.pdf (uv[1]);
+}
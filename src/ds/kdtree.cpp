@@ -1,74 +1,48 @@
 #include "kdtree.hpp"
 #include "hitrecord.hpp"
 #include "ray.hpp"
+#include "stats.hpp"
 #include "triangle.hpp"
 #include "vec3.hpp"
 #include <algorithm>
 #include <cfloat>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <thread>
 #include <utility>
 #include <vector>
 
-KDTree::KDTree ()
-{
-}
+// nodes with fewer triangles than this are not worth a thread of their own
+#define KDTREE_PARALLEL_MIN_TRIANGLES 4096
 
-KDTree::~KDTree ()
+KDTree::KDTree () : stats{}, bounding_box_root (nullptr)
 {
 }
 
-KDTree::KDTree (std::vector<Triangle *> triangles)
+/**
+        Copies of a KDTree share their nodes, so the destructor does not free
+        them. Call release () on the last copy instead.
+ */
+KDTree::~KDTree ()
 {
-        std::vector<Vec3> points;
-
-        for (Triangle *p : triangles) {
-                std::vector<Vec3> vertices = p->verticies ();
-                points.insert (points.end (), vertices.begin (), vertices.end ());
-        }
-
-        this->bounding_box_root = this->_construct_bounding_box_tree (this->_compute_bounding_box (points), triangles);
 }
 
 KDTree::KDTree (const KDTree &kdtree)
 {
         this->bounding_box_root = kdtree.bounding_box_root;
+        this->stats = kdtree.stats;
 }
 
 KDTree &KDTree::operator= (const KDTree &other)
 {
         this->bounding_box_root = other.bounding_box_root;
+        this->stats = other.stats;
 
         return *this;
 }
 
-KDTree::BoundingBox KDTree::_compute_bounding_box (std::vector<Vec3> points)
-{
-        BoundingBox box (points[0], points[0]);
-
-        for (Vec3 &vertex : points)
-                for (int i = 0; i < 3; i++) {
-                        box.min.vec[i] = std::min (box.min[i], vertex[i]);
-                        box.max.vec[i] = std::max (box.max[i], vertex[i]);
-                }
-
-        return box;
-}
-
-Vec3 KDTree::_median_select (std::vector<Vec3> points, int axis)
-{
-        if (points.size () == 1)
-                return points[0];
-
-        int median = points.size () / 2;
-
-        std::nth_element (points.begin (), points.begin () + median, points.end (), [axis] (Vec3 a, Vec3 b) {
-                return a[axis] < b[axis];
-        });
-
-        return points[median];
-}
-
 std::pair<KDTree::BoundingBox, KDTree::BoundingBox> KDTree::BoundingBox::split (int axis, double value)
 {
         BoundingBox left = *this;
@@ -160,61 +134,232 @@ bool KDTree::BoundingBox::inside (Triangle *triangle)
         return true;
 }
 
-struct KDTree::BoundingBoxNode *KDTree::_construct_bounding_box_tree (BoundingBox box,
-                                                                      std::vector<Triangle *> triangles)
+/**
+        Read-only state shared by every thread of a build. Vertex coordinates
+        and per-triangle bounds are flattened once up front so that building a
+        node never has to call Triangle::verticies ().
+ */
+struct KDTreeBuilder {
+        const std::vector<Triangle *> &triangles;
+        // x y z of the 3 vertices of each triangle
+        std::vector<double> vertices;
+        // min x y z, max x y z of each triangle
+        std::vector<double> bounds;
+        // subtrees are forked onto new threads down to this depth
+        size_t fork_depth;
+};
+
+/**
+        Per-thread scratch memory. Triangle index lists of all nodes on the
+        current path are stacked in indices: a node appends the lists of its
+        two children and truncates them again once both subtrees are built.
+ */
+struct KDTreeScratch {
+        std::vector<uint32_t> indices;
+        std::vector<double> coordinates;
+        KDTree::BuildStats stats;
+};
+
+static inline bool box_contains (KDTree::BoundingBox &box, const double *bounds)
+{
+        for (int i = 0; i < 3; i++)
+                if (!(box.min[i] <= bounds[i] && bounds[3 + i] <= box.max[i]))
+                        return false;
+
+        return true;
+}
+
+static void merge_stats (KDTree::BuildStats &into, KDTree::BuildStats &from)
+{
+        into.nodes += from.nodes;
+        into.leaves += from.leaves;
+        into.triangle_references += from.triangle_references;
+        into.max_depth = std::max (into.max_depth, from.max_depth);
+}
+
+/**
+        Builds the subtree over the count triangle indices stored at
+        scratch.indices[offset]. The box is split at the median vertex along
+        its longest axis, triangles straddling the split go to both children.
+        Splitting stops once it no longer reduces the number of triangles on
+        either side.
+ */
+static struct KDTree::BoundingBoxNode *build_node (KDTreeBuilder &builder, KDTreeScratch &scratch, KDTree::BoundingBox box,
+                                                   size_t offset, size_t count, size_t depth)
 {
-        if (triangles.size () == 0)
+        if (count == 0)
                 return nullptr;
 
+        struct KDTree::BoundingBoxNode *node = new struct KDTree::BoundingBoxNode;
+
+        node->box = box;
+        node->left = nullptr;
+        node->right = nullptr;
+
+        scratch.stats.nodes++;
+        scratch.stats.max_depth = std::max (scratch.stats.max_depth, depth);
+
         int axis = box.longest_dim ();
+        size_t nleft = 0, nright = 0;
+        std::pair<KDTree::BoundingBox, KDTree::BoundingBox> boxes;
+
+        if (axis >= 0) {
+                if (scratch.coordinates.size () < 3 * count)
+                        scratch.coordinates.resize (3 * count);
+
+                double *coordinates = scratch.coordinates.data ();
+                uint32_t *indices = scratch.indices.data () + offset;
+
+                for (size_t i = 0; i < count; i++)
+                        for (int k = 0; k < 3; k++)
+                                coordinates[3 * i + k] = builder.vertices[9 * indices[i] + 3 * k + axis];
+
+                double *median = coordinates + 3 * count / 2;
+                std::nth_element (coordinates, median, coordinates + 3 * count);
+
+                boxes = box.split (axis, *median);
 
-        std::vector<Vec3> points;
+                for (size_t i = 0; i < count; i++) {
+                        const double *bounds = &builder.bounds[6 * indices[i]];
 
-        for (Triangle *p : triangles) {
-                std::vector<Vec3> vertices = p->verticies ();
-                points.insert (points.end (), vertices.begin (), vertices.end ());
+                        if (box_contains (boxes.first, bounds)) {
+                                nleft++;
+                        } else if (box_contains (boxes.second, bounds)) {
+                                nright++;
+                        } else {
+                                nleft++;
+                                nright++;
+                        }
+                }
+        }
+
+        if (axis < 0 || nleft == count || nright == count) {
+                node->triangles.reserve (count);
+
+                for (size_t i = 0; i < count; i++)
+                        node->triangles.push_back (builder.triangles[scratch.indices[offset + i]]);
+
+                scratch.stats.leaves++;
+                scratch.stats.triangle_references += count;
+
+                return node;
         }
 
-        Vec3 median_point = this->_median_select (points, axis);
+        size_t top = scratch.indices.size ();
+        size_t left_offset = top, right_offset = top + nleft;
+
+        scratch.indices.resize (top + nleft + nright);
 
-        std::pair<BoundingBox, BoundingBox> boxes = box.split (axis, median_point[axis]);
+        uint32_t *indices = scratch.indices.data ();
+        uint32_t *left = indices + left_offset, *right = indices + right_offset;
 
-        std::vector<Triangle *> left_triangles;
-        std::vector<Triangle *> right_triangles;
+        for (size_t i = 0; i < count; i++) {
+                uint32_t index = indices[offset + i];
+                const double *bounds = &builder.bounds[6 * index];
 
-        for (Triangle *p : triangles) {
-                if (boxes.first.inside (p)) {
-                        left_triangles.push_back (p);
-                } else if (boxes.second.inside (p)) {
-                        right_triangles.push_back (p);
+                if (box_contains (boxes.first, bounds)) {
+                        *left++ = index;
+                } else if (box_contains (boxes.second, bounds)) {
+                        *right++ = index;
                 } else {
-                        left_triangles.push_back (p);
-                        right_triangles.push_back (p);
+                        *left++ = index;
+                        *right++ = index;
                 }
         }
 
-        struct BoundingBoxNode *node = new struct BoundingBoxNode;
+        if (depth < builder.fork_depth && nleft >= KDTREE_PARALLEL_MIN_TRIANGLES) {
+                KDTreeScratch left_scratch{};
 
-        node->box = box;
-        node->triangles = triangles;
+                left_scratch.indices.reserve (4 * nleft);
+                left_scratch.indices.assign (indices + left_offset, indices + left_offset + nleft);
 
-        // continue splitting the bounding box until splitting does not reduce
-        // the number of triangles that overlap with the split boxes
-        if (left_triangles.size () < triangles.size () && right_triangles.size () < triangles.size ()) {
-                node->left = this->_construct_bounding_box_tree (boxes.first, left_triangles);
-                node->right = this->_construct_bounding_box_tree (boxes.second, right_triangles);
+                std::thread worker ([&] {
+                        node->left = build_node (builder, left_scratch, boxes.first, 0, nleft, depth + 1);
+                });
+
+                node->right = build_node (builder, scratch, boxes.second, right_offset, nright, depth + 1);
+
+                worker.join ();
+                merge_stats (scratch.stats, left_scratch.stats);
         } else {
-                node->left = NULL;
-                node->right = NULL;
+                node->left = build_node (builder, scratch, boxes.first, left_offset, nleft, depth + 1);
+                node->right = build_node (builder, scratch, boxes.second, right_offset, nright, depth + 1);
         }
 
+        scratch.indices.resize (top);
+
         return node;
 }
 
+KDTree::KDTree (std::vector<Triangle *> triangles) : KDTree (triangles, std::thread::hardware_concurrency ())
+{
+}
+
+KDTree::KDTree (std::vector<Triangle *> triangles, int nthreads) : stats{}, bounding_box_root (nullptr)
+{
+        if (triangles.empty ())
+                return;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+        KDTreeBuilder builder{ .triangles = triangles,
+                               .vertices = std::vector<double> (9 * triangles.size ()),
+                               .bounds = std::vector<double> (6 * triangles.size ()),
+                               .fork_depth = 0 };
+
+        double min[3] = { DBL_MAX, DBL_MAX, DBL_MAX }, max[3] = { -DBL_MAX, -DBL_MAX, -DBL_MAX };
+
+        for (size_t t = 0; t < triangles.size (); t++) {
+                std::vector<Vec3> vertices = triangles[t]->verticies ();
+                double *bounds = &builder.bounds[6 * t];
+
+                for (int i = 0; i < 3; i++) {
+                        bounds[i] = DBL_MAX;
+                        bounds[3 + i] = -DBL_MAX;
+                }
+
+                for (int k = 0; k < 3; k++)
+                        for (int i = 0; i < 3; i++) {
+                                double coordinate = vertices[k][i];
+
+                                builder.vertices[9 * t + 3 * k + i] = coordinate;
+                                bounds[i] = std::min (bounds[i], coordinate);
+                                bounds[3 + i] = std::max (bounds[3 + i], coordinate);
+                        }
+
+                for (int i = 0; i < 3; i++) {
+                        min[i] = std::min (min[i], bounds[i]);
+                        max[i] = std::max (max[i], bounds[3 + i]);
+                }
+        }
+
+        // one level of forking per doubling of the thread count
+        while (nthreads > 1 && (size_t (1) << builder.fork_depth) < size_t (nthreads))
+                builder.fork_depth++;
+
+        KDTreeScratch scratch{};
+
+        scratch.indices.reserve (4 * triangles.size ());
+        scratch.coordinates.resize (3 * triangles.size ());
+
+        for (size_t t = 0; t < triangles.size (); t++)
+                scratch.indices.push_back (uint32_t (t));
+
+        BoundingBox root (Vec3 (min[0], min[1], min[2]), Vec3 (max[0], max[1], max[2]));
+
+        this->bounding_box_root = build_node (builder, scratch, root, 0, triangles.size (), 0);
+
+        this->stats = scratch.stats;
+        this->stats.build_seconds =
+                std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
 bool KDTree::_compute_bounding_box_tree_ray_hit (struct BoundingBoxNode *root, Ray r, HitRecord &record)
 {
         double lambda_min, lambda_max;
 
+        STATS_ADD (mesh_nodes, 1);
+
         if (!root->box.hit (r, lambda_min, lambda_max))
                 return false;
 
@@ -227,6 +372,8 @@ bool KDTree::_compute_bounding_box_tree_ray_hit (struct BoundingBoxNode *root, R
 
                 double best_lambda = DBL_MAX;
 
+                STATS_LEAF (root->triangles.size ());
+
                 for (Triangle *p : root->triangles) {
                         HitRecord temp_record;
                         if (!p->hit (r, temp_record))
@@ -289,5 +436,51 @@ bool KDTree::_compute_bounding_box_tree_ray_hit (struct BoundingBoxNode *root, R
 
 bool KDTree::ray_hit (Ray r, HitRecord &record)
 {
+        if (!this->bounding_box_root)
+                return false;
+
         return this->_compute_bounding_box_tree_ray_hit (this->bounding_box_root, r, record);
 }
+
+KDTree::BoundingBox KDTree::bounds ()
+{
+        if (!this->bounding_box_root)
+                return BoundingBox (Vec3::inf (), -Vec3::inf ());
+
+        return this->bounding_box_root->box;
+}
+
+size_t KDTree::_memory_usage (struct BoundingBoxNode *root)
+{
+        if (!root)
+                return 0;
+
+        return sizeof (struct BoundingBoxNode) + root->triangles.capacity () * sizeof (Triangle *) +
+               this->_memory_usage (root->left) + this->_memory_usage (root->right);
+}
+
+/**
+        Approximate number of bytes held by the tree nodes (not including the
+        triangles themselves).
+ */
+size_t KDTree::memory_usage ()
+{
+        return this->_memory_usage (this->bounding_box_root);
+}
+
+void KDTree::_release (struct BoundingBoxNode *root)
+{
+        if (!root)
+                return;
+
+        this->_release (root->left);
+        this->_release (root->right);
+
+        delete root;
+}
+
+void KDTree::release ()
+{
+        this->_release (this->bounding_box_root);
+        this->bounding_box_root = nullptr;
+}
@@ -86,6 +86,30 @@ Mat3 Mat3::transpose ()
 #endif
 }
 
+double Mat3::determinant ()
+{
+#ifdef USE_ACCELERATE
+        return simd_determinant (this->mat);
+#else
+        return this->c1.dot (this->c2.cross (this->c3));
+#endif
+}
+
+/**
+        Inverse of the matrix. The rows of the inverse are the cross products
+        of pairs of columns, scaled by the reciprocal of the determinant.
+ */
+Mat3 Mat3::inverse ()
+{
+#ifdef USE_ACCELERATE
+        return Mat3 (simd_inverse (this->mat));
+#else
+        Mat3 cofactors (this->c2.cross (this->c3), this->c3.cross (this->c1), this->c1.cross (this->c2));
+
+        return cofactors.transpose () * (1.0 / this->determinant ());
+#endif
+}
+
 std::ostream &operator<< (std::ostream &out, Mat3 m)
 {
         m = m.transpose ();
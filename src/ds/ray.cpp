@@ -2,22 +2,33 @@
 #include "vec3.hpp"
 #include <cmath>
 
-Ray::Ray ()
+Ray::Ray () : has_differentials (false)
 {
 }
 
-Ray::Ray (Vec3 origin, Vec3 direction, double time) : origin (origin), direction (direction), time (time)
+Ray::Ray (Vec3 origin, Vec3 direction, double time)
+        : origin (origin), direction (direction), time (time), has_differentials (false)
 {
 }
 
-Ray::Ray (Vec3 origin, Vec3 direction) : origin (origin), direction (direction), time (0)
+Ray::Ray (Vec3 origin, Vec3 direction) : origin (origin), direction (direction), time (0), has_differentials (false)
 {
 }
 
-Ray::Ray (Vec3 origin, Vec3 direction, Vec3 color) : origin (origin), direction (direction), color (color)
+Ray::Ray (Vec3 origin, Vec3 direction, Vec3 color)
+        : origin (origin), direction (direction), time (0), color (color), has_differentials (false)
 {
 }
 
+RayPrecomputed::RayPrecomputed (Ray &r)
+{
+        for (int i = 0; i < 3; i++) {
+                this->origin[i] = r.origin[i];
+                this->inverse_direction[i] = 1 / r.direction[i];
+                this->sign[i] = this->inverse_direction[i] < 0;
+        }
+}
+
 Vec3 Ray::at (double t)
 {
         return this->origin + this->direction * t;
@@ -34,4 +45,44 @@ bool Ray::can_refract (Vec3 normal, double mu)
 void Ray::nudge_forward ()
 {
         this->origin += (1e-2) * direction.unit ();
+}
+
+/**
+        Shrinks (s < 1) or widens the offset rays around the main ray, e.g.
+        by 1 / sqrt(samples) when a pixel is covered by several samples.
+ */
+void Ray::scale_differentials (double s)
+{
+        if (!this->has_differentials)
+                return;
+
+        this->rx_origin = this->origin + (this->rx_origin - this->origin) * s;
+        this->ry_origin = this->origin + (this->ry_origin - this->origin) * s;
+        this->rx_direction = this->direction + (this->rx_direction - this->direction) * s;
+        this->ry_direction = this->direction + (this->ry_direction - this->direction) * s;
+}
+
+/**
+        Intersects the offset rays with the tangent plane through point and
+        returns how far from point they land. Returns false when the ray has
+        no differentials or an offset ray is parallel to the plane.
+ */
+bool Ray::footprint (Vec3 point, Vec3 normal, Vec3 &dpdx, Vec3 &dpdy)
+{
+        if (!this->has_differentials)
+                return false;
+
+        double nx = normal.dot (this->rx_direction);
+        double ny = normal.dot (this->ry_direction);
+
+        if (std::fabs (nx) < 1e-12 || std::fabs (ny) < 1e-12)
+                return false;
+
+        double tx = normal.dot (point - this->rx_origin) / nx;
+        double ty = normal.dot (point - this->ry_origin) / ny;
+
+        dpdx = this->rx_origin + this->rx_direction * tx - point;
+        dpdy = this->ry_origin + this->ry_direction * ty - point;
+
+        return true;
 }
\ No newline at end of file
@@ -346,6 +346,26 @@ Vec3 Vec3::inf ()
         return Vec3 (DBL_MAX, DBL_MAX, DBL_MAX);
 }
 
+// component-wise minimum
+Vec3 Vec3::min (Vec3 a, Vec3 b)
+{
+#ifdef USE_ACCELERATE
+        return Vec3 (simd_min (a.vec, b.vec));
+#else
+        return Vec3 (std::min (a.x, b.x), std::min (a.y, b.y), std::min (a.z, b.z));
+#endif
+}
+
+// component-wise maximum
+Vec3 Vec3::max (Vec3 a, Vec3 b)
+{
+#ifdef USE_ACCELERATE
+        return Vec3 (simd_max (a.vec, b.vec));
+#else
+        return Vec3 (std::max (a.x, b.x), std::max (a.y, b.y), std::max (a.z, b.z));
+#endif
+}
+
 // ------------------------- Indexing -------------------------
 
 #ifndef USE_ACCELERATE
@@ -0,0 +1,443 @@
+#include "wide_bvh.hpp"
+#include "hitrecord.hpp"
+#include "ray.hpp"
+#include "stats.hpp"
+#include "triangle.hpp"
+#include "vec3.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// triangles per leaf the binary build aims for, and its bins per split
+#define WIDE_BVH_MAX_LEAF_SIZE 4
+#define WIDE_BVH_BINS 16
+
+// the binary build stops splitting at this depth, which also bounds the traversal stack
+#define WIDE_BVH_MAX_DEPTH 64
+
+// widens the exit distance of the box tests so rounding never culls a triangle on a box face
+#define WIDE_BVH_SLACK (1 + 4 * DBL_EPSILON)
+
+/**
+        Node of the binary tree the wide tree is collapsed from. Leaves have
+        left == right == -1 and hold indices[first .. first + count).
+ */
+struct WideBVHBuildNode {
+        double min[3], max[3];
+        int left, right;
+        uint32_t first, count;
+};
+
+struct WideBVHBuilder {
+        // min x y z, max x y z of each triangle
+        std::vector<double> bounds;
+        std::vector<double> centroids;
+        std::vector<uint32_t> indices;
+        std::vector<WideBVHBuildNode> nodes;
+        size_t max_depth;
+};
+
+static inline double half_area (const double *min, const double *max)
+{
+        double dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+
+        return dx * dy + dy * dz + dz * dx;
+}
+
+static inline void grow (double *min, double *max, const double *bounds)
+{
+        for (int i = 0; i < 3; i++) {
+                min[i] = std::min (min[i], bounds[i]);
+                max[i] = std::max (max[i], bounds[3 + i]);
+        }
+}
+
+/**
+        Splits along the axis in which the centroids are spread the most, at
+        the bin boundary with the lowest surface area heuristic cost. Ranges
+        the heuristic cannot split (all centroids in one bin) are split at
+        the median centroid instead.
+ */
+static int build_binary (WideBVHBuilder &builder, uint32_t first, uint32_t count, size_t depth)
+{
+        int index = builder.nodes.size ();
+        WideBVHBuildNode node = { { DBL_MAX, DBL_MAX, DBL_MAX }, { -DBL_MAX, -DBL_MAX, -DBL_MAX }, -1, -1, first, count };
+
+        double centroid_min[3] = { DBL_MAX, DBL_MAX, DBL_MAX }, centroid_max[3] = { -DBL_MAX, -DBL_MAX, -DBL_MAX };
+
+        for (uint32_t i = first; i < first + count; i++) {
+                uint32_t t = builder.indices[i];
+
+                grow (node.min, node.max, &builder.bounds[6 * t]);
+
+                for (int k = 0; k < 3; k++) {
+                        centroid_min[k] = std::min (centroid_min[k], builder.centroids[3 * t + k]);
+                        centroid_max[k] = std::max (centroid_max[k], builder.centroids[3 * t + k]);
+                }
+        }
+
+        builder.nodes.push_back (node);
+        builder.max_depth = std::max (builder.max_depth, depth);
+
+        if (count <= 1 || depth >= WIDE_BVH_MAX_DEPTH)
+                return index;
+
+        int axis = 0;
+
+        for (int k = 1; k < 3; k++)
+                if (centroid_max[k] - centroid_min[k] > centroid_max[axis] - centroid_min[axis])
+                        axis = k;
+
+        double extent = centroid_max[axis] - centroid_min[axis];
+        uint32_t *begin = builder.indices.data () + first, *end = begin + count;
+        uint32_t *middle = nullptr;
+
+        if (extent > 0) {
+                struct Bin {
+                        double min[3], max[3];
+                        uint32_t count;
+                } bins[WIDE_BVH_BINS];
+
+                for (Bin &bin : bins)
+                        bin = { { DBL_MAX, DBL_MAX, DBL_MAX }, { -DBL_MAX, -DBL_MAX, -DBL_MAX }, 0 };
+
+                double scale = WIDE_BVH_BINS / extent;
+
+                auto bin_of = [&] (uint32_t t) {
+                        int b = int ((builder.centroids[3 * t + axis] - centroid_min[axis]) * scale);
+
+                        return std::min (b, WIDE_BVH_BINS - 1);
+                };
+
+                for (uint32_t *i = begin; i < end; i++) {
+                        Bin &bin = bins[bin_of (*i)];
+
+                        grow (bin.min, bin.max, &builder.bounds[6 * *i]);
+                        bin.count++;
+                }
+
+                // area * count of everything right of each bin boundary
+                double right_cost[WIDE_BVH_BINS];
+                double min[3] = { DBL_MAX, DBL_MAX, DBL_MAX }, max[3] = { -DBL_MAX, -DBL_MAX, -DBL_MAX };
+                uint32_t right_count = 0;
+
+                for (int b = WIDE_BVH_BINS - 1; b > 0; b--) {
+                        double bounds[6] = { bins[b].min[0], bins[b].min[1], bins[b].min[2],
+                                             bins[b].max[0], bins[b].max[1], bins[b].max[2] };
+
+                        grow (min, max, bounds);
+                        right_count += bins[b].count;
+                        right_cost[b] = right_count ? half_area (min, max) * right_count : 0;
+                }
+
+                int best_split = -1;
+                double best_cost = DBL_MAX;
+                uint32_t left_count = 0;
+
+                for (int i = 0; i < 3; i++) {
+                        min[i] = DBL_MAX;
+                        max[i] = -DBL_MAX;
+                }
+
+                for (int b = 1; b < WIDE_BVH_BINS; b++) {
+                        double bounds[6] = { bins[b - 1].min[0], bins[b - 1].min[1], bins[b - 1].min[2],
+                                             bins[b - 1].max[0], bins[b - 1].max[1], bins[b - 1].max[2] };
+
+                        grow (min, max, bounds);
+                        left_count += bins[b - 1].count;
+
+                        if (left_count == 0 || left_count == count)
+                                continue;
+
+                        double cost = half_area (min, max) * left_count + right_cost[b];
+
+                        if (cost < best_cost) {
+                                best_cost = cost;
+                                best_split = b;
+                        }
+                }
+
+                // a leaf costs one intersection per triangle, a split one traversal step plus its children
+                double leaf_cost = count, split_cost = 1 + best_cost / half_area (node.min, node.max);
+
+                if (count <= WIDE_BVH_MAX_LEAF_SIZE && (best_split < 0 || leaf_cost <= split_cost))
+                        return index;
+
+                if (best_split > 0)
+                        middle = std::partition (begin, end, [&] (uint32_t t) { return bin_of (t) < best_split; });
+        } else if (count <= WIDE_BVH_MAX_LEAF_SIZE) {
+                return index;
+        }
+
+        if (!middle || middle == begin || middle == end) {
+                middle = begin + count / 2;
+                std::nth_element (begin, middle, end, [&] (uint32_t a, uint32_t b) {
+                        return builder.centroids[3 * a + axis] < builder.centroids[3 * b + axis];
+                });
+        }
+
+        uint32_t nleft = middle - begin;
+
+        int left = build_binary (builder, first, nleft, depth + 1);
+        int right = build_binary (builder, first + nleft, count - nleft, depth + 1);
+
+        builder.nodes[index].left = left;
+        builder.nodes[index].right = right;
+
+        return index;
+}
+
+template <int N> WideBVH<N>::WideBVH () : stats{}
+{
+}
+
+template <int N> WideBVH<N>::WideBVH (std::vector<Triangle *> triangles) : stats{}
+{
+        if (triangles.empty ())
+                return;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+        WideBVHBuilder builder{};
+
+        builder.bounds.resize (6 * triangles.size ());
+        builder.centroids.resize (3 * triangles.size ());
+        builder.indices.resize (triangles.size ());
+
+        for (size_t t = 0; t < triangles.size (); t++) {
+                double *bounds = &builder.bounds[6 * t];
+
+                for (int i = 0; i < 3; i++) {
+                        bounds[i] = DBL_MAX;
+                        bounds[3 + i] = -DBL_MAX;
+                }
+
+                for (Vec3 v : triangles[t]->verticies ())
+                        for (int i = 0; i < 3; i++) {
+                                bounds[i] = std::min (bounds[i], v[i]);
+                                bounds[3 + i] = std::max (bounds[3 + i], v[i]);
+                        }
+
+                for (int i = 0; i < 3; i++)
+                        builder.centroids[3 * t + i] = (bounds[i] + bounds[3 + i]) / 2;
+
+                builder.indices[t] = uint32_t (t);
+        }
+
+        builder.nodes.reserve (2 * triangles.size ());
+        build_binary (builder, 0, triangles.size (), 0);
+
+        this->triangles.reserve (triangles.size ());
+
+        for (uint32_t t : builder.indices)
+                this->triangles.push_back (triangles[t]);
+
+        this->_collapse (builder, 0);
+
+        this->stats.nodes = this->nodes.size ();
+        this->stats.max_depth = builder.max_depth;
+        this->stats.build_seconds =
+                std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+/**
+        Turns the binary subtree at builder.nodes[binary] into a wide node
+        (and the wide nodes below it), returns its index. A binary leaf as
+        the root becomes a wide node with a single leaf child.
+ */
+template <int N> uint32_t WideBVH<N>::_collapse (WideBVHBuilder &builder, int binary)
+{
+        uint32_t index = this->nodes.size ();
+        this->nodes.emplace_back ();
+
+        auto is_leaf = [&] (int b) { return builder.nodes[b].left < 0; };
+
+        int children[N];
+        int size = 0;
+
+        if (is_leaf (binary)) {
+                children[size++] = binary;
+        } else {
+                children[size++] = builder.nodes[binary].left;
+                children[size++] = builder.nodes[binary].right;
+        }
+
+        while (size < N) {
+                int largest = -1;
+                double largest_area = -1;
+
+                for (int k = 0; k < size; k++) {
+                        WideBVHBuildNode &child = builder.nodes[children[k]];
+
+                        if (!is_leaf (children[k]) && half_area (child.min, child.max) > largest_area) {
+                                largest = k;
+                                largest_area = half_area (child.min, child.max);
+                        }
+                }
+
+                if (largest < 0)
+                        break;
+
+                int opened = children[largest];
+
+                children[largest] = builder.nodes[opened].left;
+                children[size++] = builder.nodes[opened].right;
+        }
+
+        Node node;
+
+        // unused lanes get an empty box and are masked out by size anyway
+        for (int k = 0; k < N; k++) {
+                node.min_x[k] = node.min_y[k] = node.min_z[k] = DBL_MAX;
+                node.max_x[k] = node.max_y[k] = node.max_z[k] = -DBL_MAX;
+                node.child[k] = 0;
+                node.count[k] = 0;
+        }
+
+        node.size = size;
+
+        for (int k = 0; k < size; k++) {
+                WideBVHBuildNode &child = builder.nodes[children[k]];
+
+                node.min_x[k] = child.min[0];
+                node.min_y[k] = child.min[1];
+                node.min_z[k] = child.min[2];
+                node.max_x[k] = child.max[0];
+                node.max_y[k] = child.max[1];
+                node.max_z[k] = child.max[2];
+
+                if (is_leaf (children[k])) {
+                        node.child[k] = child.first;
+                        node.count[k] = child.count;
+                        this->stats.leaves++;
+                } else {
+                        node.child[k] = this->_collapse (builder, children[k]);
+                }
+        }
+
+        this->nodes[index] = node;
+
+        return index;
+}
+
+/**
+        Slab test of all N children of node at once: lambda[k] is where the
+        ray enters child k, hit[k] whether it does so before lambda_max.
+ */
+template <int N>
+static inline void intersect_children (typename WideBVH<N>::Node &node, RayPrecomputed &ray, double lambda_max,
+                                       double *lambda, bool *hit)
+{
+        const double *near_x = ray.sign[0] ? node.max_x : node.min_x, *far_x = ray.sign[0] ? node.min_x : node.max_x;
+        const double *near_y = ray.sign[1] ? node.max_y : node.min_y, *far_y = ray.sign[1] ? node.min_y : node.max_y;
+        const double *near_z = ray.sign[2] ? node.max_z : node.min_z, *far_z = ray.sign[2] ? node.min_z : node.max_z;
+
+        for (int k = 0; k < N; k++) {
+                double tx0 = (near_x[k] - ray.origin[0]) * ray.inverse_direction[0];
+                double ty0 = (near_y[k] - ray.origin[1]) * ray.inverse_direction[1];
+                double tz0 = (near_z[k] - ray.origin[2]) * ray.inverse_direction[2];
+                double tx1 = (far_x[k] - ray.origin[0]) * ray.inverse_direction[0];
+                double ty1 = (far_y[k] - ray.origin[1]) * ray.inverse_direction[1];
+                double tz1 = (far_z[k] - ray.origin[2]) * ray.inverse_direction[2];
+
+                double enter = std::max (std::max (tx0, ty0), std::max (tz0, 0.0));
+                double exit = std::min (std::min (tx1, ty1), tz1) * WIDE_BVH_SLACK;
+
+                lambda[k] = enter;
+                hit[k] = enter <= std::min (exit, lambda_max) && k < node.size;
+        }
+}
+
+template <int N> bool WideBVH<N>::ray_hit (Ray r, HitRecord &record)
+{
+        if (this->nodes.empty ())
+                return false;
+
+        RayPrecomputed ray (r);
+
+        // a leaf is a node with count > 0
+        struct Entry {
+                uint32_t node;
+                uint32_t count;
+                double lambda;
+        };
+
+        Entry stack[N * WIDE_BVH_MAX_DEPTH];
+        int top = 0;
+
+        double best_lambda = DBL_MAX;
+        bool hit_anything = false;
+
+        stack[top++] = { 0, 0, 0 };
+
+        while (top > 0) {
+                Entry entry = stack[--top];
+
+                if (entry.lambda > best_lambda)
+                        continue;
+
+                if (entry.count > 0) {
+                        STATS_LEAF (entry.count);
+
+                        for (uint32_t t = entry.node; t < entry.node + entry.count; t++) {
+                                HitRecord temp_record;
+
+                                if (!this->triangles[t]->hit (r, temp_record))
+                                        continue;
+
+                                if (temp_record.lambda < best_lambda) {
+                                        record = temp_record;
+                                        best_lambda = temp_record.lambda;
+                                        hit_anything = true;
+                                }
+                        }
+
+                        continue;
+                }
+
+                STATS_ADD (mesh_nodes, 1);
+
+                Node &node = this->nodes[entry.node];
+                double lambda[N];
+                bool hit[N];
+
+                intersect_children<N> (node, ray, best_lambda, lambda, hit);
+
+                // pushed far to near, so that the nearest child is visited first
+                Entry children[N];
+                int nchildren = 0;
+
+                for (int k = 0; k < N; k++) {
+                        if (!hit[k])
+                                continue;
+
+                        Entry child = { node.child[k], node.count[k], lambda[k] };
+                        int i = nchildren++;
+
+                        for (; i > 0 && children[i - 1].lambda < child.lambda; i--)
+                                children[i] = children[i - 1];
+
+                        children[i] = child;
+                }
+
+                for (int i = 0; i < nchildren; i++)
+                        stack[top++] = children[i];
+        }
+
+        return hit_anything;
+}
+
+/**
+        Approximate number of bytes held by the tree (not including the
+        triangles themselves).
+ */
+template <int N> size_t WideBVH<N>::memory_usage ()
+{
+        return this->nodes.capacity () * sizeof (Node) + this->triangles.capacity () * sizeof (Triangle *);
+}
+
+template class WideBVH<4>;
+template class WideBVH<8>;
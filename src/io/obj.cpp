@@ -1,250 +1,303 @@
 #include "obj.hpp"
 #include "vec3.hpp"
-#include <cmath>
-#include <cstdio>
-#include <cstdlib>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <optional>
+#include <exception>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 #include <vector>
 
-ObjFile::ObjFile (const char *filename) : vertex_index (0), vertex_texture_index (0), parsed (false)
-{
-        this->obj_file = fopen (filename, "r");
+// chunks smaller than this are not worth a thread of their own
+#define OBJ_MIN_CHUNK_SIZE (256 * 1024)
 
-        if (!this->obj_file) {
-                std::perror ("fopen");
-                exit (EXIT_FAILURE);
-        }
-}
-
-ObjFile::~ObjFile ()
+ObjFile::ObjFile (const char *filename) : ObjFile (filename, std::thread::hardware_concurrency ())
 {
-        fclose (this->obj_file);
 }
 
-char ObjFile::advance_char ()
+ObjFile::ObjFile (const char *filename, int nthreads)
+        : parsed (false), nthreads (nthreads > 0 ? nthreads : 1), filename (filename), data (nullptr), size (0)
 {
-        char old = curr_char;
-        curr_char = fgetc (this->obj_file);
+        int fd = open (filename, O_RDONLY);
 
-        return old;
-}
+        if (fd < 0)
+                throw std::runtime_error (std::string ("could not open .obj file ") + filename + ": " +
+                                          strerror (errno));
 
-char ObjFile::peek_char ()
-{
-        return this->curr_char;
-}
+        struct stat st;
 
-bool ObjFile::match_char (char c)
-{
-        if (this->peek_char () == c) {
-                this->advance_char ();
-                return true;
+        if (fstat (fd, &st) < 0) {
+                close (fd);
+                throw std::runtime_error (std::string ("could not stat .obj file ") + filename + ": " +
+                                          strerror (errno));
         }
 
-        return false;
-}
+        this->size = st.st_size;
 
-struct ObjFile::Token ObjFile::parse_numeric ()
-{
-        double value = 0;
-        bool is_negative = false;
-        if (this->match_char ('-'))
-                is_negative = true;
-
-        while ('0' <= this->peek_char () && this->peek_char () <= '9') {
-                value *= 10;
-
-                value += this->peek_char () - '0';
-
-                this->advance_char ();
-        }
+        if (this->size > 0) {
+                void *mapping = mmap (NULL, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
 
-        if (!this->match_char ('.'))
-                return (struct ObjFile::Token){ .type = INTEGER, .d = int (value) };
-
-        int place = 1;
-        while ('0' <= this->peek_char () && this->peek_char () <= '9') {
-                value += (this->peek_char () - '0') / std::pow (10.0, place++);
+                if (mapping == MAP_FAILED) {
+                        close (fd);
+                        throw std::runtime_error (std::string ("could not mmap .obj file ") + filename + ": " +
+                                                  strerror (errno));
+                }
 
-                this->advance_char ();
+                madvise (mapping, this->size, MADV_SEQUENTIAL);
+                this->data = (const char *)mapping;
         }
 
-        return (struct ObjFile::Token){ .type = FLOAT, .f = is_negative ? -value : value };
+        close (fd);
 }
 
-struct ObjFile::Token ObjFile::parse_keyword (char *keyword)
+ObjFile::~ObjFile ()
 {
-        enum TokenType type;
-        if (strcmp (keyword, "vt") == 0) {
-                type = VERTEX_TEXTURE;
-        } else if (strcmp (keyword, "vn") == 0) {
-                type = VERTEX_NORMAL;
-        } else if (strcmp (keyword, "v") == 0) {
-                type = VERTEX;
-        } else if (strcmp (keyword, "f") == 0) {
-                type = FACE;
-        } else {
-                type = IDENT;
-        }
-
-        return (struct ObjFile::Token){ .type = type };
+        if (this->data)
+                munmap ((void *)this->data, this->size);
 }
 
-struct ObjFile::Token ObjFile::parse_token ()
+size_t ObjFile::triangle_count ()
 {
-        while (this->peek_char () != EOF) {
-                switch (this->peek_char ()) {
-                case ' ':
-                case '\n':
-                case '\r':
-                case '\t': this->advance_char (); continue;
-                case '-': return this->parse_numeric ();
-                case '#': {
-                        while (this->peek_char () != '\n')
-                                this->advance_char ();
-                        continue;
-                }
-                case '/': {
-                        this->advance_char ();
+        return this->indices.size () / 3;
+}
 
-                        return (struct Token){ .type = SLASH };
-                }
+static inline bool is_blank (char c)
+{
+        return c == ' ' || c == '\t' || c == '\r';
+}
 
-                default:
+static inline const char *skip_blanks (const char *p, const char *end)
+{
+        while (p < end && is_blank (*p))
+                p++;
 
-                        if ('0' <= this->peek_char () && this->peek_char () <= '9')
-                                return this->parse_numeric ();
+        return p;
+}
 
-                        char ident[80];
-                        char *p = ident;
+static const char *parse_double (const char *p, const char *end, double &value)
+{
+        p = skip_blanks (p, end);
 
-                        while ('a' <= this->peek_char () && this->peek_char () <= 'z') {
-                                *p = this->peek_char ();
-                                p++;
-                                this->advance_char ();
-                        }
+        // std::from_chars does not accept an explicit plus sign
+        if (p < end && *p == '+')
+                p++;
 
-                        *p = '\0';
+        std::from_chars_result result = std::from_chars (p, end, value);
 
-                        return this->parse_keyword (ident);
-                }
-        }
+        if (result.ec != std::errc ())
+                throw std::logic_error ("error parsing .obj file: expected a number");
 
-        return (struct ObjFile::Token){ .type = END };
-}
-struct ObjFile::Token ObjFile::peek_token ()
-{
-        return this->token;
+        return result.ptr;
 }
-struct ObjFile::Token ObjFile::advance_token ()
+
+static const char *parse_integer (const char *p, const char *end, int64_t &value)
 {
-        struct Token old = this->token;
+        std::from_chars_result result = std::from_chars (p, end, value);
 
-        this->token = this->parse_token ();
+        if (result.ec != std::errc ())
+                throw std::logic_error ("error parsing .obj file: expected a face index");
 
-        return old;
+        return result.ptr;
 }
 
-bool ObjFile::match_token (enum ObjFile::TokenType type)
+/**
+        Split the mapped file into (at most) nthreads chunks, each ending just
+        after a newline so that no statement straddles two chunks.
+ */
+std::vector<ObjFile::Chunk> ObjFile::_split_chunks ()
 {
-        if (this->peek_token ().type == type) {
-                this->advance_token ();
-                return true;
-        }
+        size_t nchunks = std::max (size_t (1), std::min (size_t (this->nthreads), this->size / OBJ_MIN_CHUNK_SIZE));
 
-        return false;
-}
+        std::vector<Chunk> chunks (nchunks);
 
-struct ObjFile::Token ObjFile::consume_token (enum ObjFile::TokenType type, const char *error)
-{
-        if (this->peek_token ().type != type) {
-                throw std::logic_error (error);
-        }
+        const char *begin = this->data;
+        const char *file_end = this->data + this->size;
 
-        return this->advance_token ();
-}
+        for (size_t i = 0; i < nchunks; i++) {
+                const char *end = (i == nchunks - 1) ? file_end : this->data + (i + 1) * this->size / nchunks;
 
-Vec3 ObjFile::parse_vertex ()
-{
-        this->consume_token (ObjFile::VERTEX, "expected vertex declaration 'v'");
+                if (end < begin)
+                        end = begin;
 
-        struct ObjFile::Token x = this->consume_token (FLOAT, "expected x-coordinate for vertex");
+                const char *newline = (const char *)memchr (end, '\n', file_end - end);
+                end = newline ? newline + 1 : file_end;
 
-        struct ObjFile::Token y = this->consume_token (FLOAT, "expected y-coordinate for vertex");
+                chunks[i].begin = begin;
+                chunks[i].end = end;
 
-        struct ObjFile::Token z = this->consume_token (FLOAT, "expected z-coordinate for vertex");
+                begin = end;
+        }
 
-        return Vec3 (x.f, y.f, z.f);
+        return chunks;
 }
 
-Vec3 ObjFile::parse_vertex_normal ()
+void ObjFile::_parse_chunk (Chunk &chunk)
 {
-        this->consume_token (ObjFile::VERTEX_NORMAL, "expected vertex normal 'vn'");
-
-        struct ObjFile::Token x = this->consume_token (FLOAT, "expected x-coordinate for vertex");
-
-        struct ObjFile::Token y = this->consume_token (FLOAT, "expected y-coordinate for vertex");
+        /**
+                Absolute (1-based) indices become 0-based, relative (negative)
+                indices are made relative to the start of this chunk.
+         */
+        auto encode = [] (int64_t raw, size_t local_count) -> int64_t {
+                if (raw > 0)
+                        return raw - 1;
+
+                if (raw < 0)
+                        return RELATIVE + int64_t (local_count) + raw;
+
+                throw std::logic_error ("error parsing .obj file: face index 0 is invalid");
+        };
+
+        const char *p = chunk.begin;
+
+        while (p < chunk.end) {
+                const char *line_end = (const char *)memchr (p, '\n', chunk.end - p);
+
+                if (!line_end)
+                        line_end = chunk.end;
+
+                p = skip_blanks (p, line_end);
+
+                if (line_end - p >= 2 && p[0] == 'v' && is_blank (p[1])) {
+                        double x, y, z;
+                        p = parse_double (p + 1, line_end, x);
+                        p = parse_double (p, line_end, y);
+                        p = parse_double (p, line_end, z);
+                        chunk.vertices.emplace_back (x, y, z);
+                } else if (line_end - p >= 3 && p[0] == 'v' && p[1] == 'n' && is_blank (p[2])) {
+                        double x, y, z;
+                        p = parse_double (p + 2, line_end, x);
+                        p = parse_double (p, line_end, y);
+                        p = parse_double (p, line_end, z);
+                        chunk.normals.emplace_back (x, y, z);
+                } else if (line_end - p >= 3 && p[0] == 'v' && p[1] == 't' && is_blank (p[2])) {
+                        double u, v = 0;
+                        p = parse_double (p + 2, line_end, u);
+
+                        if (skip_blanks (p, line_end) < line_end)
+                                p = parse_double (p, line_end, v);
+
+                        chunk.texcoords.emplace_back (u, v, 0);
+                } else if (line_end - p >= 2 && p[0] == 'f' && is_blank (p[1])) {
+                        RawIndex first, previous;
+                        int corners = 0;
+
+                        p++;
+
+                        while ((p = skip_blanks (p, line_end)) < line_end) {
+                                RawIndex index = { MISSING, MISSING, MISSING };
+                                int64_t raw;
+
+                                p = parse_integer (p, line_end, raw);
+                                index.vertex = encode (raw, chunk.vertices.size ());
+
+                                if (p < line_end && *p == '/') {
+                                        p++;
+
+                                        if (p < line_end && *p != '/' && !is_blank (*p)) {
+                                                p = parse_integer (p, line_end, raw);
+                                                index.texture = encode (raw, chunk.texcoords.size ());
+                                        }
+
+                                        if (p < line_end && *p == '/') {
+                                                p++;
+                                                p = parse_integer (p, line_end, raw);
+                                                index.normal = encode (raw, chunk.normals.size ());
+                                        }
+                                }
+
+                                if (corners == 0) {
+                                        first = index;
+                                } else if (corners >= 2) {
+                                        chunk.indices.push_back (first);
+                                        chunk.indices.push_back (previous);
+                                        chunk.indices.push_back (index);
+                                }
+
+                                previous = index;
+                                corners++;
+                        }
 
-        struct ObjFile::Token z = this->consume_token (FLOAT, "expected z-coordinate for vertex");
+                        if (corners < 3)
+                                throw std::logic_error ("error parsing .obj file: face with fewer than 3 vertices");
+                }
 
-        return Vec3 (x.f, y.f, z.f);
+                p = line_end + 1;
+        }
 }
 
-Vec3 ObjFile::parse_uv ()
+int ObjFile::_resolve (int64_t raw, size_t chunk_offset, size_t count)
 {
-        this->consume_token (ObjFile::VERTEX_TEXTURE, "expected vertex normal 'vt'");
+        if (raw == MISSING)
+                return -1;
 
-        struct ObjFile::Token x = this->consume_token (FLOAT, "expected u-coordinate for vertex texture coordinate");
+        int64_t index = raw >= RELATIVE / 2 ? raw - RELATIVE + int64_t (chunk_offset) : raw;
 
-        struct ObjFile::Token y = this->consume_token (FLOAT, "expected v-coordinate for vertex texture coordinate");
+        if (index < 0 || index >= int64_t (count))
+                throw std::logic_error ("error parsing .obj file: face index out of range");
 
-        return Vec3 (x.f, y.f, 0);
+        return int (index);
 }
 
-ObjFile::FaceTriple ObjFile::parse_face_indicies ()
+void ObjFile::_stitch_chunk (Chunk &chunk, size_t index_offset)
 {
-        FaceTriple triple = { std::nullopt, std::nullopt, std::nullopt };
-
-        struct ObjFile::Token vertex_index = this->consume_token (ObjFile::INTEGER, "expected vertex index");
-        std::get<0> (triple) = vertex_index.d;
-
-        if (!this->match_token (SLASH))
-                return triple;
-
-        struct ObjFile::Token current_token = this->peek_token ();
-        if (this->match_token (ObjFile::INTEGER)) {
-                std::get<1> (triple) = current_token.d;
+        std::copy (chunk.vertices.begin (), chunk.vertices.end (), this->vertices.begin () + chunk.vertex_offset);
+        std::copy (chunk.texcoords.begin (), chunk.texcoords.end (), this->texcoords.begin () + chunk.texcoord_offset);
+        std::copy (chunk.normals.begin (), chunk.normals.end (), this->normals.begin () + chunk.normal_offset);
+
+        for (size_t i = 0; i < chunk.indices.size (); i++) {
+                RawIndex &raw = chunk.indices[i];
+
+                this->indices[index_offset + i] = Index{
+                        .vertex = this->_resolve (raw.vertex, chunk.vertex_offset, this->vertices.size ()),
+                        .texture = this->_resolve (raw.texture, chunk.texcoord_offset, this->texcoords.size ()),
+                        .normal = this->_resolve (raw.normal, chunk.normal_offset, this->normals.size ()),
+                };
         }
 
-        if (!this->match_token (SLASH)) {
-                return triple;
-        }
-
-        current_token = this->peek_token ();
-        if (this->match_token (ObjFile::INTEGER)) {
-                std::get<2> (triple) = current_token.d;
-        }
-
-        return triple;
+        // release the chunk's memory as soon as it has been copied
+        chunk.vertices = std::vector<Vec3> ();
+        chunk.texcoords = std::vector<Vec3> ();
+        chunk.normals = std::vector<Vec3> ();
+        chunk.indices = std::vector<RawIndex> ();
 }
 
-ObjFile::Face ObjFile::parse_face ()
+/**
+        Runs work(i) for every chunk, on its own thread when there is more than
+        one chunk. The first exception thrown by any chunk is rethrown.
+ */
+template <typename F> static void for_each_chunk (size_t nchunks, F work)
 {
-        this->consume_token (ObjFile::FACE, "expected face 'f'");
+        if (nchunks == 1) {
+                work (0);
+                return;
+        }
 
-        Face face;
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors (nchunks);
 
-        while (this->peek_token ().type == INTEGER) {
-                FaceTriple triple = this->parse_face_indicies ();
-                face.emplace_back (triple);
-        }
+        for (size_t i = 0; i < nchunks; i++)
+                threads.push_back (std::thread ([&, i] {
+                        try {
+                                work (i);
+                        } catch (...) {
+                                errors[i] = std::current_exception ();
+                        }
+                }));
 
-        return face;
-}
+        for (std::thread &t : threads)
+                t.join ();
 
-std::vector<ObjFile::Face> ObjFile::fan_triangulate_face (Face &face)
-{
+        for (std::exception_ptr &error : errors)
+                if (error)
+                        std::rethrow_exception (error);
 }
 
 void ObjFile::parse ()
@@ -252,36 +305,36 @@ void ObjFile::parse ()
         if (this->parsed)
                 return;
 
-        this->advance_char ();
-        this->advance_token ();
-        size_t vertex_index = 0;
-        size_t normal_index = 0;
-        while (!this->match_token (END)) {
-                struct Token command = this->peek_token ();
-
-                switch (command.type) {
-                case VERTEX: {
-                        Vec3 vertex = this->parse_vertex ();
-                        this->vertex_map[vertex_index++] = vertex;
-                        break;
-                }
-                case VERTEX_TEXTURE: {
-                        Vec3 texture = this->parse_uv ();
-                        this->texture_map[vertex_texture_index++] = texture;
-                        break;
-                }
-                case VERTEX_NORMAL: {
-                        Vec3 normal = this->parse_vertex_normal ();
-                        this->normal_map[normal_index++] = normal;
-                        break;
-                }
-                case FACE: {
-                        faces.emplace_back (this->parse_face ());
-                        break;
-                }
-                default: throw std::logic_error ("error parsing .obj file: unknown command");
-                }
+        if (this->size == 0) {
+                this->parsed = true;
+                return;
         }
 
+        std::vector<Chunk> chunks = this->_split_chunks ();
+
+        for_each_chunk (chunks.size (), [&] (size_t i) { this->_parse_chunk (chunks[i]); });
+
+        size_t nvertices = 0, ntexcoords = 0, nnormals = 0, nindices = 0;
+        std::vector<size_t> index_offsets;
+
+        for (Chunk &chunk : chunks) {
+                chunk.vertex_offset = nvertices;
+                chunk.texcoord_offset = ntexcoords;
+                chunk.normal_offset = nnormals;
+                index_offsets.push_back (nindices);
+
+                nvertices += chunk.vertices.size ();
+                ntexcoords += chunk.texcoords.size ();
+                nnormals += chunk.normals.size ();
+                nindices += chunk.indices.size ();
+        }
+
+        this->vertices.resize (nvertices);
+        this->texcoords.resize (ntexcoords);
+        this->normals.resize (nnormals);
+        this->indices.resize (nindices);
+
+        for_each_chunk (chunks.size (), [&] (size_t i) { this->_stitch_chunk (chunks[i], index_offsets[i]); });
+
         this->parsed = true;
-}
\ No newline at end of file
+}
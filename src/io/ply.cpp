@@ -0,0 +1,161 @@
+#include "ply.hpp"
+#include "lib/rply.h"
+#include "utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+PlyFile::PlyFile (const char *filename)
+        : parsed (false), has_normals (false), filename (filename), face_first (0), face_previous (0)
+{
+        this->ply = ply_open (filename, PlyFile::error_cb, 0, NULL);
+
+        if (!this->ply)
+                throw std::runtime_error (std::string ("could not open .ply file ") + filename);
+
+        if (!ply_read_header (this->ply)) {
+                ply_close (this->ply);
+                throw std::runtime_error (std::string ("could not read .ply header of ") + filename);
+        }
+}
+
+PlyFile::~PlyFile ()
+{
+        if (this->ply)
+                ply_close (this->ply);
+}
+
+void PlyFile::error_cb (p_ply, const char *message)
+{
+        log_error ("rply: %s", message);
+}
+
+size_t PlyFile::vertex_count ()
+{
+        return this->vertices.size () / 3;
+}
+
+size_t PlyFile::triangle_count ()
+{
+        return this->indices.size () / 3;
+}
+
+/**
+        idata holds the axis (0, 1, 2) of the property the callback was
+        registered for.
+ */
+int PlyFile::vertex_cb (p_ply_argument argument)
+{
+        void *pdata;
+        long axis, instance;
+
+        ply_get_argument_user_data (argument, &pdata, &axis);
+        ply_get_argument_element (argument, NULL, &instance);
+
+        PlyFile *file = (PlyFile *)pdata;
+        file->vertices[3 * instance + axis] = ply_get_argument_value (argument);
+
+        return 1;
+}
+
+int PlyFile::normal_cb (p_ply_argument argument)
+{
+        void *pdata;
+        long axis, instance;
+
+        ply_get_argument_user_data (argument, &pdata, &axis);
+        ply_get_argument_element (argument, NULL, &instance);
+
+        PlyFile *file = (PlyFile *)pdata;
+        file->normals[3 * instance + axis] = ply_get_argument_value (argument);
+
+        return 1;
+}
+
+/**
+        Called once with the list length (value_index == -1) and then once per
+        vertex index of the face. Faces are fan triangulated on the fly:
+        (v0, v1, v2), (v0, v2, v3), ...
+ */
+int PlyFile::face_cb (p_ply_argument argument)
+{
+        void *pdata;
+        long length, value_index;
+
+        ply_get_argument_user_data (argument, &pdata, NULL);
+        ply_get_argument_property (argument, NULL, &length, &value_index);
+
+        PlyFile *file = (PlyFile *)pdata;
+
+        if (value_index < 0)
+                return 1;
+
+        double value = ply_get_argument_value (argument);
+        // negative indices are caught with the out of range ones once the file is read
+        size_t index = value < 0 ? SIZE_MAX : size_t (value);
+
+        switch (value_index) {
+        case 0: file->face_first = index; break;
+        case 1: file->face_previous = index; break;
+        default:
+                file->indices.push_back (file->face_first);
+                file->indices.push_back (file->face_previous);
+                file->indices.push_back (index);
+                file->face_previous = index;
+                break;
+        }
+
+        return 1;
+}
+
+void PlyFile::parse ()
+{
+        if (this->parsed)
+                return;
+
+        const char *axes[] = { "x", "y", "z" };
+        const char *normal_axes[] = { "nx", "ny", "nz" };
+
+        long nvertices = 0;
+
+        for (long axis = 0; axis < 3; axis++)
+                nvertices = ply_set_read_cb (this->ply, "vertex", axes[axis], PlyFile::vertex_cb, this, axis);
+
+        if (nvertices == 0)
+                throw std::runtime_error (std::string ("no vertex positions in .ply file ") + this->filename);
+
+        this->vertices.resize (3 * nvertices);
+
+        long nnormals = 0;
+
+        for (long axis = 0; axis < 3; axis++)
+                nnormals = ply_set_read_cb (this->ply, "vertex", normal_axes[axis], PlyFile::normal_cb, this, axis);
+
+        if (nnormals > 0) {
+                this->has_normals = true;
+                this->normals.resize (3 * nnormals);
+        }
+
+        long nfaces = ply_set_read_cb (this->ply, "face", "vertex_indices", PlyFile::face_cb, this, 0);
+
+        if (nfaces == 0)
+                nfaces = ply_set_read_cb (this->ply, "face", "vertex_index", PlyFile::face_cb, this, 0);
+
+        if (nfaces == 0)
+                throw std::runtime_error (std::string ("no faces with vertex_indices or vertex_index in .ply file ") +
+                                          this->filename);
+
+        // most scanned meshes are already triangulated
+        this->indices.reserve (3 * nfaces);
+
+        if (!ply_read (this->ply))
+                throw std::runtime_error (std::string ("error reading .ply file ") + this->filename);
+
+        for (size_t index : this->indices)
+                if (index >= this->vertex_count ())
+                        throw std::runtime_error (std::string ("face vertex index out of range in ") + this->filename);
+
+        this->parsed = true;
+}
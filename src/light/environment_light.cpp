@@ -0,0 +1,87 @@
+#include "environment_light.hpp"
+#include "distribution.hpp"
+#include "texture.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+static std::vector<double> tabulate (Texture *texture, int width, int height)
+{
+        std::vector<double> func (size_t (width) * height);
+
+        for (int v = 0; v < height; v++) {
+                double sin_phi = std::sin (M_PI * (v + 0.5) / height);
+
+                for (int u = 0; u < width; u++) {
+                        Vec3 uv ((u + 0.5) / width, (v + 0.5) / height, 0);
+
+                        // filtered over the cell, so that small bright spots are not missed
+                        Vec3 color = texture->lookup (uv, uv, 1.0 / width);
+
+                        func[size_t (v) * width + u] =
+                                (0.2126 * color[0] + 0.7152 * color[1] + 0.0722 * color[2]) * sin_phi;
+                }
+        }
+
+        return func;
+}
+
+EnvironmentLight::EnvironmentLight (Texture *texture, int width, int height)
+        : texture (texture), distribution (tabulate (texture, width, height), width, height)
+{
+        log_info ("Environment light: %d x %d sampling distribution", width, height);
+}
+
+/**
+        Inverse of to_direction (), same mapping as Vec3::sph (): u is the
+        angle around +y starting at +x, v the angle down from +y.
+ */
+Vec3 EnvironmentLight::to_uv (Vec3 direction)
+{
+        Vec3 sph = direction.unit ().sph ();
+
+        return Vec3 (sph[1] / (2 * M_PI), sph[2] / M_PI, 0);
+}
+
+Vec3 EnvironmentLight::to_direction (Vec3 uv)
+{
+        double theta = 2 * M_PI * uv[0], phi = M_PI * uv[1];
+
+        return Vec3 (std::sin (phi) * std::cos (theta), std::cos (phi), -std::sin (phi) * std::sin (theta));
+}
+
+Vec3 EnvironmentLight::radiance (Vec3 direction)
+{
+        Vec3 uv = EnvironmentLight::to_uv (direction);
+
+        return this->texture->read_texture_uv (uv, uv);
+}
+
+/**
+        Picks a direction with probability proportional to the radiance
+        arriving from it, pdf is per unit solid angle.
+ */
+Vec3 EnvironmentLight::sample (Vec3 &direction, double &pdf)
+{
+        double uv_pdf;
+        Vec3 uv = this->distribution.sample (random_double (0, 1), random_double (0, 1), uv_pdf);
+        double sin_phi = std::sin (M_PI * uv[1]);
+
+        direction = EnvironmentLight::to_direction (uv);
+        pdf = sin_phi > 0 ? uv_pdf / (2 * M_PI * M_PI * sin_phi) : 0;
+
+        return this->radiance (direction);
+}
+
+double EnvironmentLight::pdf (Vec3 direction)
+{
+        Vec3 uv = EnvironmentLight::to_uv (direction);
+        double sin_phi = std::sin (M_PI * uv[1]);
+
+        if (!(sin_phi > 0))
+                return 0;
+
+        return this->distribution.pdf (uv) / (2 * M_PI * M_PI * sin_phi);
+}
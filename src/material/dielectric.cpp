@@ -10,7 +10,7 @@
 #include <iostream>
 
 Dielectric::Dielectric (double refraction_index, double absorption)
-        : Material (new SolidTexture (Vec3 (1, 1, 1)), nullptr), refraction_index (refraction_index),
+        : Material (MaterialType::Dielectric, new SolidTexture (Vec3 (1, 1, 1)), nullptr), refraction_index (refraction_index),
           absorption (absorption)
 {
 }
@@ -62,6 +62,22 @@ Vec3 Dielectric::scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob
         return direction;
 }
 
+/**
+        out was either reflected or refracted by scatter (), which side of the
+        surface it leaves on tells which.
+ */
+void Dielectric::differentials (Ray &in, HitRecord &record, Ray &out)
+{
+        if (out.direction.dot (record.normal) > 0) {
+                record.reflect_differentials (in, out);
+                return;
+        }
+
+        double mu = record.front_face ? (1 / refraction_index) : refraction_index;
+
+        record.refract_differentials (in, out, mu);
+}
+
 double Dielectric::reflectance (double cosine, double refraction_index)
 {
         double r0 = (1 - refraction_index) / (1 + refraction_index);
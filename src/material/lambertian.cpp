@@ -12,12 +12,12 @@
 extern Camera::RendererSettings config;
 
 Lambertian::Lambertian (Vec3 solid_color)
-        : Material (new SolidTexture (solid_color), nullptr)
+        : Material (MaterialType::Lambertian, new SolidTexture (solid_color), nullptr)
 {
 }
 
 Lambertian::Lambertian (Texture *texture)
-        : Material (texture, nullptr)
+        : Material (MaterialType::Lambertian, texture, nullptr)
 {
 }
 
@@ -58,3 +58,19 @@ Vec3 Lambertian::scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob
 
         return out_direction;
 }
+
+bool Lambertian::evaluate (Ray, HitRecord &record, Vec3 direction, Vec3 &brdf, double &pdf)
+{
+        double cos_phi = direction.unit ().dot (record.normal.unit ());
+
+        if (cos_phi <= 0) {
+                pdf = 0;
+                brdf = Vec3 (0, 0, 0);
+                return true;
+        }
+
+        pdf = this->pdf (std::acos (cos_phi));
+        brdf = this->color (record) / M_PI;
+
+        return true;
+}
\ No newline at end of file
@@ -1,24 +1,39 @@
 #include "material.hpp"
 #include "hitrecord.hpp"
 #include "mat3.hpp"
+#include "material_table.hpp"
 #include "texture.hpp"
 #include "vec3.hpp"
 
-Material::Material ()
+Material::Material () : Material (MaterialType::Generic, nullptr, nullptr)
 {
 }
 
-Material::Material (Texture *texture, Texture *normal_map)
-        : texture (texture), normal_map (normal_map), emission_value (0, 0, 0)
+Material::Material (Texture *texture, Texture *normal_map) : Material (MaterialType::Generic, texture, normal_map)
 {
 }
 
-Vec3 Material::normal (Mat3 tbn, Vec3 n, Vec3 uv)
+Material::Material (MaterialType type, Texture *texture, Texture *normal_map)
+        : type (type), texture (texture), normal_map (normal_map), emission_value (0, 0, 0)
+{
+        this->id = MaterialTable::add (this);
+}
+
+Material::~Material ()
+{
+        MaterialTable::remove (this->id);
+}
+
+/**
+        width is the footprint of the lookup in texture coordinates, 0 reads
+        a single texel.
+ */
+Vec3 Material::normal (Mat3 tbn, Vec3 n, Vec3 uv, double width)
 {
         if (!this->normal_map)
                 return n;
 
-        Vec3 normal = this->normal_map->read_rgb255 (uv);
+        Vec3 normal = this->normal_map->lookup_rgb255 (uv, width);
 
         normal = normal * 2.0 / 255 + Vec3 (-1, -1, -1);
 
@@ -27,12 +42,14 @@ Vec3 Material::normal (Mat3 tbn, Vec3 n, Vec3 uv)
 
 Vec3 Material::color (HitRecord &record)
 {
-        return this->texture->read_texture_uv (record.uv, record.hit_point);
+        return this->texture->lookup (record.uv, record.hit_point, record.footprint ());
 }
 
 void Material::emission (Vec3 color)
 {
         this->emission_value = color;
+
+        MaterialTable::update (this);
 }
 
 Vec3 Material::emission ()
@@ -0,0 +1,55 @@
+#include "material_table.hpp"
+#include "material.hpp"
+#include "vec3.hpp"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+std::vector<MaterialRecord> MaterialTable::records;
+std::vector<uint32_t> MaterialTable::free_ids;
+std::mutex MaterialTable::lock;
+
+uint32_t MaterialTable::add (Material *material)
+{
+        std::lock_guard<std::mutex> guard (MaterialTable::lock);
+
+        uint32_t id;
+
+        if (MaterialTable::free_ids.empty ()) {
+                id = uint32_t (MaterialTable::records.size ());
+                MaterialTable::records.emplace_back ();
+        } else {
+                id = MaterialTable::free_ids.back ();
+                MaterialTable::free_ids.pop_back ();
+        }
+
+        material->id = id;
+        MaterialTable::records[id] = MaterialRecord{ .type = material->type,
+                                                     .emissive = material->is_emissive (),
+                                                     .emission = material->emission_value,
+                                                     .material = material };
+
+        return id;
+}
+
+/**
+        Called whenever a material changes a value that is kept in its
+        record.
+ */
+void MaterialTable::update (Material *material)
+{
+        std::lock_guard<std::mutex> guard (MaterialTable::lock);
+
+        MaterialRecord &record = MaterialTable::records[material->id];
+
+        record.emissive = material->is_emissive ();
+        record.emission = material->emission_value;
+}
+
+void MaterialTable::remove (uint32_t id)
+{
+        std::lock_guard<std::mutex> guard (MaterialTable::lock);
+
+        MaterialTable::records[id].material = nullptr;
+        MaterialTable::free_ids.push_back (id);
+}
@@ -0,0 +1,421 @@
+#include "merl.hpp"
+#include "distribution.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+// scale factors of the MERL data, per channel
+#define RED_SCALE   (1.0 / 1500.0)
+#define GREEN_SCALE (1.15 / 1500.0)
+#define BLUE_SCALE  (1.66 / 1500.0)
+
+// .binary files start with the three table dimensions
+#define MERL_HEADER_SIZE (3 * sizeof (int))
+#define MERL_FILE_SIZE   (MERL_HEADER_SIZE + 3 * sizeof (double) * size_t (MERL_SAMPLES))
+
+/**
+        Header of a cached float table, the source file's size and
+        modification time tell whether the cache is stale.
+ */
+struct MerlCacheHeader {
+        char magic[8];
+        uint64_t source_size;
+        int64_t source_mtime;
+};
+
+#define MERL_CACHE_MAGIC "MERLF32"
+#define MERL_CACHE_SIZE  (sizeof (MerlCacheHeader) + 3 * sizeof (float) * size_t (MERL_SAMPLES))
+
+const char *MerlBRDF::cache_directory = nullptr;
+
+// every loaded file by canonical path, entries expire with their last material
+static std::mutex registry_lock;
+static std::unordered_map<std::string, std::weak_ptr<MerlBRDF>> registry;
+
+MerlBRDF::MerlBRDF () : rgb (nullptr), mapping (nullptr), mapping_size (0)
+{
+}
+
+MerlBRDF::MerlBRDF (const double *planes) : MerlBRDF ()
+{
+        this->_convert ((const unsigned char *)planes);
+        this->_build_sampling ();
+}
+
+MerlBRDF::~MerlBRDF ()
+{
+        if (this->mapping)
+                munmap (this->mapping, this->mapping_size);
+}
+
+/**
+        planes is the data section of a .binary file: all red values, then
+        all green, then all blue. Missing measurements (negative values) are
+        stored as 0. The planes of a mapped file are not 8-byte aligned, so
+        the doubles are copied out one by one.
+ */
+void MerlBRDF::_convert (const unsigned char *planes)
+{
+        const double scale[3] = { RED_SCALE, GREEN_SCALE, BLUE_SCALE };
+
+        this->storage.resize (3 * size_t (MERL_SAMPLES));
+
+        for (int c = 0; c < 3; c++)
+                for (size_t i = 0; i < MERL_SAMPLES; i++) {
+                        double value;
+
+                        memcpy (&value, planes + (c * size_t (MERL_SAMPLES) + i) * sizeof (double), sizeof (double));
+                        this->storage[3 * i + c] = float (std::max (0.0, value * scale[c]));
+                }
+
+        this->rgb = this->storage.data ();
+}
+
+static void *map_file (const std::string &filename, int fd, size_t size)
+{
+        void *mapping = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping == MAP_FAILED)
+                throw std::runtime_error ("could not mmap MERL BRDF file " + filename + ": " + strerror (errno));
+
+        return mapping;
+}
+
+/**
+        Maps a .binary file and converts it. Files of the wrong size
+        (truncated downloads, other resolutions) are rejected.
+ */
+void MerlBRDF::_read (const std::string &filename)
+{
+        int fd = open (filename.c_str (), O_RDONLY);
+
+        if (fd < 0)
+                throw std::runtime_error ("could not open MERL BRDF file " + filename + ": " + strerror (errno));
+
+        struct stat st;
+
+        if (fstat (fd, &st) < 0 || size_t (st.st_size) != MERL_FILE_SIZE) {
+                close (fd);
+                throw std::runtime_error ("MERL BRDF file " + filename + " is truncated or has the wrong size");
+        }
+
+        void *mapping;
+
+        try {
+                mapping = map_file (filename, fd, MERL_FILE_SIZE);
+        } catch (std::runtime_error &e) {
+                close (fd);
+                throw;
+        }
+
+        close (fd);
+        madvise (mapping, MERL_FILE_SIZE, MADV_SEQUENTIAL);
+
+        int dims[3];
+        memcpy (dims, mapping, sizeof (dims));
+
+        if (size_t (dims[0]) * dims[1] * dims[2] != MERL_SAMPLES) {
+                munmap (mapping, MERL_FILE_SIZE);
+                throw std::runtime_error ("MERL BRDF file " + filename + " has unexpected dimensions");
+        }
+
+        this->_convert ((const unsigned char *)mapping + MERL_HEADER_SIZE);
+
+        munmap (mapping, MERL_FILE_SIZE);
+}
+
+bool MerlBRDF::_map_cache (const std::string &cache, struct stat &source)
+{
+        int fd = open (cache.c_str (), O_RDONLY);
+
+        if (fd < 0)
+                return false;
+
+        struct stat st;
+
+        if (fstat (fd, &st) < 0 || size_t (st.st_size) != MERL_CACHE_SIZE) {
+                close (fd);
+                return false;
+        }
+
+        void *mapping = mmap (NULL, MERL_CACHE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+
+        close (fd);
+
+        if (mapping == MAP_FAILED)
+                return false;
+
+        MerlCacheHeader *header = (MerlCacheHeader *)mapping;
+
+        if (memcmp (header->magic, MERL_CACHE_MAGIC, sizeof (header->magic)) != 0 ||
+            header->source_size != uint64_t (source.st_size) || header->source_mtime != int64_t (source.st_mtime)) {
+                munmap (mapping, MERL_CACHE_SIZE);
+                return false;
+        }
+
+        this->mapping = mapping;
+        this->mapping_size = MERL_CACHE_SIZE;
+        this->rgb = (const float *)((const char *)mapping + sizeof (MerlCacheHeader));
+
+        // the mapped table replaces the converted one
+        this->storage = std::vector<float> ();
+
+        return true;
+}
+
+/**
+        Written to a temporary file first, so that other processes never map
+        a partial cache. Failing to write the cache is not an error.
+ */
+void MerlBRDF::_write_cache (const std::string &cache, struct stat &source)
+{
+        std::string temporary = cache + ".tmp." + std::to_string (getpid ());
+        FILE *fp = fopen (temporary.c_str (), "wb");
+
+        if (!fp) {
+                log_warn ("Could not write BRDF cache %s: %s", cache.c_str (), strerror (errno));
+                return;
+        }
+
+        MerlCacheHeader header = {};
+
+        memcpy (header.magic, MERL_CACHE_MAGIC, sizeof (header.magic));
+        header.source_size = uint64_t (source.st_size);
+        header.source_mtime = int64_t (source.st_mtime);
+
+        bool written = fwrite (&header, sizeof (header), 1, fp) == 1 &&
+                       fwrite (this->storage.data (), sizeof (float), this->storage.size (), fp) == this->storage.size ();
+
+        if (fclose (fp) != 0 || !written || rename (temporary.c_str (), cache.c_str ()) != 0) {
+                log_warn ("Could not write BRDF cache %s: %s", cache.c_str (), strerror (errno));
+                remove (temporary.c_str ());
+        }
+}
+
+/**
+        Returns the shared instance for filename, loading it on first use.
+        Throws std::runtime_error if the file cannot be read.
+ */
+std::shared_ptr<MerlBRDF> MerlBRDF::load (const char *filename)
+{
+        char *resolved = realpath (filename, NULL);
+
+        if (!resolved)
+                throw std::runtime_error (std::string ("could not open MERL BRDF file ") + filename + ": " +
+                                          strerror (errno));
+
+        std::string path (resolved);
+        free (resolved);
+
+        std::lock_guard<std::mutex> guard (registry_lock);
+
+        std::shared_ptr<MerlBRDF> brdf = registry[path].lock ();
+
+        if (brdf)
+                return brdf;
+
+        brdf = std::shared_ptr<MerlBRDF> (new MerlBRDF ());
+
+        struct stat source;
+        std::string cache;
+
+        if (MerlBRDF::cache_directory && stat (path.c_str (), &source) == 0) {
+                std::string name = path.substr (path.find_last_of ('/') + 1);
+                char hash[17];
+
+                // files with the same name in different directories get different caches
+                snprintf (hash, sizeof (hash), "%016zx", std::hash<std::string> () (path));
+                cache = std::string (MerlBRDF::cache_directory) + "/" + name + "." + hash + ".f32";
+        }
+
+        if (cache.empty () || !brdf->_map_cache (cache, source)) {
+                brdf->_read (path);
+
+                if (!cache.empty ()) {
+                        brdf->_write_cache (cache, source);
+                        brdf->_map_cache (cache, source);
+                }
+        }
+
+        brdf->_build_sampling ();
+        registry[path] = brdf;
+
+        log_info ("Loaded MERL BRDF %s", path.c_str ());
+
+        return brdf;
+}
+
+/**
+        Half vector, and the incoming direction in the frame where the half
+        vector is +z (the difference vector). The rotations by -phi_half
+        around z and -theta_half around y only need the cosines and sines of
+        the angles, which are read off the half vector.
+ */
+void MerlBRDF::half_diff (Vec3 in, Vec3 out, Vec3 &half, Vec3 &diff)
+{
+        half = (in + out).unit ();
+
+        double cos_theta = half[2];
+        double sin_theta = std::sqrt (half[0] * half[0] + half[1] * half[1]);
+        double cos_phi = 1, sin_phi = 0;
+
+        if (sin_theta > 1e-12) {
+                cos_phi = half[0] / sin_theta;
+                sin_phi = half[1] / sin_theta;
+        }
+
+        double x = cos_phi * in[0] + sin_phi * in[1];
+        double y = cos_phi * in[1] - sin_phi * in[0];
+
+        diff = Vec3 (cos_theta * x - sin_theta * in[2], y, sin_theta * x + cos_theta * in[2]);
+}
+
+/**
+        Cell of the table for a pair of directions. theta_half is mapped
+        non-linearly (denser near the highlight), phi_half is ignored since
+        the BRDF is isotropic, and phi_diff is folded into [0, pi) by
+        reciprocity.
+ */
+size_t MerlBRDF::index (Vec3 in, Vec3 out)
+{
+        Vec3 half, diff;
+
+        MerlBRDF::half_diff (in, out, half, diff);
+
+        double theta_half = std::acos (std::clamp (half[2], -1.0, 1.0));
+        double theta_diff = std::acos (std::clamp (diff[2], -1.0, 1.0));
+        double phi_diff = std::atan2 (diff[1], diff[0]);
+
+        if (phi_diff < 0)
+                phi_diff += M_PI;
+
+        int h = theta_half > 0 ? int (std::sqrt (theta_half / (M_PI / 2)) * MERL_THETA_H) : 0;
+        int d = int (theta_diff / (M_PI / 2) * MERL_THETA_D);
+        int p = int (phi_diff / M_PI * MERL_PHI_D);
+
+        h = std::clamp (h, 0, MERL_THETA_H - 1);
+        d = std::clamp (d, 0, MERL_THETA_D - 1);
+        p = std::clamp (p, 0, MERL_PHI_D - 1);
+
+        return size_t (p) + size_t (d) * MERL_PHI_D + size_t (h) * MERL_PHI_D * MERL_THETA_D;
+}
+
+Vec3 MerlBRDF::eval (Vec3 in, Vec3 out)
+{
+        if (in[2] <= 0 || out[2] <= 0)
+                return Vec3 (0, 0, 0);
+
+        const float *value = &this->rgb[3 * MerlBRDF::index (in, out)];
+
+        return Vec3 (value[0], value[1], value[2]);
+}
+
+static Vec3 hemisphere_direction (double theta, double phi)
+{
+        return Vec3 (std::sin (theta) * std::cos (phi), std::sin (theta) * std::sin (phi), std::cos (theta));
+}
+
+/**
+        Each table covers the outgoing hemisphere relative to the azimuth of
+        the incoming direction. A small floor keeps the pdf positive wherever
+        the (piecewise constant) tables could miss a part of the lobe.
+ */
+void MerlBRDF::_build_sampling ()
+{
+        int nu = MERL_SAMPLING_PHI_OUT, nv = MERL_SAMPLING_THETA_OUT;
+
+        this->sampling.reserve (MERL_SAMPLING_THETA_IN);
+
+        for (int i = 0; i < MERL_SAMPLING_THETA_IN; i++) {
+                Vec3 in = hemisphere_direction ((i + 0.5) / MERL_SAMPLING_THETA_IN * M_PI / 2, 0);
+                std::vector<double> func (size_t (nu) * nv);
+                double sum = 0;
+
+                for (int v = 0; v < nv; v++) {
+                        double theta = (v + 0.5) / nv * M_PI / 2;
+
+                        for (int u = 0; u < nu; u++) {
+                                Vec3 out = hemisphere_direction (theta, (u + 0.5) / nu * 2 * M_PI);
+                                Vec3 f = this->eval (in, out);
+
+                                // f * cos(theta) over solid angle, times the sin(theta) of the mapping
+                                double weight = (f[0] + f[1] + f[2]) * std::cos (theta) * std::sin (theta);
+
+                                func[size_t (v) * nu + u] = weight;
+                                sum += weight;
+                        }
+                }
+
+                double floor = std::max (sum / func.size () * 1e-2, 1e-8);
+
+                for (int v = 0; v < nv; v++)
+                        for (int u = 0; u < nu; u++)
+                                func[size_t (v) * nu + u] += floor * std::sin ((v + 0.5) / nv * M_PI / 2);
+
+                this->sampling.emplace_back (func, nu, nv);
+        }
+}
+
+int MerlBRDF::_sampling_row (Vec3 in)
+{
+        double theta = std::acos (std::clamp (in[2], 0.0, 1.0));
+
+        return std::clamp (int (theta / (M_PI / 2) * MERL_SAMPLING_THETA_IN), 0, MERL_SAMPLING_THETA_IN - 1);
+}
+
+/**
+        Samples an outgoing direction roughly proportionally to
+        f * cos(theta_out) and returns f for it. pdf is per unit solid angle.
+ */
+Vec3 MerlBRDF::sample (Vec3 in, Vec3 &out, double &pdf)
+{
+        double uv_pdf;
+        Vec3 uv = this->sampling[this->_sampling_row (in)].sample (random_double (0, 1), random_double (0, 1), uv_pdf);
+
+        double theta = uv[1] * M_PI / 2;
+        double phi = uv[0] * 2 * M_PI + std::atan2 (in[1], in[0]);
+        double sin_theta = std::sin (theta);
+
+        out = hemisphere_direction (theta, phi);
+        pdf = sin_theta > 0 ? uv_pdf / (M_PI * M_PI * sin_theta) : 0;
+
+        return this->eval (in, out);
+}
+
+double MerlBRDF::pdf (Vec3 in, Vec3 out)
+{
+        if (in[2] <= 0 || out[2] <= 0)
+                return 0;
+
+        double theta = std::acos (std::clamp (out[2], 0.0, 1.0));
+        double phi = std::atan2 (out[1], out[0]) - std::atan2 (in[1], in[0]);
+        double sin_theta = std::sin (theta);
+
+        if (!(sin_theta > 0))
+                return 0;
+
+        phi -= 2 * M_PI * std::floor (phi / (2 * M_PI));
+
+        Vec3 uv (phi / (2 * M_PI), theta / (M_PI / 2), 0);
+
+        return this->sampling[this->_sampling_row (in)].pdf (uv) / (M_PI * M_PI * sin_theta);
+}
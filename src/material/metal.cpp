@@ -6,11 +6,11 @@
 #include "texture.hpp"
 #include "vec3.hpp"
 
-Metal::Metal (double fuzz, Vec3 color) : Material (new SolidTexture (color), nullptr), fuzz (fuzz)
+Metal::Metal (double fuzz, Vec3 color) : Material (MaterialType::Metal, new SolidTexture (color), nullptr), fuzz (fuzz)
 {
 }
 
-Metal::Metal (double fuzz, Texture *texture) : Material (texture, nullptr), fuzz (fuzz)
+Metal::Metal (double fuzz, Texture *texture) : Material (MaterialType::Metal, texture, nullptr), fuzz (fuzz)
 {
 }
 
@@ -20,9 +20,22 @@ Vec3 Metal::scatter (Ray r, HitRecord &record, Vec3 &brdf, double &ray_prob)
 
         double lambert_cos = reflect_direction.unit().dot(record.normal);
 
-        brdf = this->texture->read_texture_uv(record.uv, record.hit_point) / lambert_cos;
+        brdf = this->texture->lookup (record.uv, record.hit_point, record.footprint ()) / lambert_cos;
         
         ray_prob = 1;
 
         return reflect_direction.unit ();
 }
+
+/**
+        Only a perfect mirror keeps the footprint of the incoming ray.
+ */
+void Metal::differentials (Ray &in, HitRecord &record, Ray &out)
+{
+        if (this->fuzz > 0) {
+                out.has_differentials = false;
+                return;
+        }
+
+        record.reflect_differentials (in, out);
+}
\ No newline at end of file
@@ -14,13 +14,13 @@ Phong::Phong (double rs,
               double mu,
               Texture *texture,
               Texture *normal_map)
-        : Material (texture, normal_map), rs (rs), rd (rd), ra (ra), rg (rg), shininess (shininess), gamma (gamma),
+        : Material (MaterialType::Phong, texture, normal_map), rs (rs), rd (rd), ra (ra), rg (rg), shininess (shininess), gamma (gamma),
           mu (mu)
 {
 }
 
 Phong::Phong (double rs, double rd, double ra, double rg, double shininess, double gamma, double mu, Texture *texture)
-        : Material (texture, nullptr), rs (rs), rd (rd), ra (ra), rg (rg), shininess (shininess), gamma (gamma), mu (mu)
+        : Material (MaterialType::Phong, texture, nullptr), rs (rs), rd (rd), ra (ra), rg (rg), shininess (shininess), gamma (gamma), mu (mu)
 {
 }
 Phong::PhongParams Phong::phong (Ray r, HitRecord &record)
@@ -31,6 +31,6 @@ Phong::PhongParams Phong::phong (Ray r, HitRecord &record)
                             .alpha = this->shininess,
                             .gamma = this->gamma,
                             .mu = this->mu,
-                            .color = this->texture->read_texture_uv (record.uv, record.hit_point),
+                            .color = this->texture->lookup (record.uv, record.hit_point, record.footprint ()),
                             .rg = this->rg };
 }
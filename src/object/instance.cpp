@@ -0,0 +1,130 @@
+#include "instance.hpp"
+#include "hitrecord.hpp"
+#include "mat3.hpp"
+#include "object.hpp"
+#include "ray.hpp"
+#include "vec3.hpp"
+
+Instance::Instance (Object *object)
+        : Object (Vec3 (0, 0, 0), object->material), object (object),
+          linear (Vec3 (1, 0, 0), Vec3 (0, 1, 0), Vec3 (0, 0, 1)),
+          linear_inverse (Vec3 (1, 0, 0), Vec3 (0, 1, 0), Vec3 (0, 0, 1))
+{
+}
+
+Instance::Instance (Object *object, Vec3 location, double scale) : Instance (object)
+{
+        this->scale (scale)->translate (location);
+}
+
+/**
+        Motion set with move_to () is transformed along with the instance, so
+        it does not matter whether it is set before or after the transforms.
+ */
+void Instance::_update_motion (Vec3 motion)
+{
+        this->move_to (this->location + motion);
+}
+
+void Instance::_update_inverse ()
+{
+        this->linear_inverse = this->linear.inverse ();
+}
+
+Instance *Instance::rotate (Mat3 rotation)
+{
+        this->linear = rotation * this->linear;
+        this->location = rotation * this->location;
+        this->_update_motion (rotation * this->displacement.direction);
+        this->_update_inverse ();
+
+        return this;
+}
+
+Instance *Instance::scale (double s)
+{
+        this->linear = this->linear * s;
+        this->location *= s;
+        this->_update_motion (this->displacement.direction * s);
+        this->_update_inverse ();
+
+        return this;
+}
+
+Instance *Instance::translate (Vec3 v)
+{
+        this->location += v;
+        this->_update_motion (this->displacement.direction);
+
+        return this;
+}
+
+Vec3 Instance::to_object_point (Vec3 point)
+{
+        return this->linear_inverse * (point - this->location);
+}
+
+Vec3 Instance::to_world_vector (Vec3 v)
+{
+        return this->linear * v;
+}
+
+/**
+        Normals transform by the inverse transpose of the linear part, which
+        keeps them perpendicular to the transformed surface.
+ */
+Vec3 Instance::to_world_normal (Vec3 n)
+{
+        return this->linear_inverse.transpose () * n;
+}
+
+bool Instance::is_light_source ()
+{
+        return false;
+}
+
+bool Instance::hit (Ray r, HitRecord &record)
+{
+        /**
+                The object space direction is deliberately not normalized, so
+                that lambda along the object space ray is the same as lambda
+                along the world space ray.
+         */
+        Ray local (this->to_object_point (r.origin - this->motion_offset (r.time)), this->linear_inverse * r.direction,
+                   r.time);
+
+        if (!this->object->hit (local, record))
+                return false;
+
+        record.hit_point = r.at (record.lambda);
+        record.setNormal (r, this->to_world_normal (record.outward_normal ()));
+        record.instance = this;
+        record.time = r.time;
+
+        return true;
+}
+
+/**
+        The corners of the object's bounds are transformed into world space,
+        which gives conservative bounds under rotation.
+ */
+bool Instance::bounds (double time, Vec3 &min, Vec3 &max)
+{
+        Vec3 object_min, object_max;
+
+        if (!this->object->bounds (time, object_min, object_max))
+                return false;
+
+        Vec3 offset = this->location + this->motion_offset (time);
+
+        for (int i = 0; i < 8; i++) {
+                Vec3 corner (i & 1 ? object_max[0] : object_min[0], i & 2 ? object_max[1] : object_min[1],
+                             i & 4 ? object_max[2] : object_min[2]);
+                Vec3 world = this->linear * corner + offset;
+
+                min = i == 0 ? world : Vec3::min (min, world);
+                max = i == 0 ? world : Vec3::max (max, world);
+        }
+
+        return true;
+}
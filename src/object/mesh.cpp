@@ -1,34 +1,372 @@
-
-#include "kdtree.hpp"
-#include "triangle.hpp"
-#include "utils.hpp"
-#include <ostream>
 #include "hitrecord.hpp"
 #include "material.hpp"
 #include "mesh.hpp"
+#include "obj.hpp"
 #include "object.hpp"
+#include "ply.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 #include "vec3.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <strings.h>
 #include <vector>
 
+bool Mesh::lazy_loading = false;
+size_t Mesh::memory_budget = 0;
+Mesh::Accelerator Mesh::accelerator = Mesh::Accelerator::KDTree;
+
+std::mutex Mesh::_resident_lock;
+std::vector<Mesh *> Mesh::_resident_meshes;
+std::atomic<size_t> Mesh::_resident_bytes (0);
+
+// hits of a mesh only refresh its last use this long after the previous one, so threads do not keep writing it
+#define MESH_USE_RESOLUTION_NS 1000000
+
+static uint64_t now_ns ()
+{
+        return std::chrono::duration_cast<std::chrono::nanoseconds> (
+                       std::chrono::steady_clock::now ().time_since_epoch ())
+                .count ();
+}
+
+Mesh::Geometry::~Geometry ()
+{
+        this->triangle_kdtree.release ();
+
+        for (Triangle *tri : this->triangles)
+                delete tri;
+}
+
+/**
+        Area weighted centroid (as compute_mesh_centroid), bounds and count
+        of the triangles among n that the loaders keep (the degenerate ones
+        are skipped), corner (t, k) being vertex k of triangle t.
+ */
+template <typename Corner>
+static Vec3 shape_centroid (size_t n, Corner corner, Vec3 &min, Vec3 &max, size_t &count)
+{
+        Vec3 centroid (0, 0, 0);
+        double total_area = 0;
+        double inf = std::numeric_limits<double>::infinity ();
+
+        min = Vec3 (inf, inf, inf);
+        max = -min;
+        count = 0;
+
+        for (size_t t = 0; t < n; t++) {
+                Vec3 v1 = corner (t, 0), v2 = corner (t, 1), v3 = corner (t, 2);
+
+                if (degenerate_triangle (v1, v2, v3))
+                        continue;
+
+                double area = (v2 - v1).cross (v3 - v1).length () / 2;
+
+                centroid += area * ((v1 + v2 + v3) / 3);
+                total_area += area;
+
+                min = Vec3::min (min, Vec3::min (v1, Vec3::min (v2, v3)));
+                max = Vec3::max (max, Vec3::max (v1, Vec3::max (v2, v3)));
+                count++;
+        }
+
+        return centroid / total_area;
+}
+
 Mesh::Mesh (const char *obj_filename, Vec3 location, double scale, Material *material)
-        : Object (location, material), scale (scale)
+        : Object (location, material), scale (scale), _resident (nullptr), _last_used (0), _loaded (false)
 {
         this->obj_filename = (char *)obj_filename;
-        std::string warn, err;
+        this->_baked_location = location;
+
+        if (Mesh::lazy_loading) {
+                this->_read_bounds ();
+                return;
+        }
+
+        std::vector<Triangle *> triangles = this->_read_triangles (true);
+
+        double inf = std::numeric_limits<double>::infinity ();
+        double min[3] = { inf, inf, inf }, max[3] = { -inf, -inf, -inf };
+
+        for (Triangle *tri : triangles)
+                for (Vec3 v : tri->verticies ())
+                        for (int i = 0; i < 3; i++) {
+                                min[i] = std::min (min[i], v[i]);
+                                max[i] = std::max (max[i], v[i]);
+                        }
+
+        this->bounding_box = KDTree::BoundingBox (Vec3 (min[0], min[1], min[2]), Vec3 (max[0], max[1], max[2]));
+        this->triangle_count = triangles.size ();
+
+        std::unique_lock<std::shared_mutex> lock (this->_residency);
+        this->_make_resident (triangles);
+        lock.unlock ();
+
+        Mesh::_enforce_budget (this);
+}
+
+/**
+        Loads the mesh in object space: centred on its centroid with unit scale.
+        Use an Instance to place (and re-use) it in the scene.
+ */
+Mesh::Mesh (const char *obj_filename, Material *material) : Mesh (obj_filename, Vec3 (0, 0, 0), 1, material)
+{
+}
+
+Mesh::~Mesh ()
+{
+        if (!this->_geometry)
+                return;
+
+        {
+                std::lock_guard<std::mutex> guard (Mesh::_resident_lock);
+                std::erase (Mesh::_resident_meshes, this);
+        }
+
+        this->_evict ();
+}
+
+/**
+        Reads the triangles from disk, centres them on the mesh centroid and
+        applies the scale and location of the mesh. The centroid is computed
+        once, on the first read or by _read_bounds, so that re-loaded
+        triangles line up exactly with the bounds computed at construction.
+ */
+std::vector<Triangle *> Mesh::_read_triangles (bool compute_centroid)
+{
+        TRACE_SCOPE ("mesh parse");
+
+        std::vector<Triangle *> triangles;
+        size_t length = strlen (this->obj_filename);
+
+        if (length > 4 && strcasecmp (this->obj_filename + length - 4, ".ply") == 0)
+                triangles = load_ply_mesh (this->obj_filename, this->material);
+        else
+                triangles = load_obj_mesh (this->obj_filename, this->material);
+
+        if (compute_centroid)
+                this->_centroid = compute_mesh_centroid (triangles);
+
+        for (Triangle *tri : triangles)
+                tri->translate (-this->_centroid)->scale (this->scale)->translate (this->_baked_location);
+
+        return triangles;
+}
+
+/**
+        Computes the centroid, bounds and triangle count of a lazily loaded
+        mesh from the vertices and faces of its file, without creating its
+        triangles.
+ */
+void Mesh::_read_bounds ()
+{
+        TRACE_SCOPE ("mesh parse");
+
+        Vec3 min, max;
+        size_t length = strlen (this->obj_filename);
+
+        if (length > 4 && strcasecmp (this->obj_filename + length - 4, ".ply") == 0) {
+                PlyFile ply (this->obj_filename);
+
+                ply.parse ();
+                this->_centroid = shape_centroid (
+                        ply.triangle_count (),
+                        [&ply] (size_t t, int k) {
+                                double *v = &ply.vertices[3 * ply.indices[3 * t + k]];
+
+                                return Vec3 (v[0], v[1], v[2]);
+                        },
+                        min, max, this->triangle_count);
+        } else {
+                ObjFile obj (this->obj_filename);
+
+                obj.parse ();
+                this->_centroid = shape_centroid (
+                        obj.triangle_count (),
+                        [&obj] (size_t t, int k) { return obj.vertices[obj.indices[3 * t + k].vertex]; }, min, max,
+                        this->triangle_count);
+        }
+
+        // the corners go through the same transform as the vertices in _read_triangles
+        Vec3 a = (min - this->_centroid) * this->scale + this->_baked_location;
+        Vec3 b = (max - this->_centroid) * this->scale + this->_baked_location;
+
+        this->bounding_box = KDTree::BoundingBox (Vec3::min (a, b), Vec3::max (a, b));
+}
+
+/**
+        Builds the selected accelerator over the triangles and publishes the
+        geometry. The caller must hold the residency lock exclusively.
+ */
+void Mesh::_make_resident (std::vector<Triangle *> triangles)
+{
+        std::shared_ptr<Geometry> geometry = std::make_shared<Geometry> ();
+
+        geometry->triangles = triangles;
+        geometry->accelerator = Mesh::accelerator;
+        geometry->bytes = geometry->triangles.size () * (sizeof (Triangle) + sizeof (Triangle *));
+
+        {
+                TRACE_SCOPE ("mesh accelerator build");
+
+                switch (geometry->accelerator) {
+                case Accelerator::KDTree:
+                        geometry->triangle_kdtree = KDTree (geometry->triangles);
+                        geometry->bytes += geometry->triangle_kdtree.memory_usage ();
+                        break;
+                case Accelerator::BVH4:
+                        geometry->triangle_bvh4 = WideBVH<4> (geometry->triangles);
+                        geometry->bytes += geometry->triangle_bvh4.memory_usage ();
+                        break;
+                case Accelerator::BVH8:
+                        geometry->triangle_bvh8 = WideBVH<8> (geometry->triangles);
+                        geometry->bytes += geometry->triangle_bvh8.memory_usage ();
+                        break;
+                }
+        }
 
-        this->triangles = load_obj_mesh ((char *)obj_filename, material);
+        {
+                std::lock_guard<std::mutex> guard (Mesh::_resident_lock);
+                Mesh::_resident_meshes.push_back (this);
+        }
 
-        Vec3 centroid = compute_mesh_centroid (this->triangles);
+        Mesh::_resident_bytes += geometry->bytes;
+        this->_last_used.store (now_ns (), std::memory_order_relaxed);
+        this->_geometry = geometry;
+        this->_resident.store (geometry.get (), std::memory_order_release);
 
-        for (Triangle *tri : triangles) 
-                tri->translate (-centroid)->scale (scale)->translate (location);
-        
-        this->triangle_kdtree = KDTree (this->triangles);
+        // evicted meshes are re-loaded by the render threads, only the first load is logged
+        if (this->_loaded)
+                return;
 
-        std::cerr << "Loaded mesh triangles: " << this->triangles.size () << std::endl;
+        this->_loaded = true;
+
+        std::cerr << "Loaded mesh triangles: " << geometry->triangles.size () << std::endl;
+
+        if (geometry->accelerator == Accelerator::KDTree) {
+                KDTree::BuildStats &stats = geometry->triangle_kdtree.stats;
+
+                log_info ("Built KDTree in %.3fs: %zu nodes, %zu leaves, depth %zu, %.1f triangles per leaf",
+                          stats.build_seconds, stats.nodes, stats.leaves, stats.max_depth,
+                          stats.leaves ? double (stats.triangle_references) / stats.leaves : 0.0);
+        } else if (geometry->accelerator == Accelerator::BVH4) {
+                WideBVH<4>::BuildStats &stats = geometry->triangle_bvh4.stats;
+
+                log_info ("Built BVH4 in %.3fs: %zu nodes, %zu leaves, depth %zu", stats.build_seconds, stats.nodes,
+                          stats.leaves, stats.max_depth);
+        } else {
+                WideBVH<8>::BuildStats &stats = geometry->triangle_bvh8.stats;
+
+                log_info ("Built BVH8 in %.3fs: %zu nodes, %zu leaves, depth %zu", stats.build_seconds, stats.nodes,
+                          stats.leaves, stats.max_depth);
+        }
+}
+
+void Mesh::_load ()
+{
+        {
+                std::unique_lock<std::shared_mutex> lock (this->_residency);
+
+                // another thread may have loaded the mesh while we were waiting
+                if (!this->_geometry)
+                        this->_make_resident (this->_read_triangles (false));
+        }
+
+        Mesh::_enforce_budget (this);
+}
+
+/**
+        Lets go of the geometry, which is freed once no hit record holds it
+        any more. The caller must hold the residency lock exclusively.
+ */
+void Mesh::_evict ()
+{
+        if (!this->_geometry)
+                return;
+
+        this->_resident.store (nullptr, std::memory_order_release);
+        Mesh::_resident_bytes -= this->_geometry->bytes;
+        this->_geometry.reset ();
+}
+
+/**
+        The geometry of the mesh, loaded if it is not resident. It stays
+        alive while the returned pointer is held, even if the mesh is
+        evicted meanwhile.
+ */
+std::shared_ptr<Mesh::Geometry> Mesh::_acquire ()
+{
+        while (true) {
+                {
+                        std::shared_lock<std::shared_mutex> lock (this->_residency);
+
+                        if (this->_geometry)
+                                return this->_geometry;
+                }
+
+                this->_load ();
+        }
+}
+
+/**
+        Evicts the least recently hit meshes (other than keep) until the
+        resident geometry fits in the memory budget. Meshes that another
+        thread is loading or acquiring are skipped, so the budget may be
+        exceeded briefly rather than stalling the renderer. Geometry that
+        hits still point into is freed once they are done with it.
+ */
+void Mesh::_enforce_budget (Mesh *keep)
+{
+        if (Mesh::memory_budget == 0)
+                return;
+
+        std::lock_guard<std::mutex> guard (Mesh::_resident_lock);
+
+        std::sort (Mesh::_resident_meshes.begin (), Mesh::_resident_meshes.end (), [] (Mesh *a, Mesh *b) {
+                return a->_last_used.load (std::memory_order_relaxed) < b->_last_used.load (std::memory_order_relaxed);
+        });
+
+        for (size_t i = 0; i < Mesh::_resident_meshes.size () && Mesh::_resident_bytes > Mesh::memory_budget;) {
+                Mesh *victim = Mesh::_resident_meshes[i];
+
+                if (victim == keep || !victim->_residency.try_lock ()) {
+                        i++;
+                        continue;
+                }
+
+                victim->_evict ();
+                victim->_residency.unlock ();
+
+                Mesh::_resident_meshes.erase (Mesh::_resident_meshes.begin () + i);
+        }
+}
+
+bool Mesh::is_resident ()
+{
+        return this->_resident.load (std::memory_order_acquire) != nullptr;
+}
+
+double Mesh::build_seconds ()
+{
+        std::shared_lock<std::shared_mutex> lock (this->_residency);
+        Geometry *geometry = this->_geometry.get ();
+
+        if (!geometry)
+                return 0;
+
+        switch (geometry->accelerator) {
+        case Accelerator::BVH4: return geometry->triangle_bvh4.stats.build_seconds;
+        case Accelerator::BVH8: return geometry->triangle_bvh8.stats.build_seconds;
+        default: return geometry->triangle_kdtree.stats.build_seconds;
+        }
 }
 
 bool Mesh::is_light_source ()
@@ -36,7 +374,85 @@ bool Mesh::is_light_source ()
         return false;
 }
 
+/**
+        Offset of the mesh at the given time from where its triangles are baked.
+ */
+Vec3 Mesh::_offset (double time)
+{
+        return this->location_at_time (time) - this->_baked_location;
+}
+
+bool Mesh::bounds (double time, Vec3 &min, Vec3 &max)
+{
+        Vec3 offset = this->_offset (time);
+
+        min = this->bounding_box.min + offset;
+        max = this->bounding_box.max + offset;
+
+        return true;
+}
+
+/**
+        Triangles are baked at the location the mesh was constructed with, so
+        a mesh that has been moved since is intersected by moving the ray back
+        by the mesh's offset at the ray's time.
+ */
 bool Mesh::hit (Ray r, HitRecord &record)
 {
-        return this->triangle_kdtree.ray_hit (r, record);
+        double lambda_min, lambda_max;
+        Vec3 offset = this->_offset (r.time);
+
+        r.origin -= offset;
+
+        // rays that miss the bounds never trigger a load
+        if (!this->bounding_box.hit (r, lambda_min, lambda_max))
+                return false;
+
+        uint64_t now = now_ns ();
+
+        if (now - this->_last_used.load (std::memory_order_relaxed) > MESH_USE_RESOLUTION_NS)
+                this->_last_used.store (now, std::memory_order_relaxed);
+
+        if (Mesh::memory_budget == 0) {
+                // without a budget, geometry is never evicted and can be read without locking
+                if (!this->is_resident ())
+                        this->_load ();
+
+                return this->_hit_geometry (this->_resident.load (std::memory_order_acquire), r, record, offset);
+        }
+
+        std::shared_ptr<Geometry> geometry = this->_acquire ();
+
+        if (!this->_hit_geometry (geometry.get (), r, record, offset))
+                return false;
+
+        // the triangle in the record belongs to geometry, which another thread may evict meanwhile
+        record.owner = std::move (geometry);
+
+        return true;
+}
+
+bool Mesh::_hit_geometry (Geometry *geometry, Ray r, HitRecord &record, Vec3 offset)
+{
+        bool hit;
+
+        switch (geometry->accelerator) {
+        case Accelerator::BVH4:
+                hit = geometry->triangle_bvh4.ray_hit (r, record);
+                break;
+        case Accelerator::BVH8:
+                hit = geometry->triangle_bvh8.ray_hit (r, record);
+                break;
+        default:
+                hit = geometry->triangle_kdtree.ray_hit (r, record);
+                break;
+        }
+
+        if (!hit)
+                return false;
+
+        record.hit_point += offset;
+        record.time = r.time;
+
+        return true;
 }
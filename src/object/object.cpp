@@ -11,7 +11,7 @@ Object::Object (Vec3 location1, Vec3 location2, Material *material)
         this->displacement = Ray (location1, location2 - location1);
 }
 
-Object::Object (Vec3 location, Material *material) : location (location), material (material)
+Object::Object (Vec3 location, Material *material) : location (location), location2 (location), material (material)
 {
         this->displacement = Ray (location, Vec3 (0, 0, 0));
 }
@@ -19,4 +19,34 @@ Object::Object (Vec3 location, Material *material) : location (location), materi
 Vec3 Object::location_at_time (double time)
 {
         return this->displacement.at (time);
-}
\ No newline at end of file
+}
+
+void Object::move_to (Vec3 location2)
+{
+        this->location2 = location2;
+        this->displacement = Ray (this->location, location2 - this->location);
+}
+
+/**
+        Puts the object at location at time 0, moving to location2 by time 1.
+ */
+void Object::place (Vec3 location, Vec3 location2)
+{
+        this->location = location;
+        this->move_to (location2);
+}
+
+Vec3 Object::motion_offset (double time)
+{
+        return this->displacement.direction * time;
+}
+
+bool Object::bounds (double, Vec3 &, Vec3 &)
+{
+        return false;
+}
+
+Object::Primitive Object::primitive ()
+{
+        return Primitive::Other;
+}
@@ -12,11 +12,6 @@ Quad::Quad (Vec3 location, Vec3 v1, Vec3 v2, Material *mat) : SmoothObject (loca
         this->v2 = v2;
 }
 
-bool &Quad::one_sided ()
-{
-        return this->_one_sided;
-}
-
 Vec3 Quad::find_alpha_beta (Vec3 point)
 {
         Vec3 n = this->v2.cross (v1);
@@ -31,44 +26,52 @@ Vec3 Quad::find_alpha_beta (Vec3 point)
         return Vec3 (alpha, beta, 0);
 }
 
-bool Quad::hit (Ray r, HitRecord &record)
+/**
+        alpha = (p - location) . a and beta = (p - location) . b are the
+        coordinates find_alpha_beta gives a point p on the plane:
+        alpha = (v2 x p) . n and beta = (v1 x p) . -n with
+        n = v2 x v1 / |v2 x v1|^2, that is p . (n x v2) and p . (v1 x n).
+ */
+void Quad::alpha_beta_axes (Vec3 &a, Vec3 &b)
 {
-        Vec3 normal = this->_normal();
+        Vec3 n = this->v2.cross (this->v1);
 
-        /**
-                If the quad is one-sided, then only rays that hit the surface
-                opposing the normal direction will register as a hit.
+        n /= n.length_squared ();
 
-                i.e quad is invisible from back side.
-         */
-        if (this->one_sided ())
-                if (r.direction.dot (normal) > 0)
-                        return false;
+        a = n.cross (this->v2);
+        b = this->v1.cross (n);
+}
 
-        double top = normal.dot (this->location - r.origin);
+bool Quad::hit (Ray r, HitRecord &record)
+{
+        Vec3 normal = this->_normal ();
+        Vec3 origin = r.origin - this->location;
+        Vec3 a, b;
+        double lambda;
 
-        double bottom = normal.dot (r.direction);
+        this->alpha_beta_axes (a, b);
 
-        if (bottom == 0.0)
+        if (!Quad::intersect (origin[0], origin[1], origin[2], r.direction[0], r.direction[1], r.direction[2],
+                              normal[0], normal[1], normal[2], a[0], a[1], a[2], b[0], b[1], b[2], this->one_sided (),
+                              lambda))
                 return false;
 
-        double lambda = top / bottom;
+        this->hit_record (r, lambda, record);
+        return true;
+}
 
+/**
+        Fills in record for the hit at lambda, found by hit or by the BVH.
+ */
+void Quad::hit_record (Ray r, double lambda, HitRecord &record)
+{
         Vec3 hit_point = r.at (lambda);
 
-        Vec3 uv = this->find_alpha_beta (hit_point);
-
-        bool hit = (0 <= uv[0] && uv[0] <= 1) && (0 <= uv[1] && uv[1] <= 1);
-
-        if (!hit)
-                return false;
-
         record.hit_point = hit_point;
         record.lambda = lambda;
-        record.uv = uv;
+        record.uv = this->find_alpha_beta (hit_point);
         record.setNormal (r, this->mapped_normal (hit_point));
         record.object = this;
-        return true;
 }
 
 Vec3 Quad::_normal() {
@@ -103,4 +106,24 @@ Vec3 Quad::sample_point ()
 double Quad::area ()
 {
         return this->v1.cross (this->v2).length ();
-}
\ No newline at end of file
+}
+
+bool Quad::bounds (double, Vec3 &min, Vec3 &max)
+{
+        Vec3 corners[] = { this->location, this->location + this->v1, this->location + this->v2,
+                           this->location + this->v1 + this->v2 };
+
+        min = max = corners[0];
+
+        for (Vec3 corner : corners) {
+                min = Vec3::min (min, corner);
+                max = Vec3::max (max, corner);
+        }
+
+        return true;
+}
+
+Object::Primitive Quad::primitive ()
+{
+        return Primitive::Quad;
+}
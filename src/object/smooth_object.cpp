@@ -1,5 +1,6 @@
 #include "smooth_object.hpp"
 #include "hitrecord.hpp"
+#include "instance.hpp"
 #include "mat3.hpp"
 #include "material.hpp"
 #include "object.hpp"
@@ -30,7 +31,7 @@ Vec3 SmoothObject::mapped_normal (Vec3 point)
         if (!this->material->normal_map)
                 return this->normal (point);
 
-        return this->material->normal (this->tbn (point), this->normal (point), this->to_uv (point));
+        return this->material->normal (this->tbn (point), this->normal (point), this->to_uv (point), 0);
 }
 /**
         Tangent, BiTangent & Normal Matrix:
@@ -51,14 +52,57 @@ Mat3 SmoothObject::tbn (Vec3 point)
         This matrix converts tangent space into world space.
 
         Used in path tracer for BRDF unit hemisphere coordinate system calculations.
+
+        If the object was hit through an Instance, the tangent and normal are
+        computed in object space and then carried into world space.
  */
 Mat3 SmoothObject::tnb (HitRecord &record)
 {
-        Vec3 tangent = this->tangent (record.hit_point).unit();
-        Vec3 normal = this->normal(record.hit_point).unit();
-        Mat3 tnb (tangent, normal, normal.cross (tangent).unit());
+        Vec3 tangent, normal;
+
+        this->_world_frame (record, tangent, normal);
+
+        return Mat3 (tangent, normal, normal.cross (tangent).unit ());
+}
+
+/**
+        Unit tangent and normal at the hit point, in world space.
+ */
+void SmoothObject::_world_frame (HitRecord &record, Vec3 &tangent, Vec3 &normal)
+{
+        // undo the motion of moving objects, their surface is defined at time 0
+        if (record.instance) {
+                Vec3 point = record.instance->to_object_point (record.hit_point -
+                                                               record.instance->motion_offset (record.time)) -
+                             this->motion_offset (record.time);
+                tangent = record.instance->to_world_vector (this->tangent (point)).unit ();
+                normal = record.instance->to_world_normal (this->normal (point)).unit ();
+
+                return;
+        }
+
+        Vec3 point = record.hit_point - this->motion_offset (record.time);
+        tangent = this->tangent (point).unit ();
+        normal = this->normal (point).unit ();
+}
+
+/**
+        Normal mapped normal at the hit point in world space, with the normal
+        map filtered over a footprint of the given width (see
+        HitRecord::footprint ()).
+ */
+Vec3 SmoothObject::shading_normal (HitRecord &record, double width)
+{
+        Vec3 tangent, normal;
+
+        this->_world_frame (record, tangent, normal);
+
+        if (!this->material->normal_map)
+                return normal;
+
+        Mat3 tbn (tangent, normal.cross (tangent), normal);
 
-        return tnb;
+        return this->material->normal (tbn, normal, record.uv, width);
 }
 
 Vec3 SmoothObject::tbn_transform (Vec3 point, Vec3 tangent_v)
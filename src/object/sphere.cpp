@@ -55,33 +55,63 @@ Vec3 Sphere::normal (Vec3 point)
         return (point - this->location).unit ();
 }
 
+/**
+        A moving sphere is intersected in its time 0 frame: the ray is moved
+        back by the sphere's offset at the ray's time, so that normals and
+        texture coordinates are computed about the sphere's location.
+ */
 bool Sphere::hit (Ray r, HitRecord &record)
 {
-        double a = r.direction.dot (r.direction);
-        double b = r.direction.dot (r.origin - this->location) * 2.0;
-        double c = (this->location - r.origin).dot (this->location - r.origin) - this->radius * this->radius;
+        Vec3 motion = this->displacement.direction;
+
+        // ray origin relative to the center at the ray's time, spelled out like the BVH's lanes
+        double ox = r.origin[0] - motion[0] * r.time - this->location[0];
+        double oy = r.origin[1] - motion[1] * r.time - this->location[1];
+        double oz = r.origin[2] - motion[2] * r.time - this->location[2];
 
-        double discriminant = difference_of_products (b, b, 4 * a, c);
+        double lambda;
 
-        if (discriminant < 0)
+        if (!Sphere::intersect (ox, oy, oz, r.direction[0], r.direction[1], r.direction[2], this->radius, lambda))
                 return false;
 
-        record.lambda = (-b - std::sqrt (discriminant)) / (2 * a);
+        this->hit_record (r, lambda, record);
+        return true;
+}
 
-        if (record.lambda < 0) {
-                record.lambda = (-b + sqrt (discriminant)) / (2 * a);
+/**
+        Fills in record for the hit at lambda, found by hit or by the BVH.
+ */
+void Sphere::hit_record (Ray r, double lambda, HitRecord &record)
+{
+        Vec3 offset = this->motion_offset (r.time);
 
-                if (record.lambda < 0)
-                        return false;
-        }
+        r.origin -= offset;
 
+        record.lambda = lambda;
         record.hit_point = r.at (record.lambda);
         record.setNormal (r, this->mapped_normal (record.hit_point));
         record.uv = this->to_uv (record.hit_point);
         record.object = this;
+        record.hit_point += offset;
+        record.time = r.time;
+}
+
+bool Sphere::bounds (double time, Vec3 &min, Vec3 &max)
+{
+        Vec3 center = this->location + this->motion_offset (time);
+        Vec3 extent (this->radius, this->radius, this->radius);
+
+        min = center - extent;
+        max = center + extent;
+
         return true;
 }
 
+Object::Primitive Sphere::primitive ()
+{
+        return Primitive::Sphere;
+}
+
 double Sphere::argument (double y_opp, double x_adj)
 {
         double arg = std::atan2 (y_opp, x_adj);
@@ -3,6 +3,7 @@
 #include "material.hpp"
 #include "ray.hpp"
 #include "smooth_object.hpp"
+#include "stats.hpp"
 #include "utils.hpp"
 #include "vec3.hpp"
 #include <vector>
@@ -85,6 +86,8 @@ bool Triangle::hit (Ray r, HitRecord &record)
 {
         double alpha, beta, lambda;
 
+        STATS_ADD (triangle_tests, 1);
+
         if (!hit_box (this->location, this->_u (), this->_v (), 1, 1, r, alpha, beta, lambda))
                 return false;
 
@@ -99,6 +102,8 @@ bool Triangle::hit (Ray r, HitRecord &record)
         record.setNormal (r, this->mapped_normal (record.hit_point));
         record.object = this;
 
+        STATS_ADD (triangle_hits, 1);
+
         return true;
 }
 
@@ -161,4 +166,12 @@ Triangle *Triangle::scale (double s)
         this->p3 *= s;
 
         return this;
-}
\ No newline at end of file
+}
+
+bool Triangle::bounds (double, Vec3 &min, Vec3 &max)
+{
+        min = Vec3::min (this->location, Vec3::min (this->p2, this->p3));
+        max = Vec3::max (this->location, Vec3::max (this->p2, this->p3));
+
+        return true;
+}
@@ -0,0 +1,182 @@
+#include "lib/catch_amalgamated.hpp"
+#include "obj.hpp"
+#include "triangle.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// triangle-only assets; assets/sphere.obj has quads, which tinyobjloader splits along a different diagonal
+static const char *assets[] = { "assets/cube.obj", "assets/dragon.obj", "assets/stanford-bunny.obj" };
+
+static bool tinyobj_load (const char *filename, tinyobj::attrib_t &attrib, std::vector<tinyobj::shape_t> &shapes)
+{
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+
+        return tinyobj::LoadObj (&attrib, &shapes, &materials, &warn, &err, filename, NULL, true, true);
+}
+
+static std::string write_temp_obj (const char *contents)
+{
+        std::string filename = "test_obj_" + std::to_string (rand ()) + ".obj";
+        FILE *fp = fopen (filename.c_str (), "w");
+        fputs (contents, fp);
+        fclose (fp);
+
+        return filename;
+}
+
+TEST_CASE ("ObjFile", "")
+{
+        SECTION ("ObjFile matches tinyobjloader on the bundled assets")
+        {
+                for (const char *asset : assets) {
+                        ObjFile obj (asset, 4);
+                        obj.parse ();
+
+                        tinyobj::attrib_t attrib;
+                        std::vector<tinyobj::shape_t> shapes;
+                        REQUIRE (tinyobj_load (asset, attrib, shapes));
+
+                        REQUIRE (obj.vertices.size () * 3 == attrib.vertices.size ());
+                        REQUIRE (obj.normals.size () * 3 == attrib.normals.size ());
+
+                        size_t i = 0;
+                        for (tinyobj::shape_t &shape : shapes)
+                                for (tinyobj::index_t &idx : shape.mesh.indices) {
+                                        REQUIRE (i < obj.indices.size ());
+                                        REQUIRE (obj.indices[i].vertex == idx.vertex_index);
+                                        REQUIRE (obj.indices[i].normal == idx.normal_index);
+                                        REQUIRE (obj.indices[i].texture == idx.texcoord_index);
+                                        i++;
+                                }
+
+                        REQUIRE (i == obj.indices.size ());
+                }
+        }
+
+        SECTION ("ObjFile fan triangulates polygons")
+        {
+                ObjFile obj ("assets/sphere.obj", 4);
+                obj.parse ();
+
+                tinyobj::attrib_t attrib;
+                std::vector<tinyobj::shape_t> shapes;
+                REQUIRE (tinyobj_load ("assets/sphere.obj", attrib, shapes));
+
+                REQUIRE (obj.vertices.size () * 3 == attrib.vertices.size ());
+                REQUIRE (obj.texcoords.size () * 2 == attrib.texcoords.size ());
+                REQUIRE (obj.indices.size () == shapes[0].mesh.indices.size ());
+        }
+
+        SECTION ("ObjFile parses exponents, signs and relative indices")
+        {
+                std::string filename = write_temp_obj ("# comment\n"
+                                                       "o thing\r\n"
+                                                       "v -0.5 1e-3 +2.5E2\r\n"
+                                                       "v 1 -.25 0\n"
+                                                       "v 0 0 1\n"
+                                                       "v 1 1 1\n"
+                                                       "vt 0.5 0.25\n"
+                                                       "f -4/1 -3/1 -2/1 -1/1\n");
+
+                ObjFile obj (filename.c_str (), 1);
+                obj.parse ();
+                remove (filename.c_str ());
+
+                REQUIRE (obj.vertices.size () == 4);
+                REQUIRE (obj.vertices[0] == Vec3 (-0.5, 1e-3, 250));
+                REQUIRE (obj.vertices[1] == Vec3 (1, -0.25, 0));
+                REQUIRE (obj.triangle_count () == 2);
+                REQUIRE (obj.indices[0].vertex == 0);
+                REQUIRE (obj.indices[4].vertex == 2);
+                REQUIRE (obj.indices[5].vertex == 3);
+                REQUIRE (obj.indices[5].texture == 0);
+                REQUIRE (obj.indices[5].normal == -1);
+        }
+
+        SECTION ("ObjFile rejects out of range face indices")
+        {
+                std::string filename = write_temp_obj ("v 0 0 0\nv 1 0 0\nf 1 2 3\n");
+
+                ObjFile obj (filename.c_str (), 1);
+                REQUIRE_THROWS (obj.parse ());
+                remove (filename.c_str ());
+        }
+}
+
+TEST_CASE ("ObjFile benchmarks", "[.][benchmark]")
+{
+        BENCHMARK ("ObjFile: assets/stanford-bunny.obj")
+        {
+                ObjFile obj ("assets/stanford-bunny.obj");
+                obj.parse ();
+                return obj.triangle_count ();
+        };
+
+        BENCHMARK ("tinyobjloader: assets/stanford-bunny.obj")
+        {
+                tinyobj::attrib_t attrib;
+                std::vector<tinyobj::shape_t> shapes;
+                tinyobj_load ("assets/stanford-bunny.obj", attrib, shapes);
+                return shapes.size ();
+        };
+
+        BENCHMARK ("ObjFile: assets/dragon.obj")
+        {
+                ObjFile obj ("assets/dragon.obj");
+                obj.parse ();
+                return obj.triangle_count ();
+        };
+
+        BENCHMARK ("tinyobjloader: assets/dragon.obj")
+        {
+                tinyobj::attrib_t attrib;
+                std::vector<tinyobj::shape_t> shapes;
+                tinyobj_load ("assets/dragon.obj", attrib, shapes);
+                return shapes.size ();
+        };
+
+        BENCHMARK ("ObjFile: assets/sphere.obj")
+        {
+                ObjFile obj ("assets/sphere.obj");
+                obj.parse ();
+                return obj.triangle_count ();
+        };
+
+        BENCHMARK ("tinyobjloader: assets/sphere.obj")
+        {
+                tinyobj::attrib_t attrib;
+                std::vector<tinyobj::shape_t> shapes;
+                tinyobj_load ("assets/sphere.obj", attrib, shapes);
+                return shapes.size ();
+        };
+}
+
+TEST_CASE ("load_obj_mesh", "")
+{
+        SECTION ("load_obj_mesh keeps tiny triangles and skips degenerate ones")
+        {
+                // a 10 micron square and a triangle along its bottom edge
+                std::string filename = write_temp_obj ("v 0 0 0\n"
+                                                       "v 1e-5 0 0\n"
+                                                       "v 1e-5 1e-5 0\n"
+                                                       "v 0 1e-5 0\n"
+                                                       "v 2e-5 0 0\n"
+                                                       "f 1 2 3 4\n"
+                                                       "f 1 2 5\n");
+                std::vector<Triangle *> triangles = load_obj_mesh ((char *)filename.c_str (), nullptr);
+                remove (filename.c_str ());
+
+                REQUIRE (triangles.size () == 2);
+
+                for (Triangle *triangle : triangles)
+                        delete triangle;
+        }
+}
@@ -0,0 +1,198 @@
+#include "lib/catch_amalgamated.hpp"
+#include "ply.hpp"
+#include "triangle.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// a unit square in z = 0 as one quad, with normals facing +z
+static const char *ascii_square = "ply\n"
+                                  "format ascii 1.0\n"
+                                  "comment a unit square\n"
+                                  "element vertex 4\n"
+                                  "property float x\n"
+                                  "property float y\n"
+                                  "property float z\n"
+                                  "property float nx\n"
+                                  "property float ny\n"
+                                  "property float nz\n"
+                                  "element face 1\n"
+                                  "property list uchar int vertex_indices\n"
+                                  "end_header\n"
+                                  "0 0 0 0 0 1\n"
+                                  "1 0 0 0 0 1\n"
+                                  "1 1 0 0 0 1\n"
+                                  "0 1 0 0 0 1\n"
+                                  "4 0 1 2 3\n";
+
+static std::string write_temp_ply (std::string contents)
+{
+        std::string filename = "test_ply_" + std::to_string (rand ()) + ".ply";
+        FILE *fp = fopen (filename.c_str (), "wb");
+        fwrite (contents.data (), 1, contents.size (), fp);
+        fclose (fp);
+
+        return filename;
+}
+
+static void append_le (std::string &data, uint32_t bits)
+{
+        for (int byte = 0; byte < 4; byte++)
+                data += char ((bits >> (8 * byte)) & 0xff);
+}
+
+static void append_le (std::string &data, float value)
+{
+        uint32_t bits;
+
+        memcpy (&bits, &value, sizeof (bits));
+        append_le (data, bits);
+}
+
+/**
+        A binary little endian file with the given vertices and one face
+        listing the given indices.
+ */
+static std::string binary_ply (std::vector<float> vertices, std::vector<int> face, const char *face_property)
+{
+        std::string data = "ply\n"
+                           "format binary_little_endian 1.0\n"
+                           "element vertex " +
+                           std::to_string (vertices.size () / 3) +
+                           "\n"
+                           "property float x\n"
+                           "property float y\n"
+                           "property float z\n"
+                           "element face 1\n"
+                           "property list uchar int " +
+                           face_property +
+                           "\n"
+                           "end_header\n";
+
+        for (float value : vertices)
+                append_le (data, value);
+
+        data += char (face.size ());
+
+        for (int index : face)
+                append_le (data, uint32_t (index));
+
+        return data;
+}
+
+static std::vector<float> pentagon = { 0, 0, 0, 1, 0, 0, 1.5, 1, 0, 0.5, 1.5, 0, -0.5, 1, 0 };
+
+TEST_CASE ("PlyFile", "")
+{
+        SECTION ("PlyFile reads ascii files and fan triangulates quads")
+        {
+                std::string filename = write_temp_ply (ascii_square);
+                PlyFile ply (filename.c_str ());
+                ply.parse ();
+                remove (filename.c_str ());
+
+                REQUIRE (ply.vertex_count () == 4);
+                REQUIRE (ply.has_normals);
+                REQUIRE (ply.vertices == std::vector<double>{ 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0 });
+                REQUIRE (ply.normals[2] == 1);
+                REQUIRE (ply.indices == std::vector<size_t>{ 0, 1, 2, 0, 2, 3 });
+        }
+
+        SECTION ("PlyFile reads binary files and fan triangulates polygons")
+        {
+                std::string filename = write_temp_ply (binary_ply (pentagon, { 0, 1, 2, 3, 4 }, "vertex_indices"));
+                PlyFile ply (filename.c_str ());
+                ply.parse ();
+                remove (filename.c_str ());
+
+                REQUIRE (ply.vertex_count () == 5);
+                REQUIRE (!ply.has_normals);
+                REQUIRE (ply.vertices[6] == 1.5);
+                REQUIRE (ply.vertices[10] == 1.5);
+                REQUIRE (ply.triangle_count () == 3);
+                REQUIRE (ply.indices == std::vector<size_t>{ 0, 1, 2, 0, 2, 3, 0, 3, 4 });
+        }
+
+        SECTION ("PlyFile accepts vertex_index faces")
+        {
+                std::string filename = write_temp_ply (binary_ply (pentagon, { 4, 3, 2 }, "vertex_index"));
+                PlyFile ply (filename.c_str ());
+                ply.parse ();
+                remove (filename.c_str ());
+
+                REQUIRE (ply.indices == std::vector<size_t>{ 4, 3, 2 });
+        }
+
+        SECTION ("PlyFile rejects out of range indices")
+        {
+                for (int index : { 5, -1 }) {
+                        std::string filename =
+                                write_temp_ply (binary_ply (pentagon, { 0, 1, index }, "vertex_indices"));
+                        PlyFile ply (filename.c_str ());
+
+                        REQUIRE_THROWS_AS (ply.parse (), std::runtime_error);
+                        remove (filename.c_str ());
+                }
+        }
+
+        SECTION ("PlyFile rejects faces without vertex_indices or vertex_index")
+        {
+                std::string filename = write_temp_ply (binary_ply (pentagon, { 0, 1, 2 }, "vertex_ids"));
+                PlyFile ply (filename.c_str ());
+
+                REQUIRE_THROWS_AS (ply.parse (), std::runtime_error);
+                remove (filename.c_str ());
+        }
+}
+
+TEST_CASE ("load_ply_mesh", "")
+{
+        SECTION ("load_ply_mesh makes triangles facing the vertex normals")
+        {
+                std::string filename = write_temp_ply (ascii_square);
+                std::vector<Triangle *> triangles = load_ply_mesh ((char *)filename.c_str (), nullptr);
+                remove (filename.c_str ());
+
+                REQUIRE (triangles.size () == 2);
+
+                for (Triangle *triangle : triangles) {
+                        REQUIRE (triangle->normal (Vec3 (0.5, 0.5, 0))[2] == Catch::Approx (1));
+                        delete triangle;
+                }
+        }
+
+        SECTION ("load_ply_mesh keeps tiny triangles and skips degenerate ones")
+        {
+                // a 10 micron square and a triangle along its bottom edge
+                std::string filename = write_temp_ply ("ply\n"
+                                                       "format ascii 1.0\n"
+                                                       "element vertex 5\n"
+                                                       "property float x\n"
+                                                       "property float y\n"
+                                                       "property float z\n"
+                                                       "element face 2\n"
+                                                       "property list uchar int vertex_indices\n"
+                                                       "end_header\n"
+                                                       "0 0 0\n"
+                                                       "1e-5 0 0\n"
+                                                       "1e-5 1e-5 0\n"
+                                                       "0 1e-5 0\n"
+                                                       "2e-5 0 0\n"
+                                                       "4 0 1 2 3\n"
+                                                       "3 0 1 4\n");
+                std::vector<Triangle *> triangles = load_ply_mesh ((char *)filename.c_str (), nullptr);
+                remove (filename.c_str ());
+
+                REQUIRE (triangles.size () == 2);
+
+                for (Triangle *triangle : triangles)
+                        delete triangle;
+        }
+}
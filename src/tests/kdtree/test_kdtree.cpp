@@ -0,0 +1,76 @@
+#include "lib/catch_amalgamated.hpp"
+#include "hitrecord.hpp"
+#include "kdtree.hpp"
+#include "material.hpp"
+#include "triangle.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+
+#include <cfloat>
+#include <vector>
+
+static bool brute_force_hit (std::vector<Triangle *> &triangles, Ray r, HitRecord &record)
+{
+        bool hit_anything = false;
+        double best_lambda = DBL_MAX;
+
+        for (Triangle *tri : triangles) {
+                HitRecord temp_record;
+
+                if (tri->hit (r, temp_record) && temp_record.lambda < best_lambda) {
+                        record = temp_record;
+                        best_lambda = temp_record.lambda;
+                        hit_anything = true;
+                }
+        }
+
+        return hit_anything;
+}
+
+TEST_CASE ("KDTree", "")
+{
+        Material material (nullptr, nullptr);
+        std::vector<Triangle *> triangles = load_obj_mesh ((char *)"assets/stanford-bunny.obj", &material);
+        Vec3 centroid = compute_mesh_centroid (triangles);
+
+        SECTION ("Parallel and serial builds produce the same tree")
+        {
+                KDTree serial (triangles, 1);
+                KDTree parallel (triangles, 8);
+
+                REQUIRE (serial.stats.nodes == parallel.stats.nodes);
+                REQUIRE (serial.stats.leaves == parallel.stats.leaves);
+                REQUIRE (serial.stats.max_depth == parallel.stats.max_depth);
+                REQUIRE (serial.stats.triangle_references == parallel.stats.triangle_references);
+                REQUIRE (serial.stats.triangle_references >= triangles.size ());
+                REQUIRE (serial.memory_usage () == parallel.memory_usage ());
+
+                serial.release ();
+                parallel.release ();
+        }
+
+        SECTION ("KDTree::ray_hit finds the closest triangle")
+        {
+                KDTree kdtree (triangles);
+                KDTree::BoundingBox bounds = kdtree.bounds ();
+                double radius = (bounds.max - bounds.min).length ();
+
+                for (int i = 0; i < 200; i++) {
+                        Vec3 origin = centroid + radius * Vec3::random ();
+                        Ray r (origin, centroid - origin + 0.1 * radius * Vec3::random ());
+                        HitRecord expected, actual;
+
+                        bool hit = brute_force_hit (triangles, r, expected);
+
+                        REQUIRE (kdtree.ray_hit (r, actual) == hit);
+
+                        if (hit)
+                                REQUIRE (actual.lambda == Catch::Approx (expected.lambda));
+                }
+
+                kdtree.release ();
+        }
+
+        for (Triangle *tri : triangles)
+                delete tri;
+}
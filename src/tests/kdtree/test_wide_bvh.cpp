@@ -0,0 +1,175 @@
+#include "lib/catch_amalgamated.hpp"
+#include "hitrecord.hpp"
+#include "kdtree.hpp"
+#include "material.hpp"
+#include "mesh.hpp"
+#include "triangle.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include "wide_bvh.hpp"
+
+#include <cfloat>
+#include <vector>
+
+static bool brute_force_hit (std::vector<Triangle *> &triangles, Ray r, HitRecord &record)
+{
+        bool hit_anything = false;
+        double best_lambda = DBL_MAX;
+
+        for (Triangle *tri : triangles) {
+                HitRecord temp_record;
+
+                if (tri->hit (r, temp_record) && temp_record.lambda < best_lambda) {
+                        record = temp_record;
+                        best_lambda = temp_record.lambda;
+                        hit_anything = true;
+                }
+        }
+
+        return hit_anything;
+}
+
+template <int N> static void check_against_brute_force (std::vector<Triangle *> &triangles, Vec3 centroid)
+{
+        WideBVH<N> bvh (triangles);
+
+        REQUIRE (bvh.triangles.size () == triangles.size ());
+        REQUIRE (bvh.stats.leaves > 0);
+
+        double radius = 0;
+
+        for (Triangle *tri : triangles)
+                for (Vec3 v : tri->verticies ())
+                        radius = std::max (radius, (v - centroid).length ());
+
+        for (int i = 0; i < 500; i++) {
+                Vec3 origin = centroid + 2 * radius * Vec3::random ();
+                Ray r (origin, centroid - origin + 0.2 * radius * Vec3::random ());
+                HitRecord expected, actual;
+
+                bool hit = brute_force_hit (triangles, r, expected);
+
+                REQUIRE (bvh.ray_hit (r, actual) == hit);
+
+                if (hit) {
+                        REQUIRE (actual.lambda == Catch::Approx (expected.lambda));
+                        REQUIRE (actual.object == expected.object);
+                }
+        }
+
+        // rays starting inside the mesh
+        for (int i = 0; i < 500; i++) {
+                Ray r (centroid + 0.1 * radius * Vec3::random (), Vec3::random ());
+                HitRecord expected, actual;
+
+                bool hit = brute_force_hit (triangles, r, expected);
+
+                REQUIRE (bvh.ray_hit (r, actual) == hit);
+
+                if (hit)
+                        REQUIRE (actual.lambda == Catch::Approx (expected.lambda));
+        }
+}
+
+TEST_CASE ("WideBVH", "")
+{
+        Material material (nullptr, nullptr);
+        std::vector<Triangle *> triangles = load_obj_mesh ((char *)"assets/stanford-bunny.obj", &material);
+        Vec3 centroid = compute_mesh_centroid (triangles);
+
+        SECTION ("WideBVH<4>::ray_hit finds the closest triangle")
+        {
+                check_against_brute_force<4> (triangles, centroid);
+        }
+
+        SECTION ("WideBVH<8>::ray_hit finds the closest triangle")
+        {
+                check_against_brute_force<8> (triangles, centroid);
+        }
+
+        SECTION ("An empty WideBVH hits nothing")
+        {
+                WideBVH<4> bvh;
+                HitRecord record;
+
+                REQUIRE_FALSE (bvh.ray_hit (Ray (Vec3 (0, 0, 0), Vec3 (0, 0, 1)), record));
+        }
+
+        SECTION ("Meshes keep intersecting through the accelerator they were built with")
+        {
+                Mesh::accelerator = Mesh::Accelerator::BVH8;
+                Mesh bvh8 ("assets/cube.obj", Vec3 (0, 0, 0), 1, &material);
+                Mesh::accelerator = Mesh::Accelerator::KDTree;
+                Mesh kdtree ("assets/cube.obj", Vec3 (0, 0, 0), 1, &material);
+
+                Ray r (Vec3 (0.1, 0.2, 5), Vec3 (0, 0, -1));
+                HitRecord expected, actual;
+
+                REQUIRE (kdtree.hit (r, expected));
+                REQUIRE (bvh8.hit (r, actual));
+                REQUIRE (actual.lambda == Catch::Approx (expected.lambda));
+                REQUIRE (bvh8.build_seconds () > 0);
+        }
+
+        for (Triangle *tri : triangles)
+                delete tri;
+}
+
+TEST_CASE ("Mesh accelerator benchmarks", "[.][benchmark]")
+{
+        Material material (nullptr, nullptr);
+        std::vector<Triangle *> triangles = load_obj_mesh ((char *)"assets/stanford-bunny.obj", &material);
+        Vec3 centroid = compute_mesh_centroid (triangles);
+
+        KDTree kdtree (triangles);
+        WideBVH<4> bvh4 (triangles);
+        WideBVH<8> bvh8 (triangles);
+
+        KDTree::BoundingBox bounds = kdtree.bounds ();
+        double radius = (bounds.max - bounds.min).length ();
+
+        std::vector<Ray> rays;
+
+        for (int i = 0; i < 1000; i++) {
+                Vec3 origin = centroid + radius * Vec3::random ();
+                rays.push_back (Ray (origin, centroid - origin + 0.2 * radius * Vec3::random ()));
+        }
+
+        BENCHMARK ("KDTree::ray_hit")
+        {
+                int hits = 0;
+                HitRecord record;
+
+                for (Ray &r : rays)
+                        hits += kdtree.ray_hit (r, record);
+
+                return hits;
+        };
+
+        BENCHMARK ("WideBVH<4>::ray_hit")
+        {
+                int hits = 0;
+                HitRecord record;
+
+                for (Ray &r : rays)
+                        hits += bvh4.ray_hit (r, record);
+
+                return hits;
+        };
+
+        BENCHMARK ("WideBVH<8>::ray_hit")
+        {
+                int hits = 0;
+                HitRecord record;
+
+                for (Ray &r : rays)
+                        hits += bvh8.ray_hit (r, record);
+
+                return hits;
+        };
+
+        kdtree.release ();
+
+        for (Triangle *tri : triangles)
+                delete tri;
+}
@@ -0,0 +1,117 @@
+#include "lib/catch_amalgamated.hpp"
+#include "distribution.hpp"
+#include "environment_light.hpp"
+#include "texture.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+
+#include <cmath>
+#include <vector>
+
+// dim sky with a bright sun at uv (0.25, 0.3)
+class SunTexture : public Texture {
+    public:
+        Vec3 read_texture_uv (Vec3 uv, Vec3) override
+        {
+                bool sun = std::fabs (uv[0] - 0.25) < 0.02 && std::fabs (uv[1] - 0.3) < 0.02;
+
+                return sun ? Vec3 (1000, 1000, 1000) : Vec3 (0.01, 0.01, 0.01);
+        }
+
+        Vec3 read_rgb255 (Vec3 uv) override
+        {
+                return this->read_texture_uv (uv, uv) * 255;
+        }
+
+        Vec3 photon_map (Vec3) override
+        {
+                return Vec3 (0, 0, 0);
+        }
+};
+
+TEST_CASE ("Distribution", "")
+{
+        SECTION ("Distribution1D samples proportionally to the function")
+        {
+                Distribution1D distribution (std::vector<double>{ 0, 1, 3, 0 });
+                std::vector<int> counts (4, 0);
+
+                for (int i = 0; i < 10000; i++) {
+                        double pdf;
+                        int offset;
+                        double x = distribution.sample (random_double (0, 1), pdf, offset);
+
+                        REQUIRE (int (x * 4) == offset);
+                        REQUIRE (pdf == Catch::Approx (distribution.pdf (x)));
+                        counts[offset]++;
+                }
+
+                REQUIRE (counts[0] == 0);
+                REQUIRE (counts[3] == 0);
+                REQUIRE (counts[2] == Catch::Approx (3 * counts[1]).epsilon (0.1));
+        }
+
+        SECTION ("An all-zero function is sampled uniformly")
+        {
+                Distribution1D distribution (std::vector<double> (8, 0));
+                double pdf;
+                int offset;
+
+                distribution.sample (0.7, pdf, offset);
+
+                REQUIRE (offset == 5);
+                REQUIRE (pdf == 1);
+        }
+}
+
+TEST_CASE ("EnvironmentLight", "")
+{
+        SunTexture texture;
+        EnvironmentLight light (&texture, 128, 64);
+
+        SECTION ("Directions and texture coordinates round trip")
+        {
+                Vec3 uv (0.3, 0.7, 0);
+                Vec3 back = EnvironmentLight::to_uv (EnvironmentLight::to_direction (uv));
+
+                REQUIRE (back[0] == Catch::Approx (uv[0]));
+                REQUIRE (back[1] == Catch::Approx (uv[1]));
+        }
+
+        SECTION ("The pdf integrates to one over the sphere")
+        {
+                int nu = 1024, nv = 512;
+                double sum = 0;
+
+                // midpoint rule over uv, d(solid angle) = 2 PI^2 sin(phi) du dv
+                for (int v = 0; v < nv; v++)
+                        for (int u = 0; u < nu; u++) {
+                                Vec3 uv ((u + 0.5) / nu, (v + 0.5) / nv, 0);
+                                double sin_phi = std::sin (M_PI * uv[1]);
+
+                                sum += light.pdf (EnvironmentLight::to_direction (uv)) * 2 * M_PI * M_PI * sin_phi /
+                                       (double (nu) * nv);
+                        }
+
+                REQUIRE (sum == Catch::Approx (1).epsilon (0.01));
+        }
+
+        SECTION ("Most samples go towards the sun, with matching pdfs")
+        {
+                int sun = 0;
+
+                for (int i = 0; i < 1000; i++) {
+                        Vec3 direction;
+                        double pdf;
+                        Vec3 radiance = light.sample (direction, pdf);
+
+                        REQUIRE (pdf == Catch::Approx (light.pdf (direction)).epsilon (1e-3));
+                        REQUIRE (radiance == light.radiance (direction));
+
+                        if (radiance[0] > 1)
+                                sun++;
+                }
+
+                REQUIRE (sun > 800);
+        }
+}
@@ -0,0 +1,68 @@
+#include "lib/catch_amalgamated.hpp"
+#include "dielectric.hpp"
+#include "hitrecord.hpp"
+#include "lambertian.hpp"
+#include "material.hpp"
+#include "material_table.hpp"
+#include "metal.hpp"
+#include "vec3.hpp"
+
+// lambertian.cpp reads the renderer settings
+#include "camera.hpp"
+Camera::RendererSettings config;
+
+class Red : public Material {
+    public:
+        Red () : Material (nullptr, nullptr)
+        {
+        }
+
+        Vec3 color (HitRecord &) override
+        {
+                return Vec3 (1, 0, 0);
+        }
+};
+
+TEST_CASE ("MaterialTable", "")
+{
+        SECTION ("Materials are registered with their type and emission")
+        {
+                Lambertian light (Vec3 (1, 1, 1));
+                Metal metal (0, Vec3 (0.5, 0.5, 0.5));
+                Dielectric glass (1.5, 0);
+
+                REQUIRE (MaterialTable::get (light.id).type == MaterialType::Lambertian);
+                REQUIRE (MaterialTable::get (metal.id).type == MaterialType::Metal);
+                REQUIRE (MaterialTable::get (glass.id).type == MaterialType::Dielectric);
+                REQUIRE (MaterialTable::get (metal.id).material == &metal);
+
+                REQUIRE_FALSE (MaterialTable::get (light.id).emissive);
+                light.emission (Vec3 (5, 5, 5));
+                REQUIRE (MaterialTable::get (light.id).emissive);
+                REQUIRE (MaterialTable::get (light.id).emission == Vec3 (5, 5, 5));
+        }
+
+        SECTION ("Ids of destroyed materials are reused")
+        {
+                uint32_t id;
+
+                {
+                        Material material (nullptr, nullptr);
+                        id = material.id;
+                }
+
+                Material material (nullptr, nullptr);
+
+                REQUIRE (material.id == id);
+                REQUIRE (MaterialTable::get (id).type == MaterialType::Generic);
+        }
+
+        SECTION ("Materials without a case of their own go through their virtual methods")
+        {
+                Red red;
+                HitRecord record;
+
+                REQUIRE (MaterialTable::get (red.id).type == MaterialType::Generic);
+                REQUIRE (MaterialTable::get (red.id).color (record) == Vec3 (1, 0, 0));
+        }
+}
@@ -0,0 +1,243 @@
+#include "lib/catch_amalgamated.hpp"
+#include "merl.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+/**
+        Index computation of MERL's reference code (spherical coordinates and
+        axis-angle rotations), to check the vector based one against.
+ */
+static void rotate_vector (const double *vector, const double *axis, double angle, double *out)
+{
+        double cos_ang = cos (angle), sin_ang = sin (angle);
+        double temp = (axis[0] * vector[0] + axis[1] * vector[1] + axis[2] * vector[2]) * (1.0 - cos_ang);
+        double cross[3] = { axis[1] * vector[2] - axis[2] * vector[1], axis[2] * vector[0] - axis[0] * vector[2],
+                            axis[0] * vector[1] - axis[1] * vector[0] };
+
+        for (int i = 0; i < 3; i++)
+                out[i] = vector[i] * cos_ang + axis[i] * temp + cross[i] * sin_ang;
+}
+
+static size_t reference_index (double theta_in, double fi_in, double theta_out, double fi_out)
+{
+        double in[3] = { sin (theta_in) * cos (fi_in), sin (theta_in) * sin (fi_in), cos (theta_in) };
+        double out[3] = { sin (theta_out) * cos (fi_out), sin (theta_out) * sin (fi_out), cos (theta_out) };
+        double half[3] = { (in[0] + out[0]) / 2, (in[1] + out[1]) / 2, (in[2] + out[2]) / 2 };
+        double length = sqrt (half[0] * half[0] + half[1] * half[1] + half[2] * half[2]);
+
+        for (double &h : half)
+                h /= length;
+
+        double theta_half = acos (half[2]), fi_half = atan2 (half[1], half[0]);
+        double bi_normal[3] = { 0, 1, 0 }, normal[3] = { 0, 0, 1 }, temp[3], diff[3];
+
+        rotate_vector (in, normal, -fi_half, temp);
+        rotate_vector (temp, bi_normal, -theta_half, diff);
+
+        double theta_diff = acos (diff[2]), fi_diff = atan2 (diff[1], diff[0]);
+
+        if (fi_diff < 0)
+                fi_diff += M_PI;
+
+        int h = theta_half <= 0 ? 0 : int (sqrt (theta_half / (M_PI / 2) * MERL_THETA_H * MERL_THETA_H));
+        int d = int (theta_diff / (M_PI / 2) * MERL_THETA_D);
+        int p = int (fi_diff / M_PI * MERL_PHI_D);
+
+        h = std::clamp (h, 0, MERL_THETA_H - 1);
+        d = std::clamp (d, 0, MERL_THETA_D - 1);
+        p = std::clamp (p, 0, MERL_PHI_D - 1);
+
+        return p + d * MERL_PHI_D + h * MERL_PHI_D * MERL_THETA_D;
+}
+
+static Vec3 direction (double theta, double phi)
+{
+        return Vec3 (sin (theta) * cos (phi), sin (theta) * sin (phi), cos (theta));
+}
+
+// glossy synthetic material: bright near the mirror direction, dimmer for blue
+static std::vector<double> synthetic_planes ()
+{
+        std::vector<double> planes (3 * size_t (MERL_SAMPLES));
+
+        for (size_t i = 0; i < MERL_SAMPLES; i++) {
+                double theta_half = i / (MERL_PHI_D * MERL_THETA_D);
+
+                for (int c = 0; c < 3; c++)
+                        planes[c * size_t (MERL_SAMPLES) + i] = 1500 * (0.2 + 50 * std::exp (-theta_half / 4)) / (c + 1);
+        }
+
+        // a missing measurement
+        planes[7] = -1;
+
+        return planes;
+}
+
+TEST_CASE ("MerlBRDF", "")
+{
+        std::vector<double> planes = synthetic_planes ();
+        MerlBRDF merl (planes.data ());
+
+        SECTION ("Table cells match MERL's reference code")
+        {
+                int mismatches = 0, n = 100000;
+
+                for (int i = 0; i < n; i++) {
+                        double theta_in = random_double (0, M_PI / 2), fi_in = random_double (0, 2 * M_PI);
+                        double theta_out = random_double (0, M_PI / 2), fi_out = random_double (0, 2 * M_PI);
+
+                        size_t expected = reference_index (theta_in, fi_in, theta_out, fi_out);
+
+                        if (MerlBRDF::index (direction (theta_in, fi_in), direction (theta_out, fi_out)) != expected)
+                                mismatches++;
+                }
+
+                // only rounding right at cell boundaries may differ
+                REQUIRE (mismatches < n / 1000);
+        }
+
+        SECTION ("Values are interleaved, scaled and never negative")
+        {
+                REQUIRE (merl.rgb[3 * 100] == Catch::Approx (planes[100] / 1500));
+                REQUIRE (merl.rgb[3 * 100 + 1] == Catch::Approx (planes[MERL_SAMPLES + 100] * 1.15 / 1500));
+                REQUIRE (merl.rgb[3 * 100 + 2] == Catch::Approx (planes[2 * MERL_SAMPLES + 100] * 1.66 / 1500));
+                REQUIRE (merl.rgb[3 * 7] == 0);
+        }
+
+        SECTION ("Sampling pdfs are consistent and integrate to one")
+        {
+                for (double theta_in : { 0.1, 0.7, 1.4 }) {
+                        Vec3 in = direction (theta_in, 0.3);
+
+                        for (int i = 0; i < 1000; i++) {
+                                Vec3 out;
+                                double pdf;
+                                Vec3 f = merl.sample (in, out, pdf);
+
+                                REQUIRE (out[2] >= 0);
+                                REQUIRE (f == merl.eval (in, out));
+                                REQUIRE (pdf == Catch::Approx (merl.pdf (in, out)).epsilon (1e-3));
+                        }
+
+                        int nt = 256, np = 512;
+                        double sum = 0;
+
+                        for (int t = 0; t < nt; t++)
+                                for (int p = 0; p < np; p++) {
+                                        double theta = (t + 0.5) / nt * M_PI / 2, phi = (p + 0.5) / np * 2 * M_PI;
+
+                                        sum += merl.pdf (in, direction (theta, phi)) * sin (theta) * (M_PI / 2 / nt) *
+                                               (2 * M_PI / np);
+                                }
+
+                        REQUIRE (sum == Catch::Approx (1).epsilon (0.01));
+                }
+        }
+}
+
+static std::string write_binary (std::vector<double> &planes, size_t count)
+{
+        std::string filename = "test_merl_" + std::to_string (rand ()) + ".binary";
+        int dims[3] = { MERL_THETA_H, MERL_THETA_D, MERL_PHI_D };
+        FILE *fp = fopen (filename.c_str (), "wb");
+
+        fwrite (dims, sizeof (int), 3, fp);
+        fwrite (planes.data (), sizeof (double), count, fp);
+        fclose (fp);
+
+        return filename;
+}
+
+TEST_CASE ("MerlBRDF::load", "")
+{
+        std::vector<double> planes = synthetic_planes ();
+        std::string filename = write_binary (planes, planes.size ());
+
+        SECTION ("Files are loaded once and shared")
+        {
+                std::shared_ptr<MerlBRDF> a = MerlBRDF::load (filename.c_str ());
+                std::shared_ptr<MerlBRDF> b = MerlBRDF::load (("./" + filename).c_str ());
+
+                REQUIRE (a == b);
+                REQUIRE (a->rgb[3 * 100] == Catch::Approx (planes[100] / 1500));
+        }
+
+        SECTION ("Converted tables are cached and mapped by later loads")
+        {
+                std::string directory = "test_merl_cache_" + std::to_string (rand ());
+                mkdir (directory.c_str (), 0755);
+                MerlBRDF::cache_directory = directory.c_str ();
+
+                std::vector<float> converted;
+
+                {
+                        std::shared_ptr<MerlBRDF> first = MerlBRDF::load (filename.c_str ());
+                        converted.assign (first->rgb, first->rgb + 3 * size_t (MERL_SAMPLES));
+                }
+
+                std::shared_ptr<MerlBRDF> cached = MerlBRDF::load (filename.c_str ());
+
+                for (size_t i = 0; i < converted.size (); i += 997)
+                        REQUIRE (cached->rgb[i] == converted[i]);
+
+                MerlBRDF::cache_directory = nullptr;
+                cached.reset ();
+
+                std::string command = "rm -r " + directory;
+                REQUIRE (system (command.c_str ()) == 0);
+        }
+
+        SECTION ("Truncated and missing files are rejected")
+        {
+                std::string truncated = write_binary (planes, planes.size () - 1);
+
+                REQUIRE_THROWS (MerlBRDF::load (truncated.c_str ()));
+                REQUIRE_THROWS (MerlBRDF::load ("does_not_exist.binary"));
+                remove (truncated.c_str ());
+        }
+
+        remove (filename.c_str ());
+}
+
+TEST_CASE ("MerlBRDF benchmarks", "[.][benchmark]")
+{
+        std::vector<double> planes = synthetic_planes ();
+        MerlBRDF merl (planes.data ());
+        std::vector<Vec3> directions;
+
+        for (int i = 0; i < 2048; i++)
+                directions.push_back (direction (random_double (0, M_PI / 2), random_double (0, 2 * M_PI)));
+
+        BENCHMARK ("reference lookup")
+        {
+                double sum = 0;
+
+                for (size_t i = 0; i + 1 < directions.size (); i++) {
+                        Vec3 in = directions[i], out = directions[i + 1];
+                        size_t index = reference_index (acos (in[2]), atan2 (in[1], in[0]), acos (out[2]),
+                                                        atan2 (out[1], out[0]));
+
+                        sum += planes[index] + planes[index + MERL_SAMPLES] + planes[index + 2 * MERL_SAMPLES];
+                }
+
+                return sum;
+        };
+
+        BENCHMARK ("MerlBRDF::eval")
+        {
+                double sum = 0;
+
+                for (size_t i = 0; i + 1 < directions.size (); i++)
+                        sum += merl.eval (directions[i], directions[i + 1])[0];
+
+                return sum;
+        };
+}
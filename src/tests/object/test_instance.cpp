@@ -0,0 +1,50 @@
+#include "lib/catch_amalgamated.hpp"
+#include "hitrecord.hpp"
+#include "instance.hpp"
+#include "material.hpp"
+#include "sphere.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+
+TEST_CASE ("Instance hit", "")
+{
+        Material material (nullptr, nullptr);
+        Sphere sphere (Vec3 (0, 0, 0), 1, &material);
+
+        SECTION ("Instance::hit transforms the ray into object space")
+        {
+                Instance instance (&sphere, Vec3 (5, 0, 0), 2);
+                Ray r (Vec3 (5, 0, 10), Vec3 (0, 0, -1));
+                HitRecord record;
+
+                REQUIRE (instance.hit (r, record));
+                REQUIRE (nearlyEqual (record.lambda, 8));
+                REQUIRE ((record.hit_point - Vec3 (5, 0, 2)).near_zero ());
+                REQUIRE ((record.normal - Vec3 (0, 0, 1)).near_zero ());
+                REQUIRE (record.instance == &instance);
+        }
+
+        SECTION ("Instance::hit returns false if ray misses the transformed object")
+        {
+                Instance instance (&sphere, Vec3 (5, 0, 0), 2);
+                Ray r (Vec3 (0, 0, 10), Vec3 (0, 0, -1));
+                HitRecord record;
+
+                REQUIRE (!instance.hit (r, record));
+        }
+
+        SECTION ("Rotated instances rotate normals")
+        {
+                Instance instance (&sphere);
+                instance.translate (Vec3 (3, 0, 0))->rotate (rotateY (90));
+
+                Vec3 center = instance.location;
+                Ray r (center + Vec3 (0, 10, 0), Vec3 (0, -1, 0));
+                HitRecord record;
+
+                REQUIRE (instance.hit (r, record));
+                REQUIRE (nearlyEqual (record.lambda, 9));
+                REQUIRE ((record.normal - Vec3 (0, 1, 0)).near_zero ());
+                REQUIRE ((instance.to_object_point (center) - Vec3 (0, 0, 0)).near_zero ());
+        }
+}
@@ -0,0 +1,424 @@
+#include "lib/catch_amalgamated.hpp"
+#include "hitrecord.hpp"
+#include "kdtree.hpp"
+#include "mat3.hpp"
+#include "material.hpp"
+#include "quad.hpp"
+#include "ray.hpp"
+#include "sphere.hpp"
+#include "triangle.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include "wide_bvh.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define KERNEL_HAS_CYCLES 1
+#endif
+
+// rays per set, every kernel is timed over a whole set
+#define KERNEL_RAYS 4096
+// a set is run for at least this long per repetition, the fastest repetition is reported
+#define KERNEL_MIN_SECONDS 0.05
+#define KERNEL_REPETITIONS 5
+
+/**
+        Microbenchmarks of the intersection kernels and acceleration
+        structures. They are hidden, run them with:
+
+                $ ./bin/test_kernels "[benchmark]"
+
+        Each kernel runs over a set of incoherent rays (origins around the
+        target, aimed at random points of it) and a set of coherent ones
+        (a pinhole camera's grid over the target), both generated up front
+        with a fixed seed. The report is nanoseconds and, on x86, time stamp
+        counter cycles per ray (or per operation for Vec3 and Mat3).
+
+        The untagged test case runs with the other tests and checks that
+        the kernels find the same hits over the same rays as a textbook
+        reference, or as testing every triangle for the mesh structures.
+ */
+
+static uint64_t sink;
+
+static uint64_t cycles ()
+{
+#ifdef KERNEL_HAS_CYCLES
+        return __rdtsc ();
+#else
+        return 0;
+#endif
+}
+
+template <typename Kernel> static void measure (const char *name, size_t count, Kernel kernel)
+{
+        double best_ns = 1e300, best_cycles = 1e300;
+
+        for (int r = 0; r < KERNEL_REPETITIONS; r++) {
+                size_t runs = 0;
+                uint64_t start_cycles = cycles ();
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+                double seconds;
+
+                do {
+                        sink += kernel ();
+                        runs++;
+                        seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+                } while (seconds < KERNEL_MIN_SECONDS);
+
+                double n = double (runs) * count;
+
+                best_ns = std::min (best_ns, seconds * 1e9 / n);
+                best_cycles = std::min (best_cycles, (cycles () - start_cycles) / n);
+        }
+
+#ifdef KERNEL_HAS_CYCLES
+        printf ("%-40s %10.2f ns %10.1f cycles\n", name, best_ns, best_cycles);
+#else
+        printf ("%-40s %10.2f ns\n", name, best_ns);
+#endif
+}
+
+// rays from around the box (min, max) towards random points inside it
+static std::vector<Ray> random_rays (Vec3 min, Vec3 max)
+{
+        std::vector<Ray> rays;
+        Vec3 center = (min + max) / 2;
+        double radius = (max - min).length ();
+
+        for (int i = 0; i < KERNEL_RAYS; i++) {
+                Vec3 target (random_double (min[0], max[0]), random_double (min[1], max[1]),
+                             random_double (min[2], max[2]));
+                Vec3 origin = center + 2 * radius * Vec3::random ().unit ();
+
+                rays.push_back (Ray (origin, target - origin));
+        }
+
+        return rays;
+}
+
+// a 64 x 64 grid of rays from one point in front of the box, covering it
+static std::vector<Ray> coherent_rays (Vec3 min, Vec3 max)
+{
+        std::vector<Ray> rays;
+        Vec3 center = (min + max) / 2;
+        double radius = (max - min).length ();
+        Vec3 origin = center + Vec3 (0, 0, 2 * radius);
+
+        for (int j = 0; j < 64; j++)
+                for (int i = 0; i < 64; i++) {
+                        Vec3 target = center + Vec3 ((i / 63.0 - 0.5) * radius, (j / 63.0 - 0.5) * radius, 0);
+
+                        rays.push_back (Ray (origin, target - origin));
+                }
+
+        return rays;
+}
+
+template <typename Hit> static void measure_rays (const char *name, std::vector<Ray> &rays, Hit hit)
+{
+        measure (name, rays.size (), [&] {
+                uint64_t hits = 0;
+
+                for (Ray &r : rays)
+                        hits += hit (r);
+
+                return hits;
+        });
+}
+
+static bool reference_sphere (Ray r, Vec3 center, double radius, double &lambda)
+{
+        Vec3 oc = r.origin - center;
+        double a = r.direction.dot (r.direction), b = oc.dot (r.direction), c = oc.dot (oc) - radius * radius;
+        double discriminant = b * b - a * c;
+
+        if (discriminant < 0)
+                return false;
+
+        lambda = (-b - std::sqrt (discriminant)) / a;
+
+        if (lambda < 0)
+                lambda = (-b + std::sqrt (discriminant)) / a;
+
+        return lambda >= 0;
+}
+
+/**
+        Moller-Trumbore, for the triangle p, p + e1, p + e2 or, if
+        parallelogram is set, the parallelogram spanned by e1 and e2.
+ */
+static bool reference_parallelogram (Ray r, Vec3 p, Vec3 e1, Vec3 e2, bool parallelogram, double &lambda)
+{
+        Vec3 h = r.direction.cross (e2);
+        double det = e1.dot (h);
+
+        if (std::fabs (det) < 1e-12)
+                return false;
+
+        Vec3 t = r.origin - p, q = t.cross (e1);
+        double u = t.dot (h) / det, v = r.direction.dot (q) / det;
+
+        lambda = e2.dot (q) / det;
+
+        if (u < 0 || v < 0 || lambda < 0)
+                return false;
+
+        return parallelogram ? u <= 1 && v <= 1 : u + v <= 1;
+}
+
+static bool reference_box (Ray r, Vec3 min, Vec3 max)
+{
+        double near = -DBL_MAX, far = DBL_MAX;
+
+        for (int i = 0; i < 3; i++) {
+                double a = (min[i] - r.origin[i]) / r.direction[i], b = (max[i] - r.origin[i]) / r.direction[i];
+
+                near = std::max (near, std::min (a, b));
+                far = std::min (far, std::max (a, b));
+        }
+
+        return near <= far && far >= 0;
+}
+
+static bool brute_force_hit (std::vector<Triangle *> &triangles, Ray r, HitRecord &record)
+{
+        bool hit_anything = false;
+
+        for (Triangle *tri : triangles) {
+                HitRecord temp_record;
+
+                if (tri->hit (r, temp_record) && (!hit_anything || temp_record.lambda < record.lambda)) {
+                        record = temp_record;
+                        hit_anything = true;
+                }
+        }
+
+        return hit_anything;
+}
+
+TEST_CASE ("Kernels find the same hits as the reference path", "")
+{
+        std::srand (1);
+
+        Material material (nullptr, nullptr);
+
+        SECTION ("Triangle, Sphere, Quad and bounding box kernels")
+        {
+                Triangle triangle (Vec3 (-1, -1, 0), Vec3 (1, -1, 0), Vec3 (0, 1, 0), Vec3 (0, 0, 1), &material);
+                Sphere sphere (Vec3 (0, 0, 0), 1, &material);
+                Quad quad (Vec3 (-1, -1, 0), Vec3 (2, 0, 0), Vec3 (0, 2, 0), &material);
+                KDTree::BoundingBox box (Vec3 (-1, -1, -1), Vec3 (1, 1, 1));
+
+                std::vector<Ray> rays = random_rays (Vec3 (-1.5, -1.5, -0.5), Vec3 (1.5, 1.5, 0.5));
+                std::vector<Ray> coherent = coherent_rays (Vec3 (-1.5, -1.5, -0.5), Vec3 (1.5, 1.5, 0.5));
+
+                rays.insert (rays.end (), coherent.begin (), coherent.end ());
+
+                for (Ray &r : rays) {
+                        HitRecord record;
+                        double lambda, alpha, beta, near, far;
+
+                        bool hit = reference_sphere (r, Vec3 (0, 0, 0), 1, lambda);
+
+                        REQUIRE (sphere.hit (r, record) == hit);
+
+                        if (hit)
+                                REQUIRE (record.lambda == Catch::Approx (lambda));
+
+                        // Quad::hit also reports hits behind the origin, the callers drop them
+                        hit = reference_parallelogram (r, Vec3 (-1, -1, 0), Vec3 (2, 0, 0), Vec3 (0, 2, 0), true, lambda);
+
+                        REQUIRE ((quad.hit (r, record) && record.lambda >= 0) == hit);
+                        REQUIRE (hit_box (Vec3 (-1, -1, 0), Vec3 (2, 0, 0), Vec3 (0, 2, 0), 1, 1, r, alpha, beta,
+                                          near) == hit);
+
+                        if (hit) {
+                                REQUIRE (record.lambda == Catch::Approx (lambda));
+                                REQUIRE (near == Catch::Approx (lambda));
+                        }
+
+                        hit = reference_parallelogram (r, Vec3 (-1, -1, 0), Vec3 (2, 0, 0), Vec3 (1, 2, 0), false, lambda);
+
+                        REQUIRE (triangle.hit (r, record) == hit);
+
+                        if (hit)
+                                REQUIRE (record.lambda == Catch::Approx (lambda));
+
+                        REQUIRE (box.hit (r, near, far) == reference_box (r, box.min, box.max));
+                }
+        }
+
+        SECTION ("Mesh acceleration structures")
+        {
+                std::vector<Triangle *> triangles =
+                        load_obj_mesh ((char *)"assets/stanford-bunny.obj", &material);
+
+                KDTree kdtree (triangles);
+                WideBVH<4> bvh4 (triangles);
+                WideBVH<8> bvh8 (triangles);
+
+                KDTree::BoundingBox bounds = kdtree.bounds ();
+                std::vector<Ray> incoherent = random_rays (bounds.min, bounds.max);
+                std::vector<Ray> coherent = coherent_rays (bounds.min, bounds.max);
+
+                // every 64th ray of both sets, testing every triangle is slow
+                for (std::vector<Ray> *rays : { &incoherent, &coherent })
+                        for (size_t i = 0; i < rays->size (); i += 64) {
+                                Ray &r = (*rays)[i];
+                                HitRecord expected, kd_record, bvh4_record, bvh8_record;
+
+                                bool hit = brute_force_hit (triangles, r, expected);
+
+                                REQUIRE (kdtree.ray_hit (r, kd_record) == hit);
+                                REQUIRE (bvh4.ray_hit (r, bvh4_record) == hit);
+                                REQUIRE (bvh8.ray_hit (r, bvh8_record) == hit);
+
+                                if (hit) {
+                                        REQUIRE (kd_record.lambda == Catch::Approx (expected.lambda));
+                                        REQUIRE (bvh4_record.lambda == Catch::Approx (expected.lambda));
+                                        REQUIRE (bvh8_record.lambda == Catch::Approx (expected.lambda));
+                                }
+                        }
+
+                kdtree.release ();
+
+                for (Triangle *tri : triangles)
+                        delete tri;
+        }
+}
+
+TEST_CASE ("Primitive intersection kernels", "[.][benchmark]")
+{
+        std::srand (1);
+
+        Material material (nullptr, nullptr);
+        Triangle triangle (Vec3 (-1, -1, 0), Vec3 (1, -1, 0), Vec3 (0, 1, 0), Vec3 (0, 0, 1), &material);
+        Sphere sphere (Vec3 (0, 0, 0), 1, &material);
+        Quad quad (Vec3 (-1, -1, 0), Vec3 (2, 0, 0), Vec3 (0, 2, 0), &material);
+        KDTree::BoundingBox box (Vec3 (-1, -1, -1), Vec3 (1, 1, 1));
+
+        // aimed at a slightly larger box, so that some rays miss
+        std::vector<Ray> incoherent = random_rays (Vec3 (-1.5, -1.5, -0.5), Vec3 (1.5, 1.5, 0.5));
+        std::vector<Ray> coherent = coherent_rays (Vec3 (-1.5, -1.5, -0.5), Vec3 (1.5, 1.5, 0.5));
+
+        for (std::vector<Ray> *rays : { &incoherent, &coherent }) {
+                printf ("\n%s rays, per ray:\n", rays == &incoherent ? "Incoherent" : "Coherent");
+
+                measure_rays ("Triangle::hit", *rays, [&] (Ray &r) {
+                        HitRecord record;
+                        return triangle.hit (r, record);
+                });
+
+                measure_rays ("Sphere::hit", *rays, [&] (Ray &r) {
+                        HitRecord record;
+                        return sphere.hit (r, record);
+                });
+
+                measure_rays ("Quad::hit", *rays, [&] (Ray &r) {
+                        HitRecord record;
+                        return quad.hit (r, record);
+                });
+
+                measure_rays ("hit_box", *rays, [&] (Ray &r) {
+                        double alpha, beta, lambda;
+                        return hit_box (Vec3 (-1, -1, 0), Vec3 (2, 0, 0), Vec3 (0, 2, 0), 1, 1, r, alpha, beta, lambda);
+                });
+
+                measure_rays ("KDTree::BoundingBox::hit", *rays, [&] (Ray &r) {
+                        double lambda_min, lambda_max;
+                        return box.hit (r, lambda_min, lambda_max);
+                });
+        }
+}
+
+TEST_CASE ("Mesh acceleration structures", "[.][benchmark]")
+{
+        std::srand (1);
+
+        Material material (nullptr, nullptr);
+
+        for (const char *filename : { "assets/stanford-bunny.obj", "assets/dragon.obj" }) {
+                std::vector<Triangle *> triangles = load_obj_mesh ((char *)filename, &material);
+
+                KDTree kdtree (triangles);
+                WideBVH<4> bvh4 (triangles);
+                WideBVH<8> bvh8 (triangles);
+
+                KDTree::BoundingBox bounds = kdtree.bounds ();
+                std::vector<Ray> incoherent = random_rays (bounds.min, bounds.max);
+                std::vector<Ray> coherent = coherent_rays (bounds.min, bounds.max);
+
+                for (std::vector<Ray> *rays : { &incoherent, &coherent }) {
+                        printf ("\n%s, %zu triangles, %s rays, per ray:\n", filename, triangles.size (),
+                                rays == &incoherent ? "incoherent" : "coherent");
+
+                        measure_rays ("KDTree::ray_hit", *rays, [&] (Ray &r) {
+                                HitRecord record;
+                                return kdtree.ray_hit (r, record);
+                        });
+
+                        measure_rays ("WideBVH<4>::ray_hit", *rays, [&] (Ray &r) {
+                                HitRecord record;
+                                return bvh4.ray_hit (r, record);
+                        });
+
+                        measure_rays ("WideBVH<8>::ray_hit", *rays, [&] (Ray &r) {
+                                HitRecord record;
+                                return bvh8.ray_hit (r, record);
+                        });
+                }
+
+                kdtree.release ();
+
+                for (Triangle *tri : triangles)
+                        delete tri;
+        }
+}
+
+TEST_CASE ("Vec3 and Mat3 operations", "[.][benchmark]")
+{
+        std::srand (1);
+
+        std::vector<Vec3> vectors;
+        std::vector<Mat3> matrices;
+
+        for (int i = 0; i < KERNEL_RAYS; i++) {
+                vectors.push_back (Vec3::random ());
+                matrices.push_back (Mat3 (Vec3::random (), Vec3::random (), Vec3::random ()));
+        }
+
+        printf ("\nPer operation:\n");
+
+        // results are summed into an accumulator that is checked, so they are not optimized out
+        auto measure_vectors = [&] (const char *name, auto op) {
+                measure (name, vectors.size (), [&] {
+                        Vec3 sum (0, 0, 0);
+
+                        for (size_t i = 0; i + 1 < vectors.size (); i++)
+                                sum += op (vectors[i], vectors[i + 1], matrices[i]);
+
+                        return uint64_t (sum[0] > 0);
+                });
+        };
+
+        measure_vectors ("Vec3::operator+", [] (Vec3 &a, Vec3 &b, Mat3 &) { return a + b; });
+        measure_vectors ("Vec3::dot", [] (Vec3 &a, Vec3 &b, Mat3 &) { return Vec3 (a.dot (b), 0, 0); });
+        measure_vectors ("Vec3::cross", [] (Vec3 &a, Vec3 &b, Mat3 &) { return a.cross (b); });
+        measure_vectors ("Vec3::unit", [] (Vec3 &a, Vec3 &, Mat3 &) { return a.unit (); });
+        measure_vectors ("Mat3::operator* (Vec3)", [] (Vec3 &a, Vec3 &, Mat3 &m) { return m * a; });
+        measure_vectors ("Mat3::operator* (Mat3)", [] (Vec3 &a, Vec3 &, Mat3 &m) { return (m * m) * a; });
+        measure_vectors ("Mat3::inverse", [] (Vec3 &a, Vec3 &, Mat3 &m) { return m.inverse () * a; });
+
+        // keeps every kernel's result alive
+        CHECK (sink > 0);
+}
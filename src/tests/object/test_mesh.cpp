@@ -2,11 +2,15 @@
 #include "hitrecord.hpp"
 #include "mesh.hpp"
 #include "material.hpp"
+#include <cmath>
+#include <memory>
 TEST_CASE("Mesh hit", "")
 {
+        Material material(nullptr, nullptr);
+
         SECTION("Mesh::hit returns true if ray hits the mesh")
         {
-                Mesh mesh = Mesh("assets/sphere.obj", Vec3(0, 0, 0), nullptr);
+                Mesh mesh = Mesh("assets/sphere.obj", Vec3(0, 0, 0), 1, &material);
                 Ray r = Ray(Vec3(0.5, 0.5, 0.5), Vec3(1, 1, 1));
                 HitRecord record;
                 REQUIRE(mesh.hit(r, record));
@@ -14,9 +18,80 @@ TEST_CASE("Mesh hit", "")
 
         SECTION("Mesh::hit returns false if ray does not hit the mesh")
         {
-                Mesh mesh = Mesh("assets/cube.obj", Vec3(0, 0, 0), nullptr);
+                Mesh mesh = Mesh("assets/cube.obj", Vec3(0, 0, 0), 1, &material);
                 Ray r = Ray(Vec3(-3, -3, -3), Vec3(-1, -1, -1));
                 HitRecord record;
                 REQUIRE(!mesh.hit(r, record));
         }
-}
\ No newline at end of file
+
+        SECTION("Lazily loaded meshes are loaded by the first ray that enters their bounds")
+        {
+                Mesh::lazy_loading = true;
+                Mesh mesh = Mesh("assets/cube.obj", Vec3(0, 0, 0), 1, &material);
+                Mesh::lazy_loading = false;
+
+                HitRecord record;
+                REQUIRE(!mesh.is_resident());
+                REQUIRE(!mesh.hit(Ray(Vec3(-3, -3, -3), Vec3(-1, -1, -1)), record));
+                REQUIRE(!mesh.is_resident());
+                REQUIRE(mesh.hit(Ray(Vec3(0.1, 0.2, 5), Vec3(0, 0, -1)), record));
+                REQUIRE(mesh.is_resident());
+        }
+
+        SECTION("Lazily loaded meshes have the bounds of loaded meshes without reading their triangles")
+        {
+                Mesh loaded = Mesh("assets/stanford-bunny.obj", Vec3(1, 2, 3), 2, &material);
+
+                Mesh::lazy_loading = true;
+                Mesh lazy = Mesh("assets/stanford-bunny.obj", Vec3(1, 2, 3), 2, &material);
+                Mesh::lazy_loading = false;
+
+                REQUIRE(!lazy.is_resident());
+                REQUIRE(lazy.triangle_count == loaded.triangle_count);
+
+                for (int i = 0; i < 3; i++) {
+                        REQUIRE(lazy.bounding_box.min[i] == Catch::Approx(loaded.bounding_box.min[i]).epsilon(1e-12));
+                        REQUIRE(lazy.bounding_box.max[i] == Catch::Approx(loaded.bounding_box.max[i]).epsilon(1e-12));
+                }
+        }
+
+        SECTION("Meshes over the memory budget evict the least recently hit mesh")
+        {
+                Mesh::memory_budget = 1;
+                Mesh cube = Mesh("assets/cube.obj", Vec3(0, 0, 0), 1, &material);
+                Mesh sphere = Mesh("assets/sphere.obj", Vec3(5, 0, 0), 1, &material);
+
+                REQUIRE(!cube.is_resident());
+                REQUIRE(sphere.is_resident());
+
+                HitRecord record;
+                REQUIRE(cube.hit(Ray(Vec3(0.1, 0.2, 5), Vec3(0, 0, -1)), record));
+                REQUIRE(cube.is_resident());
+                REQUIRE(!sphere.is_resident());
+
+                REQUIRE(sphere.hit(Ray(Vec3(5.1, 0.2, 5), Vec3(0, 0, -1)), record));
+                REQUIRE(sphere.is_resident());
+                REQUIRE(!cube.is_resident());
+                Mesh::memory_budget = 0;
+        }
+
+        SECTION("Hits keep the triangles of evicted meshes alive")
+        {
+                Mesh::memory_budget = 1;
+                Mesh cube = Mesh("assets/cube.obj", Vec3(0, 0, 0), 1, &material);
+                Mesh sphere = Mesh("assets/sphere.obj", Vec3(5, 0, 0), 1, &material);
+
+                HitRecord cube_record, sphere_record;
+                REQUIRE(cube.hit(Ray(Vec3(0.1, 0.2, 5), Vec3(0, 0, -1)), cube_record));
+                REQUIRE(sphere.hit(Ray(Vec3(5.1, 0.2, 5), Vec3(0, 0, -1)), sphere_record));
+                REQUIRE(!cube.is_resident());
+
+                std::weak_ptr<void> geometry = cube_record.owner;
+                REQUIRE(!geometry.expired());
+                REQUIRE(std::fabs(cube_record.object->normal(cube_record.hit_point)[2]) == Catch::Approx(1));
+
+                cube_record.owner.reset();
+                REQUIRE(geometry.expired());
+                Mesh::memory_budget = 0;
+        }
+}
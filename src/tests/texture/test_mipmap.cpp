@@ -0,0 +1,100 @@
+#include "lib/catch_amalgamated.hpp"
+#include "mipmap.hpp"
+#include "vec3.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// black and white texel checkerboard
+static std::vector<uint8_t> checkerboard (int width, int height)
+{
+        std::vector<uint8_t> rgb (3 * width * height);
+
+        for (int y = 0; y < height; y++)
+                for (int x = 0; x < width; x++)
+                        for (int c = 0; c < 3; c++)
+                                rgb[3 * (y * width + x) + c] = (x + y) % 2 ? 255 : 0;
+
+        return rgb;
+}
+
+TEST_CASE ("MipMap", "")
+{
+        std::vector<uint8_t> rgb = checkerboard (37, 20);
+        MipMap mipmap (rgb.data (), 37, 20);
+
+        SECTION ("The pyramid goes down to a single texel")
+        {
+                REQUIRE (mipmap.levels.front ().width == 37);
+                REQUIRE (mipmap.levels.back ().width == 1);
+                REQUIRE (mipmap.levels.back ().height == 1);
+                REQUIRE (mipmap.levels[1].width == 18);
+                REQUIRE (mipmap.levels[1].height == 10);
+        }
+
+        SECTION ("Tiled texels match the source image")
+        {
+                for (int y = 0; y < 20; y++)
+                        for (int x = 0; x < 37; x++) {
+                                double expected = (x + y) % 2 ? 1 : 0;
+
+                                REQUIRE (mipmap.texel (0, x, y) == Vec3 (expected, expected, expected));
+                                REQUIRE (mipmap.texel_rgb255 (0, x, y)[0] == 255 * expected);
+                        }
+        }
+
+        SECTION ("Bilinear filtering interpolates between texel centres")
+        {
+                Vec3 centre = mipmap.bilinear (0, Vec3 (1.5 / 37, 0.5 / 20, 0));
+                Vec3 between = mipmap.bilinear (0, Vec3 (2.0 / 37, 0.5 / 20, 0));
+
+                REQUIRE (centre[0] == Catch::Approx (1));
+                REQUIRE (between[0] == Catch::Approx (0.5));
+        }
+
+        SECTION ("Wide footprints average the checkerboard to grey")
+        {
+                Vec3 color = mipmap.trilinear (Vec3 (0.5, 0.5, 0), 1);
+
+                REQUIRE (color[0] == Catch::Approx (0.5).margin (0.05));
+                REQUIRE (mipmap.trilinear (Vec3 (0.5, 0.5, 0), 0) == mipmap.bilinear (0, Vec3 (0.5, 0.5, 0)));
+        }
+
+        SECTION ("Every texel of an odd sized level reaches the next level")
+        {
+                // a white last column of 5 covers 1/5 of both texels of the next level
+                std::vector<uint8_t> stripe (3 * 5 * 2, 0);
+
+                for (int y = 0; y < 2; y++)
+                        for (int c = 0; c < 3; c++)
+                                stripe[3 * (y * 5 + 4) + c] = 255;
+
+                MipMap odd (stripe.data (), 5, 2);
+
+                REQUIRE (odd.levels[1].width == 2);
+                REQUIRE (odd.texel (1, 0, 0)[0] == 0);
+                REQUIRE (odd.texel (1, 1, 0)[0] == Catch::Approx (0.4).margin (0.01));
+                REQUIRE (odd.texel (2, 0, 0)[0] == Catch::Approx (0.2).margin (0.01));
+        }
+
+        SECTION ("Texels decode from the 8-bit tiles to linear colour")
+        {
+                std::vector<uint8_t> grey (3 * 16 * 16, 128);
+                MipMap flat (grey.data (), 16, 16);
+
+                REQUIRE (flat.texel (0, 3, 5)[0] == Catch::Approx ((128 / 255.0) * (128 / 255.0)));
+                REQUIRE (flat.texel_rgb255 (0, 3, 5)[0] == 128);
+        }
+
+        SECTION ("The pyramid is stored in 8 bits, 4/3 of the image")
+        {
+                std::vector<uint8_t> large = checkerboard (256, 256);
+                MipMap big (large.data (), 256, 256);
+                size_t bytes = 0;
+
+                for (MipMap::Level &level : big.levels)
+                        bytes += level.texels.size ();
+
+                REQUIRE (bytes <= 4 * large.size () / 3 + 3 * MIPMAP_TILE_SIZE * MIPMAP_TILE_SIZE * big.levels.size ());
+        }
+}
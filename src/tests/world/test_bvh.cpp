@@ -0,0 +1,161 @@
+#include "lib/catch_amalgamated.hpp"
+#include "bvh.hpp"
+#include "hitrecord.hpp"
+#include "instance.hpp"
+#include "material.hpp"
+#include "plane.hpp"
+#include "quad.hpp"
+#include "sphere.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+
+#include <vector>
+
+TEST_CASE ("BVH", "")
+{
+        Material material (nullptr, nullptr);
+        std::vector<Sphere *> spheres;
+
+        for (int i = 0; i < 200; i++) {
+                Vec3 center (random_double (-10, 10), random_double (-10, 10), random_double (-10, 10));
+                Sphere *sphere = new Sphere (center, random_double (0.1, 0.5), &material);
+
+                // every other sphere moves
+                if (i % 2)
+                        sphere->move_to (center + Vec3 (random_double (-2, 2), random_double (-2, 2), 0));
+
+                spheres.push_back (sphere);
+        }
+
+        SECTION ("World::hit gives the same result with and without the BVH")
+        {
+                World linear, accelerated;
+                Plane floor (Vec3 (0, -20, 0), Vec3 (0, 1, 0), &material);
+
+                for (Sphere *sphere : spheres) {
+                        linear.add (sphere);
+                        accelerated.add (sphere);
+                }
+
+                linear.add (&floor);
+                accelerated.add (&floor);
+                accelerated.build ();
+
+                REQUIRE (accelerated.unbounded.size () == 1);
+
+                for (int i = 0; i < 1000; i++) {
+                        Ray r (Vec3 (0, 0, 30), Vec3::random (), random_double (0, 1));
+                        HitRecord expected, actual;
+
+                        bool hit = linear.hit (r, expected);
+
+                        REQUIRE (accelerated.hit (r, actual) == hit);
+
+                        if (hit) {
+                                REQUIRE (actual.lambda == expected.lambda);
+                                REQUIRE (actual.object == expected.object);
+                        }
+                }
+        }
+
+        SECTION ("A refit BVH matches testing every object")
+        {
+                World linear, accelerated;
+
+                for (Sphere *sphere : spheres) {
+                        linear.add (sphere);
+                        accelerated.add (sphere);
+                }
+
+                accelerated.build ();
+
+                for (Sphere *sphere : spheres)
+                        sphere->place (sphere->location * 0.5, sphere->location * 0.5 + Vec3 (1, 0, 0));
+
+                REQUIRE (accelerated.bvh.refit () < 1);
+
+                for (int i = 0; i < 1000; i++) {
+                        Ray r (Vec3 (0, 0, 30), Vec3::random (), random_double (0, 1));
+                        HitRecord expected, actual;
+
+                        bool hit = linear.hit (r, expected);
+
+                        REQUIRE (accelerated.hit (r, actual) == hit);
+
+                        if (hit)
+                                REQUIRE (actual.object == expected.object);
+                }
+        }
+
+        SECTION ("Leaves of spheres and quads match testing every object")
+        {
+                World linear, accelerated;
+                std::vector<Quad *> quads;
+
+                for (int i = 0; i < 200; i++) {
+                        Vec3 corner (random_double (-10, 10), random_double (-10, 10), random_double (-10, 10));
+                        Quad *quad = new Quad (corner, Vec3::random () * 2, Vec3::random () * 2, &material);
+
+                        quad->one_sided () = i % 3 == 0;
+                        quads.push_back (quad);
+                }
+
+                for (size_t i = 0; i < spheres.size (); i++) {
+                        linear.add (spheres[i]);
+                        linear.add (quads[i]);
+                        accelerated.add (spheres[i]);
+                        accelerated.add (quads[i]);
+                }
+
+                accelerated.build ();
+
+                for (int i = 0; i < 5000; i++) {
+                        Ray r (Vec3 (0, 0, 30), Vec3::random (), random_double (0, 1));
+                        HitRecord expected, actual;
+
+                        bool hit = linear.hit (r, expected);
+
+                        REQUIRE (accelerated.hit (r, actual) == hit);
+
+                        // the leaf lanes are vectorized, -ffast-math may round them differently
+                        if (hit) {
+                                REQUIRE (actual.lambda == Catch::Approx (expected.lambda).epsilon (1e-12));
+                                REQUIRE (actual.object == expected.object);
+                                REQUIRE (actual.material == material.id);
+                        }
+                }
+
+                for (Quad *quad : quads)
+                        delete quad;
+        }
+
+        SECTION ("Moving objects are hit where they are at the ray's time")
+        {
+                Sphere sphere (Vec3 (0, 0, 0), 1, &material);
+                sphere.move_to (Vec3 (4, 0, 0));
+
+                Instance instance (&sphere);
+                instance.translate (Vec3 (0, 10, 0))->move_to (Vec3 (0, 14, 0));
+
+                BVH bvh (std::vector<Object *> ({ &sphere, &instance }));
+                HitRecord record;
+                double lambda_max = 1e9;
+
+                REQUIRE (bvh.hit (Ray (Vec3 (2, 0, 10), Vec3 (0, 0, -1), 0.5), record, 0.001, lambda_max));
+                REQUIRE (record.hit_point[2] == Catch::Approx (1));
+                REQUIRE (record.normal[2] == Catch::Approx (1));
+
+                lambda_max = 1e9;
+                REQUIRE (!bvh.hit (Ray (Vec3 (2, 0, 10), Vec3 (0, 0, -1), 0), record, 0.001, lambda_max));
+
+                // the instance moves up by 4 and its sphere moves right by 4
+                lambda_max = 1e9;
+                REQUIRE (bvh.hit (Ray (Vec3 (4, 14, 10), Vec3 (0, 0, -1), 1), record, 0.001, lambda_max));
+                REQUIRE (record.hit_point[2] == Catch::Approx (1));
+                REQUIRE (record.instance == &instance);
+        }
+
+        for (Sphere *sphere : spheres)
+                delete sphere;
+}
@@ -0,0 +1,93 @@
+#include "lib/catch_amalgamated.hpp"
+#include "hitrecord.hpp"
+#include "instance.hpp"
+#include "material.hpp"
+#include "metal.hpp"
+#include "ray.hpp"
+#include "sphere.hpp"
+#include "vec3.hpp"
+
+static Ray camera_ray (Vec3 origin, Vec3 direction, double spread)
+{
+        Ray r (origin, direction, 0.0);
+
+        r.has_differentials = true;
+        r.rx_origin = origin;
+        r.ry_origin = origin;
+        r.rx_direction = direction + Vec3 (spread, 0, 0);
+        r.ry_direction = direction + Vec3 (0, spread, 0);
+
+        return r;
+}
+
+static double footprint (Object &object, Ray r)
+{
+        HitRecord record;
+
+        REQUIRE (object.hit (r, record));
+        record.differentials (r);
+
+        return record.footprint ();
+}
+
+TEST_CASE ("Ray differentials", "")
+{
+        Material material (nullptr, nullptr);
+        Sphere sphere (Vec3 (0, 0, 0), 1, &material);
+
+        SECTION ("Rays without differentials have no footprint")
+        {
+                HitRecord record;
+                Ray r (Vec3 (0.1, 0.2, 5), Vec3 (0, 0, -1));
+
+                REQUIRE (sphere.hit (r, record));
+                record.differentials (r);
+
+                REQUIRE_FALSE (record.has_differentials);
+                REQUIRE (record.footprint () == 0);
+        }
+
+        SECTION ("The footprint grows with distance and shrinks with the spread")
+        {
+                double near = footprint (sphere, camera_ray (Vec3 (0.1, 0.2, 3), Vec3 (0, 0, -1), 0.01));
+                double far = footprint (sphere, camera_ray (Vec3 (0.1, 0.2, 9), Vec3 (0, 0, -1), 0.01));
+                double narrow = footprint (sphere, camera_ray (Vec3 (0.1, 0.2, 9), Vec3 (0, 0, -1), 0.001));
+
+                REQUIRE (near > 0);
+                REQUIRE (far == Catch::Approx (4 * near).epsilon (0.05));
+                REQUIRE (narrow == Catch::Approx (far / 10).epsilon (0.05));
+        }
+
+        SECTION ("Instances give the same footprint as the transformed object")
+        {
+                Sphere big (Vec3 (0, 0, 0), 2, &material);
+                Instance instance (&sphere, Vec3 (0, 0, 0), 2);
+                Ray r = camera_ray (Vec3 (0.1, 0.2, 6), Vec3 (0, 0, -1), 0.01);
+
+                REQUIRE (footprint (instance, r) == Catch::Approx (footprint (big, r)));
+        }
+
+        SECTION ("Mirror reflections keep and widen the footprint")
+        {
+                Metal mirror (0, Vec3 (1, 1, 1));
+                Ray r = camera_ray (Vec3 (0.1, 0.2, 3), Vec3 (0, 0, -1), 0.01);
+                HitRecord record;
+
+                REQUIRE (sphere.hit (r, record));
+                record.differentials (r);
+
+                Ray reflected (record.hit_point, r.direction.reflect (record.normal).unit ());
+                mirror.differentials (r, record, reflected);
+
+                REQUIRE (reflected.has_differentials);
+
+                // a convex mirror spreads the offset rays further apart
+                Vec3 dx, dy;
+                REQUIRE (reflected.footprint (reflected.at (1), reflected.direction, dx, dy));
+                REQUIRE (dx.length () > record.dpdx.length ());
+
+                Metal fuzzy (0.5, Vec3 (1, 1, 1));
+                fuzzy.differentials (r, record, reflected);
+                REQUIRE_FALSE (reflected.has_differentials);
+        }
+}
@@ -0,0 +1,94 @@
+#include "lib/catch_amalgamated.hpp"
+#include "camera.hpp"
+#include "framebuffer.hpp"
+#include "hitrecord.hpp"
+#include "instance.hpp"
+#include "material.hpp"
+#include "mesh.hpp"
+#include "plane.hpp"
+#include "quad.hpp"
+#include "sphere.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+
+#include <vector>
+
+// lambertian.cpp reads the renderer settings
+Camera::RendererSettings config;
+
+TEST_CASE ("FrameBuffer", "")
+{
+        SECTION ("FrameBuffer::parse reads AOV names and all")
+        {
+                REQUIRE (FrameBuffer::parse ("albedo,id") ==
+                         ((1 << FrameBuffer::Albedo) | (1 << FrameBuffer::ObjectID)));
+                REQUIRE (FrameBuffer::parse ("all") == (1 << FrameBuffer::Count) - 1);
+                REQUIRE (FrameBuffer::parse ("albedo,colour") == -1);
+        }
+
+        SECTION ("AOVs are averaged over the samples, the object ID is that of the first")
+        {
+                FrameBuffer framebuffer (FrameBuffer::parse ("depth,id"), 2, 1, 2);
+                FrameBuffer::Sample first, second;
+
+                first[FrameBuffer::Depth] = Vec3 (1, 1, 1);
+                first[FrameBuffer::ObjectID] = Vec3 (3, 3, 3);
+                second[FrameBuffer::Depth] = Vec3 (3, 3, 3);
+                second[FrameBuffer::ObjectID] = Vec3 (5, 5, 5);
+
+                framebuffer.add (1, 0, first, true);
+                framebuffer.add (1, 0, second, false);
+
+                REQUIRE (framebuffer.buffer (FrameBuffer::Depth)[1][0] == 2);
+                REQUIRE (framebuffer.buffer (FrameBuffer::ObjectID)[1][0] == 3);
+                REQUIRE (framebuffer.buffer (FrameBuffer::ObjectID)[0][0] == 0);
+                REQUIRE (framebuffer.buffer (FrameBuffer::Albedo).empty ());
+        }
+
+        SECTION ("The id AOV is the World object hit, also through the BVH")
+        {
+                Material material (nullptr, nullptr);
+                Sphere sphere (Vec3 (0, 0, 0), 1, &material);
+                Quad quad (Vec3 (3, -1, 0), Vec3 (2, 0, 0), Vec3 (0, 2, 0), &material);
+                Mesh mesh ("assets/cube.obj", Vec3 (8, 0, 0), 1, &material);
+                Instance instance (&sphere, Vec3 (12, 0, 0), 1);
+                Plane floor (Vec3 (0, -20, 0), Vec3 (0, 1, 0), &material);
+
+                std::vector<Object *> objects = { &sphere, &quad, &mesh, &instance, &floor };
+                // straight at each of them, the last one down at the floor
+                std::vector<Ray> rays = { Ray (Vec3 (0.1, 0.2, 10), Vec3 (0, 0, -1)),
+                                          Ray (Vec3 (4.1, 0.2, 10), Vec3 (0, 0, -1)),
+                                          Ray (Vec3 (8.1, 0.2, 10), Vec3 (0, 0, -1)),
+                                          Ray (Vec3 (12.1, 0.2, 10), Vec3 (0, 0, -1)),
+                                          Ray (Vec3 (0.1, -5, 0), Vec3 (0, -1, 0)) };
+
+                World world;
+                Camera camera;
+                FrameBuffer framebuffer (1 << FrameBuffer::ObjectID, int (objects.size ()), 1, 1);
+
+                for (Object *object : objects)
+                        world.add (object);
+
+                world.build ();
+                REQUIRE (world.unbounded.size () == 1);
+
+                for (size_t k = 0; k < objects.size (); k++) {
+                        Ray &r = rays[k];
+                        HitRecord record;
+                        FrameBuffer::Sample aov;
+
+                        REQUIRE (world.hit (r, record));
+                        REQUIRE (record.root == objects[k]);
+
+                        camera.first_hit_aovs (r, record, &world, aov);
+                        framebuffer.add (int (k), 0, aov, true);
+                }
+
+                std::vector<Vec3> ids = framebuffer.buffer (FrameBuffer::ObjectID);
+
+                for (size_t k = 0; k < objects.size (); k++) {
+                        REQUIRE (ids[k][0] == world.id (objects[k]));
+                        REQUIRE (ids[k][0] == k + 1);
+                }
+        }
+}
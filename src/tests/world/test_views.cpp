@@ -0,0 +1,68 @@
+#include "lib/catch_amalgamated.hpp"
+#include "animation.hpp"
+#include "camera.hpp"
+#include "vec3.hpp"
+#include "views.hpp"
+
+#include <string>
+
+// lambertian.cpp reads the renderer settings
+Camera::RendererSettings config;
+
+TEST_CASE ("Frame file names", "")
+{
+        SECTION ("Single frames are written to the file name as is")
+        {
+                REQUIRE (Animation::frame_filename ("out_%s.ppm", 3, 1) == "out_%s.ppm");
+        }
+
+        SECTION ("The frame number is inserted before the extension")
+        {
+                REQUIRE (Animation::frame_filename ("frames/out.ppm", 3, 10) == "frames/out_0003.ppm");
+                REQUIRE (Animation::frame_filename ("frames.d/out", 12, 20) == "frames.d/out_0012");
+        }
+
+        SECTION ("One %d or %0Nd conversion is replaced by the frame number")
+        {
+                REQUIRE (Animation::frame_filename ("frame_%04d.ppm", 7, 10) == "frame_0007.ppm");
+                REQUIRE (Animation::frame_filename ("frame_%d.ppm", 42, 100) == "frame_42.ppm");
+                REQUIRE (Animation::frame_filename ("100%_%03d.ppm", 5, 10) == "100%_005.ppm");
+        }
+
+        SECTION ("Any other % is part of the file name")
+        {
+                REQUIRE (Animation::frame_filename ("out_%s%n.ppm", 3, 10) == "out_%s%n_0003.ppm");
+                REQUIRE (Animation::frame_filename ("100%.ppm", 3, 10) == "100%_0003.ppm");
+                REQUIRE (Animation::frame_filename ("%d_%d.ppm", 3, 10) == "%d_%d_0003.ppm");
+        }
+}
+
+TEST_CASE ("Views", "")
+{
+        Camera::View camera = { Vec3 (0, 0, 2), Vec3 (0, 0, 0), Vec3 (0, 1, 0), 90, 0, 0, { 0, 0 } };
+
+        SECTION ("A turntable orbits lookfrom around vup through lookat")
+        {
+                Views views;
+
+                views.turntable (4, camera);
+
+                REQUIRE (views.views.size () == 4);
+                REQUIRE (views.views[0].second.lookfrom[2] == Catch::Approx (2));
+                REQUIRE (views.views[1].second.lookfrom[0] == Catch::Approx (2));
+                REQUIRE (views.views[2].second.lookfrom[2] == Catch::Approx (-2));
+                REQUIRE (views.views[3].second.lookat[2] == 0);
+        }
+
+        SECTION ("Named views insert their name, unnamed views are numbered")
+        {
+                Views views;
+
+                views.views.push_back (std::make_pair (std::string ("front"), camera));
+                views.views.push_back (std::make_pair (std::string (), camera));
+
+                REQUIRE (views.filename ("renders/out.ppm", 0) == "renders/out_front.ppm");
+                REQUIRE (views.filename ("renders/out.ppm", 1) == "renders/out_0001.ppm");
+                REQUIRE (views.filename ("renders/out_%s.ppm", 1) == "renders/out_%s_0001.ppm");
+        }
+}
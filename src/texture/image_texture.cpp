@@ -8,15 +8,26 @@
 #include "image_texture.hpp"
 #include "lib/stb_image.hpp"
 
+/**
+        The decoded image is only kept as a tiled mip pyramid (mipmap.hpp).
+ */
 ImageTexture::ImageTexture (const char *image_filename)
 {
-        this->pixels = (struct rgb_pixel *)stbi_load (
-                image_filename, &this->image_width, &this->image_height, &this->image_channels, 3);
+        stbi_uc *pixels = stbi_load (image_filename, &this->image_width, &this->image_height, &this->image_channels, 3);
 
-        if (!this->pixels) {
+        if (!pixels) {
                 std::cout << "Attempting to load texture " << image_filename << " failed: " << strerror (errno);
                 exit (EXIT_FAILURE);
         }
+
+        this->mipmap = new MipMap (pixels, this->image_width, this->image_height);
+
+        stbi_image_free (pixels);
+}
+
+ImageTexture::~ImageTexture ()
+{
+        delete this->mipmap;
 }
 
 Vec3 ImageTexture::photon_map (Vec3 point)
@@ -26,17 +37,36 @@ Vec3 ImageTexture::photon_map (Vec3 point)
 
 Vec3 ImageTexture::read_texture_uv (Vec3 uv, Vec3 point)
 {
-        Vec3 color = this->read_rgb255 (uv) / 255.0;
+        return this->mipmap->bilinear (0, uv);
+}
+
+/**
+        Filtered lookup over a footprint of the given width in texture
+        coordinates, e.g. the size of a pixel projected onto the surface.
+ */
+Vec3 ImageTexture::lookup (Vec3 uv, Vec3, double width)
+{
+        return this->mipmap->trilinear (uv, width);
+}
+
+/**
+        Filtered texel values (0 - 255), for normal maps seen from afar.
+ */
+Vec3 ImageTexture::lookup_rgb255 (Vec3 uv, double width)
+{
+        if (!(width > 0))
+                return this->read_rgb255 (uv);
 
-        return color * color;
+        return this->mipmap->trilinear_rgb255 (uv, width);
 }
 
+/**
+        Raw, unfiltered texel values (0 - 255), for normal maps.
+ */
 Vec3 ImageTexture::read_rgb255 (Vec3 uv)
 {
         int u = int (std::floor (uv[0] * image_width));
         int v = int (std::floor (uv[1] * image_height));
 
-        struct rgb_pixel pixel = this->pixels[v * image_width + u];
-
-        return Vec3 (pixel.red, pixel.green, pixel.blue);
+        return this->mipmap->texel_rgb255 (0, u, v);
 }
@@ -0,0 +1,243 @@
+#include "mipmap.hpp"
+#include "vec3.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#define TILE MIPMAP_TILE_SIZE
+
+const uint8_t *MipMap::Level::texel (int x, int y)
+{
+        int tile = (y / TILE) * this->tiles_x + (x / TILE);
+
+        return &this->texels[3 * (size_t (tile) * TILE * TILE + (y % TILE) * TILE + (x % TILE))];
+}
+
+static inline double decode (uint8_t value)
+{
+        double c = value / 255.0;
+
+        return c * c;
+}
+
+struct DecodeTable {
+        float linear[256];
+
+        DecodeTable ()
+        {
+                for (int value = 0; value < 256; value++)
+                        this->linear[value] = float (decode (uint8_t (value)));
+        }
+};
+
+// decode () of every 8-bit value, so that lookups are a table read
+static const DecodeTable decode_table;
+
+static inline uint8_t encode (double linear)
+{
+        return uint8_t (std::min (255.0, std::round (std::sqrt (linear) * 255.0)));
+}
+
+/**
+        Texels of a level of the given size that texel i of the next level
+        averages along one axis, returns how many. Even sizes average pairs.
+        An odd size 2n + 1 shrinks to n texels that each cover 2 + 1/n
+        texels, so 3 taps weighted by how much of each they cover, and every
+        texel of the level contributes equally to the next.
+ */
+static int filter_taps (int size, int i, int index[3], double weight[3])
+{
+        if (size == 1) {
+                index[0] = 0;
+                weight[0] = 1;
+                return 1;
+        }
+
+        if (size % 2 == 0) {
+                index[0] = 2 * i;
+                index[1] = 2 * i + 1;
+                weight[0] = weight[1] = 0.5;
+                return 2;
+        }
+
+        int n = size / 2;
+
+        for (int k = 0; k < 3; k++)
+                index[k] = 2 * i + k;
+
+        weight[0] = double (n - i) / size;
+        weight[1] = double (n) / size;
+        weight[2] = double (i + 1) / size;
+
+        return 3;
+}
+
+/**
+        Builds the pyramid down to 1x1. Each texel of a level is the box
+        filtered average of the texels of the level above that it covers
+        (2x2 for even sizes, up to 3x3 for odd ones), averaged in linear
+        colour.
+ */
+MipMap::MipMap (const uint8_t *rgb, int width, int height)
+{
+        std::vector<uint8_t> current (rgb, rgb + 3 * size_t (width) * height);
+
+        while (true) {
+                Level level;
+
+                level.width = width;
+                level.height = height;
+                level.tiles_x = (width + TILE - 1) / TILE;
+                level.tiles_y = (height + TILE - 1) / TILE;
+
+                this->_store_level (level, current.data ());
+                this->levels.push_back (std::move (level));
+
+                if (width == 1 && height == 1)
+                        break;
+
+                int next_width = std::max (1, width / 2), next_height = std::max (1, height / 2);
+                std::vector<uint8_t> next (3 * size_t (next_width) * next_height);
+
+                for (int y = 0; y < next_height; y++) {
+                        int sy[3], sx[3];
+                        double wy[3], wx[3];
+                        int ny = filter_taps (height, y, sy, wy);
+
+                        for (int x = 0; x < next_width; x++) {
+                                int nx = filter_taps (width, x, sx, wx);
+
+                                for (int c = 0; c < 3; c++) {
+                                        double sum = 0;
+
+                                        for (int ty = 0; ty < ny; ty++)
+                                                for (int tx = 0; tx < nx; tx++)
+                                                        sum += wy[ty] * wx[tx] *
+                                                               decode (current[3 * (size_t (sy[ty]) * width + sx[tx]) + c]);
+
+                                        next[3 * (size_t (y) * next_width + x) + c] = encode (sum);
+                                }
+                        }
+                }
+
+                current = std::move (next);
+                width = next_width;
+                height = next_height;
+        }
+}
+
+/**
+        Copies a row major image into the tiled layout. Texels of partial
+        tiles at the right and bottom edges are left zero and never read.
+ */
+void MipMap::_store_level (Level &level, const uint8_t *rgb)
+{
+        level.texels.assign (3 * size_t (level.tiles_x) * level.tiles_y * TILE * TILE, 0);
+
+        for (int y = 0; y < level.height; y++)
+                for (int x = 0; x < level.width; x++) {
+                        const uint8_t *src = &rgb[3 * (size_t (y) * level.width + x)];
+                        uint8_t *dst = (uint8_t *)level.texel (x, y);
+
+                        dst[0] = src[0];
+                        dst[1] = src[1];
+                        dst[2] = src[2];
+                }
+}
+
+void MipMap::_wrap (Level &level, int &x, int &y)
+{
+        x %= level.width;
+
+        if (x < 0)
+                x += level.width;
+
+        y = std::clamp (y, 0, level.height - 1);
+}
+
+Vec3 MipMap::texel (int level, int x, int y)
+{
+        Level &l = this->levels[level];
+
+        this->_wrap (l, x, y);
+
+        const uint8_t *texel = l.texel (x, y);
+        const float *linear = decode_table.linear;
+
+        return Vec3 (linear[texel[0]], linear[texel[1]], linear[texel[2]]);
+}
+
+// undecoded 8-bit value, for data textures such as normal maps
+Vec3 MipMap::texel_rgb255 (int level, int x, int y)
+{
+        Level &l = this->levels[level];
+
+        this->_wrap (l, x, y);
+
+        const uint8_t *texel = l.texel (x, y);
+
+        return Vec3 (texel[0], texel[1], texel[2]);
+}
+
+/**
+        Blends the four texels around uv, fetched with texel (level, x, y).
+ */
+template <typename F> static Vec3 bilinear_texels (MipMap::Level &l, Vec3 uv, F texel)
+{
+        double x = uv[0] * l.width - 0.5, y = uv[1] * l.height - 0.5;
+        double x0 = std::floor (x), y0 = std::floor (y);
+        double fx = x - x0, fy = y - y0;
+
+        int ix = int (x0), iy = int (y0);
+
+        return texel (ix, iy) * ((1 - fx) * (1 - fy)) + texel (ix + 1, iy) * (fx * (1 - fy)) +
+               texel (ix, iy + 1) * ((1 - fx) * fy) + texel (ix + 1, iy + 1) * (fx * fy);
+}
+
+Vec3 MipMap::bilinear (int level, Vec3 uv)
+{
+        return bilinear_texels (this->levels[level], uv, [&] (int x, int y) { return this->texel (level, x, y); });
+}
+
+Vec3 MipMap::bilinear_rgb255 (int level, Vec3 uv)
+{
+        return bilinear_texels (this->levels[level], uv,
+                                [&] (int x, int y) { return this->texel_rgb255 (level, x, y); });
+}
+
+/**
+        width is the size of the lookup footprint in texture coordinates. The
+        two levels whose texels are closest to that size are filtered
+        bilinearly and blended.
+ */
+template <typename F> Vec3 MipMap::_trilinear (Vec3 uv, double width, F bilinear)
+{
+        Level &base = this->levels[0];
+        double texels = width * std::max (base.width, base.height);
+
+        if (!(texels > 1))
+                return bilinear (0, uv);
+
+        int last = int (this->levels.size ()) - 1;
+        double level = std::min (double (last), std::log2 (texels));
+        int lower = int (std::floor (level));
+
+        if (lower >= last)
+                return bilinear (last, uv);
+
+        double t = level - lower;
+
+        return bilinear (lower, uv) * (1 - t) + bilinear (lower + 1, uv) * t;
+}
+
+Vec3 MipMap::trilinear (Vec3 uv, double width)
+{
+        return this->_trilinear (uv, width, [this] (int level, Vec3 uv) { return this->bilinear (level, uv); });
+}
+
+// filtered undecoded values, for normal maps
+Vec3 MipMap::trilinear_rgb255 (Vec3 uv, double width)
+{
+        return this->_trilinear (uv, width, [this] (int level, Vec3 uv) { return this->bilinear_rgb255 (level, uv); });
+}
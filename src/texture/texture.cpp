@@ -18,4 +18,14 @@ void Texture::store_photon (Vec3 uv, Vec3 color)
         size_t y = size_t (uv[1] * this->photon_map_height);
 
         this->photon_texture[y * this->photon_map_width + x] += color;
+}
+
+Vec3 Texture::lookup (Vec3 uv, Vec3 point, double)
+{
+        return this->read_texture_uv (uv, point);
+}
+
+Vec3 Texture::lookup_rgb255 (Vec3 uv, double)
+{
+        return this->read_rgb255 (uv);
 }
\ No newline at end of file
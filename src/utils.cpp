@@ -1,6 +1,8 @@
 #include "utils.hpp"
 #include "mat3.hpp"
 #include "material.hpp"
+#include "obj.hpp"
+#include "ply.hpp"
 #include "ray.hpp"
 #include "termcolor.hpp"
 #include "triangle.hpp"
@@ -12,8 +14,6 @@
 #include <stdexcept>
 #include <xlocale/_stdio.h>
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
 #include <cmath>
 
 #include <cstdlib>
@@ -30,9 +30,44 @@ double clamp (double min, double x, double max)
         return x;
 }
 
+/**
+        State of the calling thread's generator (splitmix64), used once
+        seed_random () was called on that thread. Until then random_double
+        draws from rand (), which all threads share.
+ */
+static thread_local bool random_seeded = false;
+static thread_local uint64_t random_state;
+
+static inline uint64_t splitmix64 (uint64_t &state)
+{
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+        return z ^ (z >> 31);
+}
+
 double random_double (double min, double max)
 {
-        return min + (max - min) * ((double)std::rand () / RAND_MAX);
+        if (!random_seeded)
+                return min + (max - min) * ((double)std::rand () / RAND_MAX);
+
+        // the top 53 bits, uniform in [0, 1)
+        return min + (max - min) * (double (splitmix64 (random_state) >> 11) * 0x1.0p-53);
+}
+
+/**
+        Makes the calling thread's random_double a sequence that only
+        depends on seed, e.g. to render a pixel the same way whichever
+        thread renders it. Nearby seeds (pixel indices) give unrelated
+        sequences.
+ */
+void seed_random (uint64_t seed)
+{
+        random_state = seed;
+        random_state = splitmix64 (random_state);
+        random_seeded = true;
 }
 
 double deg2rad (double deg)
@@ -161,6 +196,22 @@ bool hit_box (Vec3 point,
         return (0 <= _alpha && _alpha <= u_length) && (0 <= _beta && _beta <= v_length);
 }
 
+// squared sine of the smallest angle between the edges of a triangle that still has a normal
+#define DEGENERATE_TRIANGLE_SIN2 1e-20
+
+/**
+        True for triangles too thin to have a normal (scanned meshes often
+        contain them). The test is relative to the edge lengths, so small
+        triangles of finely tessellated meshes are kept whatever their units.
+ */
+bool degenerate_triangle (Vec3 v1, Vec3 v2, Vec3 v3)
+{
+        Vec3 e1 = v2 - v1, e2 = v3 - v1;
+        Vec3 normal = e1.cross (e2);
+
+        return normal.dot (normal) <= DEGENERATE_TRIANGLE_SIN2 * e1.dot (e1) * e2.dot (e2);
+}
+
 Vec3 compute_mesh_centroid (std::vector<Triangle *> mesh_triangles)
 {
         Vec3 centroid (0, 0, 0);
@@ -181,75 +232,94 @@ Vec3 compute_mesh_centroid (std::vector<Triangle *> mesh_triangles)
 
 std::vector<Triangle *> load_obj_mesh (char *obj_filename, Material *material)
 {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shape;
-        std::vector<tinyobj::material_t> mats;
-        std::string warn, err;
+        ObjFile obj (obj_filename);
         std::vector<Triangle *> triangles;
 
-        if (!tinyobj::LoadObj (&attrib, &shape, &mats, &warn, &err, obj_filename, NULL, true, true))
-                throw std::runtime_error (warn + err);
+        obj.parse ();
 
-        auto load_vertex = [attrib] (tinyobj::index_t idx) -> Vec3 {
-                size_t x = 3 * idx.vertex_index, y = 3 * idx.vertex_index + 1, z = 3 * idx.vertex_index + 2;
-
-                return Vec3 (attrib.vertices[x], attrib.vertices[y], attrib.vertices[z]);
-        };
-
-        auto load_vertex_normal = [attrib] (tinyobj::index_t idx) -> Vec3 {
-                if (idx.normal_index == -1)
+        auto load_vertex_normal = [&obj] (ObjFile::Index idx) -> Vec3 {
+                if (idx.normal == -1)
                         return Vec3::zero ();
 
-                size_t x = 3 * idx.normal_index, y = 3 * idx.normal_index + 1, z = 3 * idx.normal_index + 2;
-
-                return Vec3 (attrib.normals[x], attrib.normals[y], attrib.normals[z]);
+                return obj.normals[idx.normal];
         };
 
-        for (auto sh : shape)
-                for (auto fv : sh.mesh.num_face_vertices)
-                        assert (fv == 3);
+        triangles.reserve (obj.triangle_count ());
+
+        for (size_t triangle_index = 0; triangle_index < obj.indices.size (); triangle_index += 3) {
+                ObjFile::Index p1 = obj.indices[triangle_index];
+                ObjFile::Index p2 = obj.indices[triangle_index + 1];
+                ObjFile::Index p3 = obj.indices[triangle_index + 2];
 
-        for (auto sh : shape)
-                for (size_t triangle_index = 0; triangle_index < sh.mesh.indices.size (); triangle_index += 3) {
-                        tinyobj::index_t p1 = sh.mesh.indices[triangle_index];
-                        tinyobj::index_t p2 = sh.mesh.indices[triangle_index + 1];
-                        tinyobj::index_t p3 = sh.mesh.indices[triangle_index + 2];
+                Vec3 v1 = obj.vertices[p1.vertex], v2 = obj.vertices[p2.vertex], v3 = obj.vertices[p3.vertex];
 
-                        Vec3 approx_normal =
-                                (load_vertex_normal (p1) + load_vertex_normal (p2) + load_vertex_normal (p3)) / 3;
+                if (degenerate_triangle (v1, v2, v3))
+                        continue;
 
-                        Vec3 v1 = load_vertex (p1), v2 = load_vertex (p2), v3 = load_vertex (p3);
+                Vec3 approx_normal = (load_vertex_normal (p1) + load_vertex_normal (p2) + load_vertex_normal (p3)) / 3;
 
-                        Vec3 normal = (v2 - v1).cross (v3 - v1).unit ();
+                Vec3 normal = (v2 - v1).cross (v3 - v1).unit ();
 
-                        if (normal.dot (approx_normal) < 0)
-                                normal = -normal;
+                if (normal.dot (approx_normal) < 0)
+                        normal = -normal;
 
-                        Triangle *tri = new Triangle (v1, v2, v3, normal, material);
+                Triangle *tri = new Triangle (v1, v2, v3, normal, material);
 
-                        triangles.push_back (tri);
-                }
+                triangles.push_back (tri);
+        }
 
         return triangles;
 }
 
-// std::vector<Triangle *> load_ply_mesh (char *ply_file_name, Material *material)
-// {
+/**
+        @brief Load a triangle mesh from a .ply file (binary or ASCII)
+
+        Vertex positions and face indices are streamed by rply straight into
+        flat arrays; triangles are only created once the whole file is read.
+        As with load_obj_mesh, vertex normals (if present) decide which way
+        each triangle faces, otherwise the winding order does, and degenerate
+        triangles are skipped.
+ */
+std::vector<Triangle *> load_ply_mesh (char *ply_filename, Material *material)
+{
+        PlyFile ply (ply_filename);
+        std::vector<Triangle *> triangles;
+
+        ply.parse ();
+
+        auto load_vertex = [&ply] (size_t index) -> Vec3 {
+                return Vec3 (ply.vertices[3 * index], ply.vertices[3 * index + 1], ply.vertices[3 * index + 2]);
+        };
+
+        auto load_vertex_normal = [&ply] (size_t index) -> Vec3 {
+                if (!ply.has_normals)
+                        return Vec3::zero ();
+
+                return Vec3 (ply.normals[3 * index], ply.normals[3 * index + 1], ply.normals[3 * index + 2]);
+        };
+
+        triangles.reserve (ply.triangle_count ());
 
-//         p_ply ply = ply_open(ply_file_name, nullptr, 0, nullptr);
+        for (size_t i = 0; i < ply.indices.size (); i += 3) {
+                size_t p1 = ply.indices[i], p2 = ply.indices[i + 1], p3 = ply.indices[i + 2];
 
-//         if (!ply)
-//                 throw std::logic_error("Could not open ply file");
+                Vec3 v1 = load_vertex (p1), v2 = load_vertex (p2), v3 = load_vertex (p3);
 
-//         if (!ply_read_header(ply))
-//                 throw std::logic_error("Could not open ply file");
+                if (degenerate_triangle (v1, v2, v3))
+                        continue;
 
-//         long nverts, ntris;
+                Vec3 normal = (v2 - v1).cross (v3 - v1).unit ();
 
-//         ply_set_read_cb(ply, const char *element_name, const char *property_name, p_ply_read_cb read_cb, void *pdata,
-//         long idata)
+                Vec3 approx_normal = (load_vertex_normal (p1) + load_vertex_normal (p2) + load_vertex_normal (p3)) / 3;
 
-// }
+                if (normal.dot (approx_normal) < 0)
+                        normal = -normal;
+
+                triangles.push_back (new Triangle (v1, v2, v3, normal, material));
+        }
+
+        return triangles;
+}
 
 /**
         @brief Compute the texture projection matrix for a triangle
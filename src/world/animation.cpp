@@ -0,0 +1,197 @@
+#include "animation.hpp"
+#include "camera.hpp"
+#include "lib/json.hpp"
+#include "object.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+
+bool Track::empty ()
+{
+        return this->keys.empty ();
+}
+
+Vec3 Track::at (double frame)
+{
+        if (frame <= this->keys.front ().first)
+                return this->keys.front ().second;
+
+        if (frame >= this->keys.back ().first)
+                return this->keys.back ().second;
+
+        size_t i = 1;
+
+        while (this->keys[i].first < frame)
+                i++;
+
+        std::pair<double, Vec3> &a = this->keys[i - 1], &b = this->keys[i];
+        double t = (frame - a.first) / (b.first - a.first);
+
+        return a.second * (1 - t) + b.second * t;
+}
+
+static Vec3 read_vec3 (json &value)
+{
+        if (!value.is_array () || value.size () != 3)
+                throw std::runtime_error ("animation: expected [x, y, z]");
+
+        return Vec3 (value[0].get<double> (), value[1].get<double> (), value[2].get<double> ());
+}
+
+static Track read_track (json &value)
+{
+        Track track;
+
+        if (!value.is_array ())
+                throw std::runtime_error ("animation: expected a list of [frame, [x, y, z]] keys");
+
+        for (json &key : value) {
+                if (!key.is_array () || key.size () != 2)
+                        throw std::runtime_error ("animation: expected a [frame, [x, y, z]] key");
+
+                track.keys.push_back (std::make_pair (key[0].get<double> (), read_vec3 (key[1])));
+        }
+
+        std::stable_sort (track.keys.begin (), track.keys.end (),
+                          [] (const std::pair<double, Vec3> &a, const std::pair<double, Vec3> &b) { return a.first < b.first; });
+
+        return track;
+}
+
+Animation::Animation () : frames (1), shutter (0)
+{
+}
+
+Animation::Animation (const char *filename) : Animation ()
+{
+        std::ifstream file (filename);
+
+        if (!file)
+                throw std::runtime_error (std::string ("could not open animation file ") + filename);
+
+        json animation;
+
+        try {
+                animation = json::parse (file);
+
+                if (animation.contains ("frames"))
+                        this->frames = animation["frames"].get<int> ();
+
+                if (animation.contains ("shutter"))
+                        this->shutter = animation["shutter"].get<double> ();
+
+                if (animation.contains ("camera")) {
+                        json &camera = animation["camera"];
+
+                        if (camera.contains ("center"))
+                                this->camera_center = read_track (camera["center"]);
+
+                        if (camera.contains ("lookat"))
+                                this->camera_lookat = read_track (camera["lookat"]);
+                }
+
+                if (animation.contains ("objects"))
+                        for (auto &[name, object] : animation["objects"].items ())
+                                if (object.contains ("location"))
+                                        this->object_locations[name] = read_track (object["location"]);
+        } catch (json::exception &e) {
+                throw std::runtime_error (std::string ("error reading animation file ") + filename + ": " + e.what ());
+        }
+}
+
+/**
+        Moves the camera and the animated objects of the world to the given
+        frame. Call World::update () afterwards.
+ */
+void Animation::apply (int frame, Camera &camera, World &world)
+{
+        if (!this->camera_center.empty () || !this->camera_lookat.empty ())
+                camera.look (this->camera_center.empty () ? camera.look_from () : this->camera_center.at (frame),
+                             this->camera_lookat.empty () ? camera.look_at () : this->camera_lookat.at (frame));
+
+        for (auto &[name, track] : this->object_locations) {
+                Object *obj = world.find (name);
+
+                if (track.empty ())
+                        continue;
+
+                if (!obj) {
+                        log_warn ("Animated object %s is not in the scene", name.c_str ());
+                        continue;
+                }
+
+                obj->place (track.at (frame), track.at (frame + this->shutter));
+        }
+}
+
+/**
+        Finds the %d or %0Nd frame number conversion of filename, sets
+        [begin, end) to it and width to N. False unless there is exactly
+        one, any other % is part of the file name.
+ */
+static bool frame_conversion (std::string &filename, size_t &begin, size_t &end, int &width)
+{
+        int conversions = 0;
+
+        for (size_t p = filename.find ('%'); p != std::string::npos; p = filename.find ('%', p + 1)) {
+                size_t q = p + 1;
+
+                if (q < filename.size () && filename[q] == '0')
+                        while (q < filename.size () && isdigit ((unsigned char)filename[q]))
+                                q++;
+
+                if (q >= filename.size () || filename[q] != 'd' || q - p > 4)
+                        continue;
+
+                begin = p;
+                end = q + 1;
+                width = q > p + 1 ? atoi (filename.c_str () + p + 1) : 0;
+                conversions++;
+        }
+
+        return conversions == 1;
+}
+
+/**
+        filename is used as is for single frame renders. Otherwise it may
+        contain one frame number conversion (frame_%04d.ppm), or the frame
+        number is inserted before the extension (out.ppm -> out_0001.ppm).
+        filename is never used as a format string.
+ */
+std::string Animation::frame_filename (const char *filename, int frame, int frames)
+{
+        if (frames <= 1)
+                return filename;
+
+        std::string name (filename);
+        char buffer[128];
+        size_t begin, end;
+        int width;
+
+        if (frame_conversion (name, begin, end, width)) {
+                snprintf (buffer, sizeof (buffer), "%0*d", width, frame);
+                return name.substr (0, begin) + buffer + name.substr (end);
+        }
+
+        size_t dot = name.rfind ('.');
+        size_t slash = name.rfind ('/');
+
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+                dot = name.size ();
+
+        snprintf (buffer, sizeof (buffer), "_%04d", frame);
+
+        return name.substr (0, dot) + buffer + name.substr (dot);
+}
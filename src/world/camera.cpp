@@ -1,13 +1,21 @@
 #include "camera.hpp"
+#include "denoiser.hpp"
 #include "dielectric.hpp"
+#include "environment_light.hpp"
+#include "framebuffer.hpp"
+#include "heatmap.hpp"
 #include "hitrecord.hpp"
-#include "lambertian.hpp"
+#include "image_texture.hpp"
 #include "light.hpp"
 #include "material.hpp"
+#include "material_table.hpp"
 #include "progress_bar.hpp"
 #include "ray.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 #include "vec3.hpp"
+#include "wavefront.hpp"
 #include "world.hpp"
 #include <algorithm>
 #include <cerrno>
@@ -28,8 +36,21 @@
 #include <thread>
 #include <vector>
 
-Camera::Camera () : stream (std::cout), pixel_du (0, 0, 0), pixel_dv (0, 0, 0), pixel_00 (0, 0, 0), center (0, 0, 0)
+// resolution cap of the environment light sampling distribution
+#define ENVIRONMENT_MAX_WIDTH 1024
+#define ENVIRONMENT_MAX_HEIGHT 512
+
+thread_local Camera::RayCounts Camera::ray_counts = {};
+
+Camera::Camera ()
+        : stream (std::cout), pixel_du (0, 0, 0), pixel_dv (0, 0, 0), pixel_00 (0, 0, 0), center (0, 0, 0),
+          environment_light (nullptr)
+{
+}
+
+Camera::~Camera ()
 {
+        delete this->environment_light;
 }
 
 void Camera::initialize (struct RendererSettings settings)
@@ -46,33 +67,129 @@ void Camera::initialize (struct RendererSettings settings)
         this->use_scene_sig = settings.use_scene_sig;
         this->background_texture = settings.background_texture;
         this->use_importance_sampling = settings.use_importance_sampling;
+        this->use_wavefront = settings.use_wavefront;
+        this->stats_file = settings.stats_file;
+        this->heatmaps = settings.heatmaps;
+        this->aovs = settings.aovs;
+        this->denoise = settings.denoise;
+
+        if (this->use_wavefront && !this->use_path_tracer) {
+                log_warn ("The wavefront integrator is a path tracer, ignoring it without --use_path_tracer.");
+                this->use_wavefront = false;
+        }
+
+        // the wavefront integrator works on many pixels at once, costs cannot be told apart
+        if (this->use_wavefront && this->heatmaps) {
+                log_warn ("Heatmaps are not supported by the wavefront integrator, ignoring them.");
+                this->heatmaps = 0;
+        }
+
+        if (this->use_wavefront && this->aovs) {
+                log_warn ("AOVs are not supported by the wavefront integrator, ignoring them.");
+                this->aovs = 0;
+        }
+
+        if (this->use_wavefront && this->denoise) {
+                log_warn ("The denoiser needs AOVs, which the wavefront integrator does not fill, not denoising.");
+                this->denoise = false;
+        }
+
+        this->focus_dist = settings.focus_dist;
+        this->sensor_shift[0] = settings.sensor_shift[0];
+        this->sensor_shift[1] = settings.sensor_shift[1];
+        // zeroed settings get the default view
+        this->vup = settings.vup.near_zero () ? Vec3 (0, 1, 0) : settings.vup;
+
+        /**
+                An image background lights the scene, with light sampling
+                the path tracer samples it directly.
+         */
+        delete this->environment_light;
+        this->environment_light = nullptr;
+
+        ImageTexture *image = dynamic_cast<ImageTexture *> (this->background_texture);
 
-        this->lookat = Vec3 (0, 1, -1);
-        this->center = Vec3 (0, 1, 2); // (1, 1, 4)
-        this->focus_dist = 1;
+        if (image && this->use_path_tracer && this->use_light_sampling)
+                this->environment_light = new EnvironmentLight (image, std::min (image->image_width, ENVIRONMENT_MAX_WIDTH),
+                                                                std::min (image->image_height, ENVIRONMENT_MAX_HEIGHT));
+
+        if (settings.lookfrom == settings.lookat)
+                this->look (Vec3 (0, 1, 2), Vec3 (0, 1, -1)); // (1, 1, 4)
+        else
+                this->look (settings.lookfrom, settings.lookat);
+}
+
+/**
+        Points the camera from center towards lookat. May be called again
+        between renders, e.g. once per frame of an animation.
+ */
+void Camera::look (Vec3 center, Vec3 lookat)
+{
+        this->center = center;
+        this->lookat = lookat;
+
+        double focus_dist = this->focus_dist > 0 ? this->focus_dist : (this->lookat - this->center).length ();
 
         this->image_height = int (this->image_width / this->aspect_ratio);
-        this->viewport_height = 2 * this->focus_dist * std::tan (deg2rad (this->vfov / 2));
+        this->viewport_height = 2 * focus_dist * std::tan (deg2rad (this->vfov / 2));
         this->viewport_width = this->viewport_height * (double (this->image_width) / this->image_height);
 
         Vec3 w = (this->center - this->lookat).unit ();
-        Vec3 vup (0, 1, 0);
-        Vec3 u = vup.cross (w).unit ();
+        Vec3 u = this->vup.cross (w).unit ();
         Vec3 v = w.cross (u);
         Vec3 viewport_u = u * this->viewport_width;
         Vec3 viewport_v = -v * this->viewport_height;
-        Vec3 viewport_top_left = this->center - w * focus_dist - viewport_u / 2 - viewport_v / 2;
+        // a shift moves the image plane across the view direction, verticals stay vertical
+        Vec3 viewport_top_left = this->center - w * focus_dist - viewport_u / 2 - viewport_v / 2 +
+                                 viewport_u * this->sensor_shift[0] - viewport_v * this->sensor_shift[1];
 
         this->pixel_du = viewport_u / this->image_width;
         this->pixel_dv = viewport_v / this->image_height;
         this->pixel_00 = viewport_top_left + ((pixel_du + pixel_dv) / 2.0);
 
-        double defocus_radius = this->focus_dist * std::tan (deg2rad (this->defocus_angle / 2));
+        double defocus_radius = focus_dist * std::tan (deg2rad (this->defocus_angle / 2));
 
         this->defocus_disk_u = u * defocus_radius;
         this->defocus_disk_v = v * defocus_radius;
 }
 
+Vec3 Camera::look_from ()
+{
+        return this->center;
+}
+
+Vec3 Camera::look_at ()
+{
+        return this->lookat;
+}
+
+Camera::View Camera::view ()
+{
+        return View{ this->center,
+                     this->lookat,
+                     this->vup,
+                     this->vfov,
+                     this->focus_dist,
+                     this->defocus_angle,
+                     { this->sensor_shift[0], this->sensor_shift[1] } };
+}
+
+/**
+        Moves the camera and sets its lens up, the image size and renderer
+        settings are kept.
+ */
+void Camera::set_view (View view)
+{
+        this->vup = view.vup;
+        this->vfov = view.vfov;
+        this->focus_dist = view.focus_dist;
+        this->defocus_angle = view.defocus_angle;
+        this->sensor_shift[0] = view.sensor_shift[0];
+        this->sensor_shift[1] = view.sensor_shift[1];
+
+        this->look (view.lookfrom, view.lookat);
+}
+
 void Camera::print_arguments ()
 {
         log_info ("Image Size (w x h):      %d x %d", this->image_width, this->image_height);
@@ -80,9 +197,11 @@ void Camera::print_arguments ()
         log_info ("Vertical Field of View:  %lf degrees", this->vfov);
         log_info ("Ray Bounce Max Depth:    %d", this->max_depth);
         log_info ("Defocus Angle:           %lf degrees", this->defocus_angle);
+        log_info ("Focus Distance:          %lf%s", this->focus_dist, this->focus_dist > 0 ? "" : " (look-at point)");
         log_info ("Path Tracing:            %s", this->use_path_tracer ? "Enabled" : "Disabled");
         log_info ("Importance Sampling:     %s", this->use_importance_sampling ? "Enabled" : "Disabled");
         log_info ("Explicit Light Sampling: %s", this->use_light_sampling ? "Enabled" : "Disabled");
+        log_info ("Wavefront Integrator:    %s", this->use_wavefront ? "Enabled" : "Disabled");
         // log_info ("Compiler Optimization Level: %d", __OPTIMIZE__);
 }
 
@@ -100,7 +219,41 @@ Ray Camera::ray (int du, int dv)
 
         double time = random_double (0, 1);
 
-        return Ray (origin, direction, time);
+        Ray r (origin, direction, time);
+
+        /**
+                Differentials through the neighbouring pixels, from the same
+                origin (the spread of a defocused lens is not accounted for).
+         */
+        r.has_differentials = true;
+        r.rx_origin = origin;
+        r.ry_origin = origin;
+        r.rx_direction = direction + this->pixel_du;
+        r.ry_direction = direction + this->pixel_dv;
+
+        return r;
+}
+
+/**
+        Background colour seen along r, filtered over the solid angle between
+        r and its differentials.
+ */
+Vec3 Camera::background (Ray &r)
+{
+        Vec3 uv = EnvironmentLight::to_uv (r.direction);
+        double width = 0;
+
+        if (r.has_differentials) {
+                Vec3 uvx = EnvironmentLight::to_uv (r.rx_direction) - uv;
+                Vec3 uvy = EnvironmentLight::to_uv (r.ry_direction) - uv;
+
+                // u wraps around at the seam
+                uvx = Vec3 (uvx[0] - std::round (uvx[0]), uvx[1], 0);
+                uvy = Vec3 (uvy[0] - std::round (uvy[0]), uvy[1], 0);
+                width = std::max (uvx.length (), uvy.length ());
+        }
+
+        return this->background_texture->lookup (uv, uv, width);
 }
 
 /**
@@ -136,7 +289,16 @@ Vec3 Camera::sample_light_rays (World *world,
                         creating a shadow.
                  */
 
-                if (!world->has_path (record.hit_point, point))
+                Camera::ray_counts.shadow++;
+
+                bool visible;
+
+                {
+                        STATS_TIME (StatsStage::Shadow);
+                        visible = world->has_path (record.hit_point, point);
+                }
+
+                if (!visible)
                         continue;
 
                 Vec3 light_direction = (point - record.hit_point).unit ();
@@ -159,20 +321,34 @@ Vec3 Camera::sample_light_rays (World *world,
         return diffuse_component * params.color + specular_component;
 }
 
-Vec3 Camera::ray_color (Ray r, World *world, int depth)
+Vec3 Camera::ray_color (Ray r, World *world, int depth, FrameBuffer::Sample *aov)
 {
+        STATS_TIME (StatsStage::Shade);
+
         HitRecord record;
 
-        if (!world->hit (r, record)) {
-                Vec3 sph = r.direction.unit ().sph ();
+        if (depth == this->max_depth)
+                Camera::ray_counts.primary++;
+        else
+                Camera::ray_counts.secondary++;
 
-                Vec3 uv (sph[1] / (2 * M_PI), sph[2] / M_PI, 0);
+        bool hit;
 
-                return this->background_texture->read_texture_uv (uv, uv).clamp (0, 1);
+        {
+                STATS_TIME (StatsStage::Intersect);
+                hit = world->hit (r, record);
         }
 
+        if (!hit)
+                return this->background (r).clamp (0, 1);
+
+        record.differentials (r);
+
+        if (aov)
+                this->first_hit_aovs (r, record, world, *aov);
+
         if (depth == 0)
-                return record.object->material->texture->read_texture_uv (record.uv, record.hit_point);
+                return record.object->material->texture->lookup (record.uv, record.hit_point, record.footprint ());
 
         Material::PhongParams params = record.object->material->phong (r, record);
 
@@ -195,20 +371,24 @@ Vec3 Camera::ray_color (Ray r, World *world, int depth)
                         double refl = Dielectric::reflectance ((-(r.direction.unit ())).dot (normal), mu);
                         if (random_double (0, 1) < refl) {
                                 Ray reflected_ray (record.hit_point, r.direction.reflect (normal).unit ());
+                                record.reflect_differentials (r, reflected_ray);
                                 reflected_ray.nudge_forward ();
                                 color += this->ray_color (reflected_ray, world, depth - 1) * params.rg;
                         } else {
                                 Ray refraction (record.hit_point, r.direction.unit ().refract (normal, mu));
+                                record.refract_differentials (r, refraction, mu);
                                 refraction.nudge_forward ();
                                 color += this->ray_color (refraction, world, depth - 1) * (1 - params.gamma);
                         }
                 } else {
                         Ray reflected_ray (record.hit_point, r.direction.reflect (normal).unit ());
+                        record.reflect_differentials (r, reflected_ray);
                         color += this->ray_color (reflected_ray, world, depth - 1) * params.rg;
                 }
         } else {
                 Ray specular_reflection (record.hit_point, r.direction.unit ().reflect (normal).unit ());
 
+                record.reflect_differentials (r, specular_reflection);
                 specular_reflection.nudge_forward ();
 
                 color += this->ray_color (specular_reflection, world, depth - 1) * params.rg;
@@ -218,6 +398,8 @@ Vec3 Camera::ray_color (Ray r, World *world, int depth)
 
 void Camera::export_p6 (const char *filename, std::vector<Vec3> pixels)
 {
+        TRACE_SCOPE ("image export");
+
         FILE *fp = fopen (filename, "wb");
 
         if (!fp) {
@@ -245,37 +427,39 @@ void Camera::export_p6 (const char *filename, std::vector<Vec3> pixels)
         free (pixel_data);
 }
 
-Vec3 Camera::sample_light (World *world, HitRecord &record, SmoothObject *&hit_light)
+/**
+        Explicit light sampling without the visibility test: picks a light
+        and a point on it and returns the contribution that point makes if
+        nothing blocks the path from the hit point to it (zero if the
+        material is not diffuse or there are no lights).
+ */
+Vec3 Camera::unoccluded_light (World *world, HitRecord &record, SmoothObject *&light, Vec3 &light_point)
 {
         /**
                 Light sampling only applies to diffuse materials.
                 Currently, Lambertian is the only diffuse material, this may
                 need to change in the future.
          */
-        if (!dynamic_cast<Lambertian *> (record.object->material))
+        MaterialRecord &material = MaterialTable::get (record.object->material->id);
+
+        if (material.type != MaterialType::Lambertian)
                 return Vec3 (0, 0, 0);
 
         /**
                 Pick a light at random, if there are no lights, then it isn't
                 possible to perform light sampling.
          */
-        SmoothObject *light = world->random_light ();
+        light = world->random_light ();
 
         if (!light)
                 return Vec3::zero ();
 
         /**
-                Randomly select a point on the light surface and check if
-                there is a clear path between the hit point and the randomly
-                selected point. If light ray is blocked, then there is no
-                contribution.
+                Randomly select a point on the light surface, the caller
+                checks if there is a clear path between the hit point and
+                the randomly selected point.
          */
-        Vec3 light_point = light->sample_point ();
-
-        if (!world->has_path (record.hit_point, light_point))
-                return Vec3::zero ();
-
-        hit_light = light;
+        light_point = light->sample_point ();
 
         /**
                 Compute the probability that a randomly emitted ray will hit the
@@ -307,39 +491,187 @@ Vec3 Camera::sample_light (World *world, HitRecord &record, SmoothObject *&hit_l
 
         double ray_prob = steradians_on_unit_hemisphere / (2 * M_PI);
 
-        return light->material->emission () * fmax (0, ray_prob * to_light.unit ().dot (record.normal)) *
-               record.object->material->color (record);
+        return MaterialTable::get (light->material->id).emission *
+               fmax (0, ray_prob * to_light.unit ().dot (record.normal)) * material.color (record);
 }
 
-Vec3 Camera::single_path_color (Ray starting_ray, World *world, int depth)
+/**
+        unoccluded_light () followed by the shadow ray: if the light ray is
+        blocked, then there is no contribution.
+ */
+Vec3 Camera::sample_light (World *world, HitRecord &record, SmoothObject *&hit_light)
+{
+        SmoothObject *light;
+        Vec3 light_point;
+
+        Vec3 radiance = this->unoccluded_light (world, record, light, light_point);
+
+        if (radiance == Vec3::zero ())
+                return Vec3::zero ();
+
+        Camera::ray_counts.shadow++;
+
+        STATS_TIME (StatsStage::Shadow);
+
+        if (!world->has_path (record.hit_point, light_point))
+                return Vec3::zero ();
+
+        hit_light = light;
+
+        return radiance;
+}
+
+// power heuristic weight of the strategy with density f against g
+static double power_heuristic (double f, double g)
+{
+        return f * f / (f * f + g * g);
+}
+
+/**
+        Next-event estimation for the environment light without the
+        visibility test: samples a direction proportionally to the
+        background's radiance and sets radiance to what it adds if nothing
+        blocks it, weighted against the chance of scatter () finding the same
+        direction (zero if it faces away from the surface).
+
+        Returns false if the material cannot be evaluated for a given
+        direction, the background is then left to the scattered ray alone.
+ */
+bool Camera::unoccluded_environment (Ray r, HitRecord &record, Vec3 &direction, Vec3 &radiance)
+{
+        Vec3 brdf;
+        double light_pdf, brdf_pdf;
+
+        radiance = Vec3::zero ();
+
+        Vec3 light = this->environment_light->sample (direction, light_pdf);
+
+        if (!MaterialTable::get (record.object->material->id).evaluate (r, record, direction, brdf, brdf_pdf))
+                return false;
+
+        double lambert_cos = direction.unit ().dot (record.normal.unit ());
+
+        if (!(light_pdf > 0) || lambert_cos <= 0)
+                return true;
+
+        radiance = light * brdf * lambert_cos / light_pdf * power_heuristic (light_pdf, brdf_pdf);
+
+        return true;
+}
+
+/**
+        unoccluded_environment () followed by the shadow ray, radiance is
+        only added to if the sampled direction reaches the background.
+ */
+bool Camera::sample_environment (Ray r, World *world, HitRecord &record, Vec3 &radiance)
+{
+        Vec3 direction, light;
+
+        if (!this->unoccluded_environment (r, record, direction, light))
+                return false;
+
+        if (light == Vec3::zero ())
+                return true;
+
+        HitRecord blocker;
+        Ray shadow (record.hit_point, direction);
+
+        shadow.nudge_forward ();
+
+        Camera::ray_counts.shadow++;
+
+        STATS_TIME (StatsStage::Shadow);
+
+        if (!world->hit (shadow, blocker))
+                radiance += light;
+
+        return true;
+}
+
+/**
+        Background seen by a path that leaves the scene along r. mis_pdf is
+        the scatter () pdf of r when the environment was also sampled
+        directly at its origin (0 otherwise), the background is then
+        weighted against that sample.
+ */
+Vec3 Camera::escaped (Ray &r, double mis_pdf)
+{
+        Vec3 background = this->background (r);
+
+        if (mis_pdf > 0)
+                background *= power_heuristic (mis_pdf, this->environment_light->pdf (r.direction));
+
+        return background;
+}
+
+Vec3 Camera::single_path_color (Ray starting_ray, World *world, int depth, FrameBuffer::Sample *aov)
 {
         std::vector<Vec3> radiances;
         std::vector<Vec3> throughput;
 
+        // emitted radiance (or background) found by the first two rays, for the AOVs
+        Vec3 emitted[2];
+
+        // scatter () pdf of the ray that led here, when the environment was also sampled directly
+        double mis_pdf = 0;
+
+        STATS_TIME (StatsStage::Shade);
+
         for (int i = 0; i < depth; i++) {
                 HitRecord record;
 
-                if (!world->hit (starting_ray, record)) {
-                        Vec3 sph = starting_ray.direction.unit ().sph ();
+                if (i == 0)
+                        Camera::ray_counts.primary++;
+                else
+                        Camera::ray_counts.secondary++;
 
-                        Vec3 uv (sph[1] / (2 * M_PI), sph[2] / M_PI, 0);
+                bool hit;
 
-                        radiances.push_back (this->background_texture->read_texture_uv (uv, uv));
+                {
+                        STATS_TIME (StatsStage::Intersect);
+                        hit = world->hit (starting_ray, record);
+                }
+
+                if (!hit) {
+                        radiances.push_back (this->escaped (starting_ray, mis_pdf));
                         throughput.push_back (Vec3 (0, 0, 0));
 
+                        if (i < 2)
+                                emitted[i] = radiances.back ();
+
+                        STATS_ADD (escaped, 1);
+                        STATS_PATH (i);
                         break;
                 }
 
+                record.differentials (starting_ray);
+
+                if (aov && i == 0)
+                        this->first_hit_aovs (starting_ray, record, world, *aov);
+
                 double pdf;
                 Vec3 brdf;
-                Vec3 scatter_dir = record.object->material->scatter (starting_ray, record, brdf, pdf);
+                MaterialRecord &material = MaterialTable::get (record.object->material->id);
+                Vec3 scatter_dir = material.scatter (starting_ray, record, brdf, pdf);
                 double lambert_cos = scatter_dir.unit ().dot (record.normal.unit ());
 
-                Vec3 radiance = record.object->material->emission ();
+                Vec3 radiance = material.emission;
+
+                if (i < 2)
+                        emitted[i] = radiance;
 
                 throughput.push_back (brdf * lambert_cos / pdf);
 
-                starting_ray = Ray (record.hit_point, scatter_dir);
+                mis_pdf = 0;
+
+                if (this->environment_light && this->sample_environment (starting_ray, world, record, radiance))
+                        mis_pdf = pdf;
+
+                // bounces happen at the time of the camera ray, for motion blur
+                Ray next (record.hit_point, scatter_dir, starting_ray.time);
+
+                material.differentials (starting_ray, record, next);
+                starting_ray = next;
 
                 starting_ray.nudge_forward ();
 
@@ -351,7 +683,17 @@ Vec3 Camera::single_path_color (Ray starting_ray, World *world, int depth)
                         if (light_sample != Vec3::zero ()) {
                                 HitRecord next_record;
 
-                                if (!world->hit (starting_ray, next_record)) {
+                                // finds out if the scattered ray would have hit the light on its own
+                                Camera::ray_counts.shadow++;
+
+                                bool next_hit;
+
+                                {
+                                        STATS_TIME (StatsStage::Shadow);
+                                        next_hit = world->hit (starting_ray, next_record);
+                                }
+
+                                if (!next_hit) {
                                         radiance += light_sample;
                                 } else if (next_record.object != light) {
                                         radiance += light_sample;
@@ -361,8 +703,16 @@ Vec3 Camera::single_path_color (Ray starting_ray, World *world, int depth)
 
                 radiances.emplace_back (radiance);
 
-                if (record.object->material->is_emissive ())
+                if (material.emissive) {
+                        STATS_ADD (emitted, 1);
+                        STATS_PATH (i + 1);
                         break;
+                }
+
+                if (i == depth - 1) {
+                        STATS_ADD (max_depth, 1);
+                        STATS_PATH (depth);
+                }
         }
         Vec3 total_radiance (0, 0, 0);
 
@@ -379,34 +729,95 @@ Vec3 Camera::single_path_color (Ray starting_ray, World *world, int depth)
                 total_radiance += radiances[i] * throughput_partial_products[i];
         }
 
+        /**
+                Light sampled at the first hit, and emitters or background
+                the second ray found, are direct light. Everything after is
+                indirect.
+         */
+        if (aov && !radiances.empty ()) {
+                Vec3 direct = radiances[0] - emitted[0];
+
+                if (radiances.size () > 1)
+                        direct += emitted[1] * throughput_partial_products[1];
+
+                (*aov)[FrameBuffer::Emission] = emitted[0];
+                (*aov)[FrameBuffer::Direct] = direct;
+                (*aov)[FrameBuffer::Indirect] = total_radiance - emitted[0] - direct;
+        }
+
         return total_radiance;
 }
 
-Vec3 Camera::scene_signature_color (Ray starting_ray, World *world)
+Vec3 Camera::scene_signature_color (Ray starting_ray, World *world, FrameBuffer::Sample *aov)
 {
         HitRecord record;
+
+        Camera::ray_counts.primary++;
+
         if (!world->hit (starting_ray, record))
                 return Vec3 (0, 0, 0);
 
+        if (aov) {
+                record.differentials (starting_ray);
+                this->first_hit_aovs (starting_ray, record, world, *aov);
+        }
+
         return (record.normal.unit () + Vec3 (1, 1, 1)) / 2;
 }
 
+/**
+        The AOVs every integrator fills in from the first hit of a camera
+        sample, see framebuffer.hpp.
+ */
+void Camera::first_hit_aovs (Ray &r, HitRecord &record, World *world, FrameBuffer::Sample &aov)
+{
+        Material *material = record.object->material;
+
+        aov[FrameBuffer::Albedo] = material->texture ? MaterialTable::get (material->id).color (record) : Vec3 (1, 1, 1);
+        aov[FrameBuffer::Normal] = record.normal.unit ();
+        aov[FrameBuffer::Depth] = Vec3 (1, 1, 1) * (record.hit_point - r.origin).length ();
+        aov[FrameBuffer::ObjectID] = Vec3 (1, 1, 1) * world->id (record.root);
+}
+
 Vec3 Camera::sample_pixel (World *world, int i, int j)
 {
+        Heatmap::Cost start = this->heatmap.start ();
         Vec3 pixel_color (0, 0, 0);
+        bool fill_aovs = this->framebuffer.enabled ();
+
         for (int sample = 0; sample < this->samples_per_pixel; sample++) {
-                Ray r = this->ray (i + random_double (-0.5, 0.5), j + random_double (-0.5, 0.5));
+                Ray r;
+                Vec3 color;
+                FrameBuffer::Sample aov;
+
+                {
+                        STATS_TIME (StatsStage::Generate);
+
+                        r = this->ray (i + random_double (-0.5, 0.5), j + random_double (-0.5, 0.5));
+
+                        // each sample only covers part of the pixel
+                        r.scale_differentials (std::max (0.125, 1 / std::sqrt (double (this->samples_per_pixel))));
+                }
 
                 if (this->use_path_tracer)
-                        pixel_color += this->single_path_color (r, world, this->max_depth);
+                        color = this->single_path_color (r, world, this->max_depth, fill_aovs ? &aov : nullptr);
                 else if (this->use_scene_sig)
-                        pixel_color += this->scene_signature_color (r, world);
+                        color = this->scene_signature_color (r, world, fill_aovs ? &aov : nullptr);
                 else
-                        pixel_color += this->ray_color (r, world, this->max_depth);
+                        color = this->ray_color (r, world, this->max_depth, fill_aovs ? &aov : nullptr);
+
+                pixel_color += color;
+
+                if (fill_aovs) {
+                        aov[FrameBuffer::Beauty] = color;
+                        this->framebuffer.add (i, j, aov, sample == 0);
+                }
         }
 
         pixel_color /= double (this->samples_per_pixel);
 
+        this->heatmap.add (i, j, start);
+
         return pixel_color;
 }
 
@@ -428,16 +839,30 @@ void Camera::render_multithreaded (World *world, const char *filename, int max_t
         log_info ("Rendering on %d threads with the following arguments:", max_threads);
         this->print_arguments ();
 
+        if (this->use_wavefront) {
+                WavefrontIntegrator integrator (this, world);
+                this->export_p6 (filename, integrator.render (max_threads));
+                STATS_REPORT (this->stats_file);
+                return;
+        }
+
         progressbar bar (image_height);
 
+        this->heatmap = Heatmap (this->heatmaps, this->image_width, this->image_height);
+        this->framebuffer = FrameBuffer (this->aovs | (this->denoise ? Denoiser::guides : 0), this->image_width,
+                                         this->image_height, this->samples_per_pixel);
+
 #ifdef THOROTTLED_PARALLEL
         for (int j = 0; j < this->image_height; j++) {
                 threads.push_back (std::thread ([&, j] {
                         sem.acquire ();
 
+                        TRACE_SCOPE_ARG ("render row", "row", j);
+
                         for (int i = 0; i < this->image_width; i++)
                                 pixels[i + j * image_width] = this->sample_pixel (world, i, j);
 
+                        STATS_FLUSH ();
                         sem.release ();
                         progress.release ();
                 }));
@@ -459,9 +884,12 @@ void Camera::render_multithreaded (World *world, const char *filename, int max_t
                 sem.acquire ();
 
                 threads.push_back (std::thread ([&, j] {
+                        TRACE_SCOPE_ARG ("render row", "row", j);
+
                         for (int i = 0; i < this->image_width; i++)
                                 pixels[i + j * image_width] = this->sample_pixel (world, i, j);
 
+                        STATS_FLUSH ();
                         sem.release ();
                         progress.release ();
                 }));
@@ -473,7 +901,13 @@ void Camera::render_multithreaded (World *world, const char *filename, int max_t
         for (std::thread &t : threads)
                 t.join ();
 
+        if (this->denoise)
+                pixels = Denoiser (this->framebuffer).run (max_threads);
+
         this->export_p6 (filename, pixels);
+        this->heatmap.write (filename);
+        this->framebuffer.write (filename, this->aovs);
+        STATS_REPORT (this->stats_file);
 }
 
 void Camera::render (World *world, const char *filename)
@@ -485,16 +919,36 @@ void Camera::render (World *world, const char *filename)
                      << this->image_width << ' ' << this->image_height << "\n"
                      << "255"
                      << "\n";
+
+        if (this->use_wavefront) {
+                WavefrontIntegrator integrator (this, world);
+                this->export_p6 (filename, integrator.render (1));
+                STATS_REPORT (this->stats_file);
+                return;
+        }
+
         progressbar bar (image_height);
 
+        this->heatmap = Heatmap (this->heatmaps, this->image_width, this->image_height);
+        this->framebuffer = FrameBuffer (this->aovs | (this->denoise ? Denoiser::guides : 0), this->image_width,
+                                         this->image_height, this->samples_per_pixel);
+
         std::vector<Vec3> pixels;
 
         for (int j = 0; j < this->image_height; j++) {
                 bar.update ();
 
+                TRACE_SCOPE_ARG ("render row", "row", j);
+
                 for (int i = 0; i < this->image_width; i++)
                         pixels.push_back (this->sample_pixel (world, i, j));
         }
 
+        if (this->denoise)
+                pixels = Denoiser (this->framebuffer).run (1);
+
         this->export_p6 (filename, pixels);
+        this->heatmap.write (filename);
+        this->framebuffer.write (filename, this->aovs);
+        STATS_REPORT (this->stats_file);
 }
@@ -0,0 +1,219 @@
+#include "denoiser.hpp"
+#include "framebuffer.hpp"
+#include "trace.hpp"
+#include "vec3.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#define DENOISER_ITERATIONS 5
+#define DENOISER_TILE 64
+// albedo the lighting is divided by at least, so that black surfaces do not blow it up
+#define DENOISER_MIN_ALBEDO 0.01
+// edge-stopping strengths, see denoiser.hpp
+#define DENOISER_SIGMA_LUMINANCE 4.0
+#define DENOISER_SIGMA_NORMAL 128.0
+#define DENOISER_SIGMA_DEPTH 1.0
+#define DENOISER_SIGMA_ALBEDO 0.2
+
+const int Denoiser::guides = 1 << FrameBuffer::Beauty | 1 << FrameBuffer::Albedo | 1 << FrameBuffer::Normal |
+                             1 << FrameBuffer::Depth | 1 << FrameBuffer::Emission | 1 << FrameBuffer::Variance;
+
+// B3 spline, the à-trous kernel
+static const double kernel[5] = { 1.0 / 16, 1.0 / 4, 3.0 / 8, 1.0 / 4, 1.0 / 16 };
+
+static double luminance (Vec3 c)
+{
+        return 0.2126 * c[0] + 0.7152 * c[1] + 0.0722 * c[2];
+}
+
+static Vec3 demodulation (Vec3 albedo)
+{
+        return Vec3 (std::max (albedo[0], DENOISER_MIN_ALBEDO), std::max (albedo[1], DENOISER_MIN_ALBEDO),
+                     std::max (albedo[2], DENOISER_MIN_ALBEDO));
+}
+
+Denoiser::Denoiser (FrameBuffer &framebuffer) : width (framebuffer.width), height (framebuffer.height)
+{
+        std::vector<Vec3> beauty = framebuffer.buffer (FrameBuffer::Beauty);
+        std::vector<Vec3> depth = framebuffer.buffer (FrameBuffer::Depth);
+        std::vector<Vec3> variance = framebuffer.buffer (FrameBuffer::Variance);
+        size_t size = beauty.size ();
+
+        this->emission = framebuffer.buffer (FrameBuffer::Emission);
+        this->albedo = framebuffer.buffer (FrameBuffer::Albedo);
+        this->normal = framebuffer.buffer (FrameBuffer::Normal);
+        this->depth.resize (size);
+        this->depth_gradient.resize (size);
+        this->lighting.resize (size);
+        this->variance.resize (size);
+
+        for (size_t p = 0; p < size; p++) {
+                Vec3 a = demodulation (this->albedo[p]);
+                Vec3 reflected = beauty[p] - this->emission[p];
+
+                this->depth[p] = depth[p][0];
+                this->lighting[p] = Vec3 (reflected[0] / a[0], reflected[1] / a[1], reflected[2] / a[2]);
+                // luminance is a weighted sum of the channels, their variances add up with the weights squared
+                this->variance[p] = 0.2126 * 0.2126 * variance[p][0] / (a[0] * a[0]) +
+                                    0.7152 * 0.7152 * variance[p][1] / (a[1] * a[1]) +
+                                    0.0722 * 0.0722 * variance[p][2] / (a[2] * a[2]);
+        }
+
+        // central differences, one sided next to the border and the background
+        for (int y = 0; y < this->height; y++) {
+                for (int x = 0; x < this->width; x++) {
+                        size_t p = x + size_t (y) * this->width;
+                        double g[2] = { 0, 0 };
+
+                        if (this->depth[p] == 0)
+                                continue;
+
+                        for (int axis = 0; axis < 2; axis++) {
+                                int dx = axis == 0, dy = axis == 1;
+                                int n = 0;
+
+                                for (int side = -1; side <= 1; side += 2) {
+                                        int qx = x + side * dx, qy = y + side * dy;
+
+                                        if (qx < 0 || qy < 0 || qx >= this->width || qy >= this->height)
+                                                continue;
+
+                                        double z = this->depth[qx + size_t (qy) * this->width];
+
+                                        if (z == 0)
+                                                continue;
+
+                                        g[axis] += std::fabs (z - this->depth[p]);
+                                        n++;
+                                }
+
+                                if (n)
+                                        g[axis] /= n;
+                        }
+
+                        this->depth_gradient[p] = std::sqrt (g[0] * g[0] + g[1] * g[1]);
+                }
+        }
+}
+
+/**
+        One à-trous pass over the pixels [x0, x1) x [y0, y1), taps step
+        pixels apart, from this->lighting and this->variance into lighting
+        and variance.
+ */
+void Denoiser::_pass (int step, int x0, int y0, int x1, int y1, std::vector<Vec3> &lighting,
+                      std::vector<double> &variance)
+{
+        for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                        size_t p = x + size_t (y) * this->width;
+
+                        if (this->depth[p] == 0) {
+                                lighting[p] = this->lighting[p];
+                                variance[p] = this->variance[p];
+                                continue;
+                        }
+
+                        // the variance estimate of a single pixel is noisy itself, it is blurred over 3 x 3
+                        double local_variance = 0, taps = 0;
+
+                        for (int dy = -1; dy <= 1; dy++)
+                                for (int dx = -1; dx <= 1; dx++)
+                                        if (x + dx >= 0 && y + dy >= 0 && x + dx < this->width &&
+                                            y + dy < this->height) {
+                                                local_variance += this->variance[x + dx + size_t (y + dy) * this->width];
+                                                taps++;
+                                        }
+
+                        double sigma_luminance = DENOISER_SIGMA_LUMINANCE * std::sqrt (local_variance / taps) + 1e-10;
+                        double l = luminance (this->lighting[p]);
+
+                        Vec3 sum (0, 0, 0);
+                        double weights = 0, variance_sum = 0;
+
+                        for (int ky = 0; ky < 5; ky++) {
+                                for (int kx = 0; kx < 5; kx++) {
+                                        int qx = x + (kx - 2) * step, qy = y + (ky - 2) * step;
+
+                                        if (qx < 0 || qy < 0 || qx >= this->width || qy >= this->height)
+                                                continue;
+
+                                        size_t q = qx + size_t (qy) * this->width;
+
+                                        if (this->depth[q] == 0)
+                                                continue;
+
+                                        double distance = step * std::sqrt (double ((kx - 2) * (kx - 2) +
+                                                                                     (ky - 2) * (ky - 2)));
+                                        double w_luminance = std::fabs (l - luminance (this->lighting[q])) /
+                                                             sigma_luminance;
+                                        double w_depth = std::fabs (this->depth[p] - this->depth[q]) /
+                                                         (DENOISER_SIGMA_DEPTH * this->depth_gradient[p] * distance +
+                                                          1e-10);
+                                        double w_albedo = (this->albedo[p] - this->albedo[q]).length_squared () /
+                                                          (DENOISER_SIGMA_ALBEDO * DENOISER_SIGMA_ALBEDO);
+                                        double w_normal = std::pow (
+                                                std::max (0.0, this->normal[p].dot (this->normal[q])),
+                                                DENOISER_SIGMA_NORMAL);
+
+                                        double w = kernel[kx] * kernel[ky] * w_normal *
+                                                   std::exp (-w_luminance - w_depth - w_albedo);
+
+                                        if (q == p)
+                                                w = kernel[kx] * kernel[ky];
+
+                                        sum += this->lighting[q] * w;
+                                        weights += w;
+                                        variance_sum += w * w * this->variance[q];
+                                }
+                        }
+
+                        lighting[p] = sum / weights;
+                        variance[p] = variance_sum / (weights * weights);
+                }
+        }
+}
+
+std::vector<Vec3> Denoiser::run (int nthreads)
+{
+        TRACE_SCOPE ("denoise");
+
+        std::vector<Vec3> lighting (this->lighting.size ());
+        std::vector<double> variance (this->variance.size ());
+        int tiles_x = (this->width + DENOISER_TILE - 1) / DENOISER_TILE;
+        int tiles = tiles_x * ((this->height + DENOISER_TILE - 1) / DENOISER_TILE);
+
+        nthreads = std::clamp (nthreads, 1, std::max (tiles, 1));
+
+        for (int i = 0; i < DENOISER_ITERATIONS; i++) {
+                std::atomic<int> next_tile = 0;
+                std::vector<std::thread> threads;
+
+                for (int t = 0; t < nthreads; t++) {
+                        threads.push_back (std::thread ([&, i] {
+                                for (int tile = next_tile++; tile < tiles; tile = next_tile++) {
+                                        int x0 = tile % tiles_x * DENOISER_TILE, y0 = tile / tiles_x * DENOISER_TILE;
+
+                                        this->_pass (1 << i, x0, y0, std::min (x0 + DENOISER_TILE, this->width),
+                                                     std::min (y0 + DENOISER_TILE, this->height), lighting, variance);
+                                }
+                        }));
+                }
+
+                for (std::thread &t : threads)
+                        t.join ();
+
+                std::swap (this->lighting, lighting);
+                std::swap (this->variance, variance);
+        }
+
+        std::vector<Vec3> pixels (this->lighting.size ());
+
+        for (size_t p = 0; p < pixels.size (); p++)
+                pixels[p] = this->lighting[p] * demodulation (this->albedo[p]) + this->emission[p];
+
+        return pixels;
+}
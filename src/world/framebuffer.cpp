@@ -0,0 +1,152 @@
+#include "framebuffer.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+const char *FrameBuffer::names[AOV::Count] = { "beauty", "albedo", "normal",   "depth",   "id",
+                                               "emission", "direct", "indirect", "variance" };
+
+FrameBuffer::FrameBuffer () : width (0), height (0), aovs (0), samples (0)
+{
+}
+
+FrameBuffer::FrameBuffer (int aovs, int width, int height, int samples)
+        : width (width), height (height), aovs (aovs), samples (samples)
+{
+        // the variance is worked out from the beauty's sum of squares
+        if (this->has (AOV::Variance))
+                this->aovs |= 1 << AOV::Beauty;
+
+        for (int k = 0; k < AOV::Count; k++)
+                if (this->has (AOV (k)))
+                        this->sums[k].resize (size_t (width) * height);
+}
+
+int FrameBuffer::parse (const char *aovs)
+{
+        int parsed = 0;
+        std::string list (aovs);
+        size_t begin = 0;
+
+        while (begin <= list.size ()) {
+                size_t end = std::min (list.find (',', begin), list.size ());
+                std::string aov = list.substr (begin, end - begin);
+                int k = 0;
+
+                if (aov == "all") {
+                        parsed |= (1 << AOV::Count) - 1;
+                } else {
+                        while (k < AOV::Count && aov != FrameBuffer::names[k])
+                                k++;
+
+                        if (k == AOV::Count)
+                                return -1;
+
+                        parsed |= 1 << k;
+                }
+
+                begin = end + 1;
+        }
+
+        return parsed;
+}
+
+/**
+        Three floats per pixel in the byte order of the host (a negative
+        scale means little endian), rows from the bottom up.
+ */
+bool FrameBuffer::write_pfm (const char *filename, int width, int height, std::vector<Vec3> &pixels)
+{
+        FILE *fp = fopen (filename, "wb");
+
+        if (!fp)
+                return false;
+
+        std::vector<float> row (size_t (width) * 3);
+
+        fprintf (fp, "PF\n%d %d\n%s\n", width, height, std::endian::native == std::endian::little ? "-1.0" : "1.0");
+
+        for (int j = height - 1; j >= 0; j--) {
+                for (int i = 0; i < width; i++)
+                        for (int c = 0; c < 3; c++)
+                                row[3 * i + c] = pixels[i + size_t (j) * width][c];
+
+                fwrite (row.data (), sizeof (float), row.size (), fp);
+        }
+
+        return fclose (fp) == 0;
+}
+
+void FrameBuffer::add (int i, int j, Sample &sample, bool first)
+{
+        size_t p = i + size_t (j) * this->width;
+
+        for (int k = 0; k < AOV::Count; k++) {
+                if (!this->has (AOV (k)))
+                        continue;
+
+                if (k == AOV::Variance)
+                        this->sums[k][p] += sample[AOV::Beauty] * sample[AOV::Beauty];
+                else if (k != AOV::ObjectID)
+                        this->sums[k][p] += sample[AOV (k)];
+                else if (first)
+                        this->sums[k][p] = sample[AOV (k)];
+        }
+}
+
+std::vector<Vec3> FrameBuffer::buffer (AOV aov)
+{
+        std::vector<Vec3> pixels (this->sums[aov]);
+        double n = this->samples;
+
+        if (aov == AOV::ObjectID || pixels.empty ())
+                return pixels;
+
+        for (size_t p = 0; p < pixels.size (); p++) {
+                pixels[p] /= n;
+
+                // E[x^2] - E[x]^2 of the samples, over n for the variance of their mean
+                if (aov == AOV::Variance) {
+                        Vec3 mean = this->sums[AOV::Beauty][p] / n;
+                        Vec3 variance = (pixels[p] - mean * mean) / std::max (n - 1, 1.0);
+
+                        pixels[p] = Vec3 (std::max (variance[0], 0.0), std::max (variance[1], 0.0),
+                                          std::max (variance[2], 0.0));
+                }
+        }
+
+        return pixels;
+}
+
+void FrameBuffer::write (const char *filename, int aovs)
+{
+        if (!aovs)
+                return;
+
+        std::string name (filename);
+        size_t dot = name.rfind ('.');
+        size_t slash = name.rfind ('/');
+
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+                dot = name.size ();
+
+        for (int k = 0; k < AOV::Count; k++) {
+                if (!(aovs & (1 << k)) || !this->has (AOV (k)))
+                        continue;
+
+                std::string aov_file = name.substr (0, dot) + "_" + FrameBuffer::names[k] + ".pfm";
+                std::vector<Vec3> pixels = this->buffer (AOV (k));
+
+                if (FrameBuffer::write_pfm (aov_file.c_str (), this->width, this->height, pixels))
+                        log_info ("Wrote %s AOV to %s", FrameBuffer::names[k], aov_file.c_str ());
+                else
+                        log_error ("Failed to write %s AOV to %s: %s", FrameBuffer::names[k], aov_file.c_str (),
+                                   strerror (errno));
+        }
+}
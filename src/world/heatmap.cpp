@@ -0,0 +1,148 @@
+#include "heatmap.hpp"
+#include "stats.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <time.h>
+#include <vector>
+
+// share of the pixels drawn below full scale
+#define HEATMAP_PERCENTILE 0.99
+
+static const char *kind_names[] = { "nodes", "tests", "time" };
+
+Heatmap::Heatmap () : kinds (0), width (0), height (0)
+{
+}
+
+Heatmap::Heatmap (int kinds, int width, int height)
+        : kinds (kinds), width (width), height (height), costs (kinds ? size_t (width) * height : 0)
+{
+}
+
+Heatmap::Cost Heatmap::Cost::now ()
+{
+        Cost cost = {};
+
+#ifdef RT_STATS
+        cost.nodes = RenderStats::local.bvh_nodes + RenderStats::local.mesh_nodes;
+        cost.tests = RenderStats::local.bvh_leaf_objects + RenderStats::local.triangle_tests;
+#endif
+
+        // CPU time of the thread, so that pixels are not charged for time other threads ran
+        struct timespec time;
+
+        clock_gettime (CLOCK_THREAD_CPUTIME_ID, &time);
+        cost.ns = uint64_t (time.tv_sec) * 1000000000 + time.tv_nsec;
+
+        return cost;
+}
+
+int Heatmap::parse (const char *kinds)
+{
+        int parsed = 0;
+        std::string list (kinds);
+        size_t begin = 0;
+
+        while (begin <= list.size ()) {
+                size_t end = std::min (list.find (',', begin), list.size ());
+                std::string kind = list.substr (begin, end - begin);
+
+                if (kind == "all")
+                        parsed |= Kind::All;
+                else if (kind == kind_names[0])
+                        parsed |= Kind::Nodes;
+                else if (kind == kind_names[1])
+                        parsed |= Kind::Tests;
+                else if (kind == kind_names[2])
+                        parsed |= Kind::Time;
+                else
+                        return -1;
+
+                begin = end + 1;
+        }
+
+        return parsed;
+}
+
+Vec3 Heatmap::false_colour (double t)
+{
+        static const Vec3 stops[] = { Vec3 (0, 0, 0.5), Vec3 (0, 0.5, 1), Vec3 (0, 1, 0.5),
+                                      Vec3 (1, 1, 0),   Vec3 (1, 0, 0) };
+        const int last = sizeof (stops) / sizeof (stops[0]) - 1;
+
+        t = clamp (0, t, 1) * last;
+
+        int stop = std::min (int (t), last - 1);
+
+        Vec3 from = stops[stop], to = stops[stop + 1];
+
+        return from + (to - from) * (t - stop);
+}
+
+void Heatmap::write (const char *filename)
+{
+        if (!this->kinds)
+                return;
+
+        std::string name (filename);
+        size_t dot = name.rfind ('.');
+        size_t slash = name.rfind ('/');
+
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+                dot = name.size ();
+
+        for (int k = 0; k < 3; k++) {
+                if (!(this->kinds & (1 << k)))
+                        continue;
+
+                std::vector<double> values (this->costs.size ());
+
+                for (size_t p = 0; p < this->costs.size (); p++)
+                        values[p] = k == 0 ? this->costs[p].nodes : k == 1 ? this->costs[p].tests : this->costs[p].ns;
+
+                std::vector<double> sorted (values);
+                size_t rank = size_t (HEATMAP_PERCENTILE * (sorted.size () - 1));
+
+                std::nth_element (sorted.begin (), sorted.begin () + rank, sorted.end ());
+
+                double scale = sorted[rank] > 0 ? sorted[rank] : *std::max_element (values.begin (), values.end ());
+                double mean = 0;
+
+                for (double v : values)
+                        mean += v / values.size ();
+
+                std::string heatmap_file = name.substr (0, dot) + "_" + kind_names[k] + ".ppm";
+                FILE *fp = fopen (heatmap_file.c_str (), "wb");
+
+                if (!fp) {
+                        log_error ("Failed to write heatmap %s: %s", heatmap_file.c_str (), strerror (errno));
+                        continue;
+                }
+
+                std::vector<uint8_t> pixel_data (values.size () * 3);
+
+                for (size_t p = 0; p < values.size (); p++) {
+                        Vec3 colour = Heatmap::false_colour (scale > 0 ? values[p] / scale : 0);
+
+                        for (int c = 0; c < 3; c++)
+                                pixel_data[3 * p + c] = uint8_t (clamp (0, colour[c], 0.999) * 256);
+                }
+
+                fprintf (fp, "P6\n%d %d\n255\n", this->width, this->height);
+                fwrite (pixel_data.data (), pixel_data.size (), 1, fp);
+                fclose (fp);
+
+                if (k == 2)
+                        log_info ("Wrote %s heatmap to %s: mean %.3f ms, full scale %.3f ms per pixel", kind_names[k],
+                                  heatmap_file.c_str (), mean / 1e6, scale / 1e6);
+                else
+                        log_info ("Wrote %s heatmap to %s: mean %.1f, full scale %.0f per pixel", kind_names[k],
+                                  heatmap_file.c_str (), mean, scale);
+        }
+}
@@ -1,7 +1,15 @@
 #include "hitrecord.hpp"
+#include "instance.hpp"
+#include "material.hpp"
+#include "ray.hpp"
+#include "smooth_object.hpp"
 #include "vec3.hpp"
+#include <algorithm>
+#include <cmath>
 
-HitRecord::HitRecord () : hit_point (0, 0, 0), normal (0, 0, 0)
+HitRecord::HitRecord ()
+        : hit_point (0, 0, 0), normal (0, 0, 0), instance (nullptr), root (nullptr), material (HIT_NO_MATERIAL), time (0),
+          has_differentials (false), dudx (0), dvdx (0), dudy (0), dvdy (0)
 {
 }
 
@@ -22,4 +30,101 @@ void HitRecord::setNormal (Ray r, Vec3 outward_normal)
 Vec3 HitRecord::outward_normal ()
 {
         return this->front_face ? this->normal : -this->normal;
+}
+
+// uv of a world space point near the hit, in the object's own space
+static Vec3 object_uv (HitRecord &record, Vec3 point)
+{
+        if (record.instance)
+                point = record.instance->to_object_point (point - record.instance->motion_offset (record.time));
+
+        return record.object->to_uv (point - record.object->motion_offset (record.time));
+}
+
+/**
+        Fills in the footprint of r at the hit. uv is evaluated at both ends
+        of dpdx/dpdy so that the difference does not depend on how the object
+        places its texture; u wraps around, so steps over the seam are taken
+        the short way.
+
+        With a normal map, the shading normal is looked up again over the
+        footprint instead of at a single texel.
+ */
+void HitRecord::differentials (Ray &r)
+{
+        this->has_differentials = false;
+
+        if (!this->object || !r.footprint (this->hit_point, this->normal, this->dpdx, this->dpdy))
+                return;
+
+        Vec3 uv = object_uv (*this, this->hit_point);
+        Vec3 uvx = object_uv (*this, this->hit_point + this->dpdx) - uv;
+        Vec3 uvy = object_uv (*this, this->hit_point + this->dpdy) - uv;
+
+        auto seam = [] (double du) { return du - std::round (du); };
+
+        this->dudx = seam (uvx[0]);
+        this->dvdx = uvx[1];
+        this->dudy = seam (uvy[0]);
+        this->dvdy = uvy[1];
+        this->has_differentials = true;
+
+        if (this->object->material && this->object->material->normal_map)
+                this->setNormal (r, this->object->shading_normal (*this, this->footprint ()));
+}
+
+/**
+        Differentials of the mirror reflection out of in, treating the
+        surface as flat over the footprint.
+ */
+void HitRecord::reflect_differentials (Ray &in, Ray &out)
+{
+        out.has_differentials = this->has_differentials;
+
+        if (!out.has_differentials)
+                return;
+
+        out.rx_origin = this->hit_point + this->dpdx;
+        out.ry_origin = this->hit_point + this->dpdy;
+        out.rx_direction = in.rx_direction.unit ().reflect (this->normal);
+        out.ry_direction = in.ry_direction.unit ().reflect (this->normal);
+}
+
+/**
+        Same as reflect_differentials () for the refraction out of in, mu is
+        the ratio of refractive indices used for out. The differentials are
+        dropped if an offset ray would be totally internally reflected.
+ */
+void HitRecord::refract_differentials (Ray &in, Ray &out, double mu)
+{
+        out.has_differentials = this->has_differentials;
+
+        if (!out.has_differentials)
+                return;
+
+        Ray rx (this->hit_point + this->dpdx, in.rx_direction.unit ());
+        Ray ry (this->hit_point + this->dpdy, in.ry_direction.unit ());
+
+        if (!rx.can_refract (this->normal, mu) || !ry.can_refract (this->normal, mu)) {
+                out.has_differentials = false;
+                return;
+        }
+
+        out.rx_origin = rx.origin;
+        out.ry_origin = ry.origin;
+        out.rx_direction = rx.direction.refract (this->normal, mu);
+        out.ry_direction = ry.direction.refract (this->normal, mu);
+}
+
+/**
+        Width of the footprint in texture coordinates, 0 without
+        differentials (i.e. no filtering beyond the finest level).
+ */
+double HitRecord::footprint ()
+{
+        if (!this->has_differentials)
+                return 0;
+
+        return std::max (std::sqrt (this->dudx * this->dudx + this->dvdx * this->dvdx),
+                         std::sqrt (this->dudy * this->dudy + this->dvdy * this->dvdy));
 }
\ No newline at end of file
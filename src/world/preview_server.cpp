@@ -0,0 +1,350 @@
+#include "preview_server.hpp"
+#include "camera.hpp"
+#include "lib/json.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define PREVIEW_TILE 32
+
+using json = nlohmann::json;
+
+static Vec3 read_vec3 (json &value)
+{
+        return Vec3 (value.at (0).get<double> (), value.at (1).get<double> (), value.at (2).get<double> ());
+}
+
+PreviewServer::PreviewServer (Camera *camera, World *world, int nthreads)
+        : camera (camera), world (world), nthreads (std::max (nthreads, 1)), client (-1), shutdown (false),
+          generation (0), closed (false), samples (0), target (camera->samples_per_pixel)
+{
+}
+
+bool PreviewServer::serve (const char *path)
+{
+        struct sockaddr_un address;
+
+        memset (&address, 0, sizeof (address));
+        address.sun_family = AF_UNIX;
+
+        if (strlen (path) >= sizeof (address.sun_path)) {
+                log_error ("Socket path %s is too long", path);
+                return false;
+        }
+
+        strcpy (address.sun_path, path);
+
+        struct stat existing;
+
+        // a socket left behind by an earlier server is replaced, anything else is left alone
+        if (lstat (path, &existing) == 0) {
+                if (!S_ISSOCK (existing.st_mode)) {
+                        log_error ("Failed to listen on %s: the file exists and is not a socket", path);
+                        return false;
+                }
+
+                unlink (path);
+        }
+
+        int server = socket (AF_UNIX, SOCK_STREAM, 0);
+
+        if (server < 0 || bind (server, (struct sockaddr *)&address, sizeof (address)) < 0 || listen (server, 1) < 0) {
+                log_error ("Failed to listen on %s: %s", path, strerror (errno));
+
+                if (server >= 0)
+                        close (server);
+
+                return false;
+        }
+
+        // a client that goes away is noticed when writing to it fails
+        signal (SIGPIPE, SIG_IGN);
+
+        log_info ("Serving previews on %s", path);
+
+        while (!this->shutdown) {
+                this->client = accept (server, nullptr, nullptr);
+
+                if (this->client < 0) {
+                        if (errno == EINTR)
+                                continue;
+
+                        log_error ("Failed to accept a preview client: %s", strerror (errno));
+                        break;
+                }
+
+                log_info ("Preview client connected");
+                this->_session ();
+                close (this->client);
+                log_info ("Preview client disconnected");
+        }
+
+        close (server);
+        unlink (path);
+
+        return true;
+}
+
+/**
+        Renders passes until the image is complete, then waits for the
+        client. Lines are applied in batches between passes, followed by a
+        restart of the image.
+ */
+void PreviewServer::_session ()
+{
+        this->closed = false;
+        this->lines.clear ();
+
+        std::thread receiver (&PreviewServer::_receive, this);
+
+        this->_restart ();
+
+        while (true) {
+                std::deque<std::string> batch;
+
+                {
+                        std::unique_lock<std::mutex> guard (this->lock);
+
+                        this->received.wait (guard, [this] {
+                                return !this->lines.empty () || this->closed || this->samples < this->target;
+                        });
+
+                        if (this->closed)
+                                break;
+
+                        batch.swap (this->lines);
+                }
+
+                if (!batch.empty ()) {
+                        bool stop = false;
+
+                        for (std::string &line : batch)
+                                stop |= !this->_apply (line);
+
+                        if (stop)
+                                break;
+
+                        this->_restart ();
+                        continue;
+                }
+
+                // 1, 1, 2, 4, ... samples, so that every pass doubles the samples
+                int samples = std::min (std::max (this->samples, 1), this->target - this->samples);
+
+                if (this->_pass (samples, this->generation) && this->samples >= this->target)
+                        this->_send (json{ { "type", "done" }, { "samples", this->samples } }.dump ());
+        }
+
+        // unblocks the receiver if the session ended on a shutdown
+        ::shutdown (this->client, SHUT_RDWR);
+        receiver.join ();
+}
+
+/**
+        Reads the client's lines, each one cancels the pass in progress.
+ */
+void PreviewServer::_receive ()
+{
+        std::string buffer;
+        char data[4096];
+        ssize_t size;
+
+        while ((size = read (this->client, data, sizeof (data))) > 0) {
+                buffer.append (data, size);
+
+                size_t newline;
+
+                while ((newline = buffer.find ('\n')) != std::string::npos) {
+                        std::lock_guard<std::mutex> guard (this->lock);
+
+                        this->lines.push_back (buffer.substr (0, newline));
+                        buffer.erase (0, newline + 1);
+                        this->generation++;
+                        this->received.notify_one ();
+                }
+        }
+
+        std::lock_guard<std::mutex> guard (this->lock);
+
+        this->closed = true;
+        this->generation++;
+        this->received.notify_one ();
+}
+
+/**
+        Applies an edit to the camera, returns false if the client asked the
+        server to shut down.
+ */
+bool PreviewServer::_apply (std::string &line)
+{
+        Camera *camera = this->camera;
+
+        try {
+                json edit = json::parse (line);
+                Camera::View view = camera->view ();
+
+                if (edit.value ("shutdown", false)) {
+                        this->shutdown = true;
+                        return false;
+                }
+
+                if (edit.contains ("lookfrom"))
+                        view.lookfrom = read_vec3 (edit["lookfrom"]);
+                if (edit.contains ("lookat"))
+                        view.lookat = read_vec3 (edit["lookat"]);
+                if (edit.contains ("vup"))
+                        view.vup = read_vec3 (edit["vup"]);
+                if (edit.contains ("sensor_shift")) {
+                        view.sensor_shift[0] = edit["sensor_shift"].at (0).get<double> ();
+                        view.sensor_shift[1] = edit["sensor_shift"].at (1).get<double> ();
+                }
+
+                view.vfov = edit.value ("vfov", view.vfov);
+                view.focus_dist = edit.value ("focus_dist", view.focus_dist);
+                view.defocus_angle = edit.value ("defocus_angle", view.defocus_angle);
+                camera->image_width = std::max (1, edit.value ("image_width", camera->image_width));
+                camera->max_depth = std::max (1, edit.value ("max_depth", camera->max_depth));
+                this->target = std::max (1, edit.value ("samples_per_pixel", this->target));
+
+                camera->set_view (view);
+        } catch (json::exception &e) {
+                this->_send (json{ { "type", "error" }, { "message", e.what () } }.dump ());
+        }
+
+        return true;
+}
+
+void PreviewServer::_restart ()
+{
+        this->sum.assign (size_t (this->camera->image_width) * this->camera->image_height, Vec3 (0, 0, 0));
+        this->samples = 0;
+
+        this->_send (json{ { "type", "frame" },
+                           { "width", this->camera->image_width },
+                           { "height", this->camera->image_height } }
+                             .dump ());
+}
+
+/**
+        Adds samples to every pixel, tile by tile on the server's threads,
+        and sends each tile once it is done. Returns false if a line from
+        the client cancelled the pass, some pixels then lack its samples.
+ */
+bool PreviewServer::_pass (int samples, uint64_t generation)
+{
+        TRACE_SCOPE_ARG ("preview pass", "samples", samples);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+        int width = this->camera->image_width, height = this->camera->image_height;
+        int tiles_x = (width + PREVIEW_TILE - 1) / PREVIEW_TILE;
+        int tiles = tiles_x * ((height + PREVIEW_TILE - 1) / PREVIEW_TILE);
+        std::atomic<int> next_tile = 0;
+        std::atomic<bool> cancelled = false;
+        std::vector<std::thread> threads;
+
+        this->camera->samples_per_pixel = samples;
+
+        for (int t = 0; t < this->nthreads; t++) {
+                threads.push_back (std::thread ([&] {
+                        std::vector<uint8_t> pixels (PREVIEW_TILE * PREVIEW_TILE * 3);
+
+                        for (int tile = next_tile++; tile < tiles; tile = next_tile++) {
+                                if (this->generation != generation) {
+                                        cancelled = true;
+                                        break;
+                                }
+
+                                int x0 = tile % tiles_x * PREVIEW_TILE, y0 = tile / tiles_x * PREVIEW_TILE;
+                                int x1 = std::min (x0 + PREVIEW_TILE, width), y1 = std::min (y0 + PREVIEW_TILE, height);
+                                size_t k = 0;
+
+                                for (int j = y0; j < y1; j++) {
+                                        for (int i = x0; i < x1; i++) {
+                                                Vec3 &sum = this->sum[i + size_t (j) * width];
+
+                                                sum += this->camera->sample_pixel (this->world, i, j) * samples;
+
+                                                Vec3 color = sum / double (this->samples + samples);
+
+                                                for (int c = 0; c < 3; c++)
+                                                        pixels[k++] = uint8_t (clamp (0, std::sqrt (color[c]), 0.999) * 256);
+                                        }
+                                }
+
+                                this->_send (json{ { "type", "tile" },
+                                                   { "x", x0 },
+                                                   { "y", y0 },
+                                                   { "width", x1 - x0 },
+                                                   { "height", y1 - y0 },
+                                                   { "samples", this->samples + samples } }
+                                                     .dump (),
+                                             pixels.data (), k);
+                        }
+
+                        STATS_FLUSH ();
+                }));
+        }
+
+        for (std::thread &t : threads)
+                t.join ();
+
+        if (cancelled)
+                return false;
+
+        this->samples += samples;
+
+        double seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>> (std::chrono::steady_clock::now () - start)
+                        .count ();
+
+        this->_send (json{ { "type", "pass" }, { "samples", this->samples }, { "seconds", seconds } }.dump ());
+
+        return true;
+}
+
+/**
+        Writes a message line followed by data, returns false if the client
+        has gone.
+ */
+bool PreviewServer::_send (std::string header, const uint8_t *data, size_t size)
+{
+        std::lock_guard<std::mutex> guard (this->send_lock);
+
+        header += '\n';
+
+        const char *parts[2] = { header.data (), (const char *)data };
+        size_t sizes[2] = { header.size (), size };
+
+        for (int part = 0; part < 2; part++) {
+                for (size_t sent = 0; sent < sizes[part];) {
+                        ssize_t n = write (this->client, parts[part] + sent, sizes[part] - sent);
+
+                        if (n < 0 && errno == EINTR)
+                                continue;
+
+                        if (n <= 0)
+                                return false;
+
+                        sent += n;
+                }
+        }
+
+        return true;
+}
@@ -0,0 +1,123 @@
+#include "stats.hpp"
+
+#ifdef RT_STATS
+
+#include "camera.hpp"
+#include "lib/json.hpp"
+#include "utils.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+using json = nlohmann::json;
+
+static_assert (sizeof (RenderStats) % sizeof (uint64_t) == 0, "RenderStats::flush adds the totals up as uint64_t");
+
+static std::mutex stats_lock;
+static RenderStats stats_total = {};
+
+static const char *stage_names[int (StatsStage::Count)] = { "generate", "intersect", "shade", "shadow" };
+
+void RenderStats::flush ()
+{
+        RenderStats &local = RenderStats::local;
+
+        local.primary_rays += Camera::ray_counts.primary;
+        local.secondary_rays += Camera::ray_counts.secondary;
+        local.shadow_rays += Camera::ray_counts.shadow;
+        Camera::ray_counts = {};
+
+        std::lock_guard<std::mutex> guard (stats_lock);
+
+        // every field is a counter, so the totals are added up field by field
+        uint64_t *total = (uint64_t *)&stats_total;
+        uint64_t *counts = (uint64_t *)&local;
+
+        for (size_t i = 0; i < sizeof (RenderStats) / sizeof (uint64_t); i++)
+                total[i] += counts[i];
+
+        local = {};
+}
+
+static double ratio (uint64_t a, uint64_t b)
+{
+        return b ? double (a) / b : 0;
+}
+
+void RenderStats::report (const char *json_file)
+{
+        // the calling thread may have rendered too
+        RenderStats::flush ();
+
+        std::lock_guard<std::mutex> guard (stats_lock);
+        RenderStats &s = stats_total;
+
+        uint64_t rays = s.primary_rays + s.secondary_rays + s.shadow_rays;
+        uint64_t paths = 0, bounces = 0, stage_total = 0;
+
+        for (int i = 0; i < STATS_PATH_LENGTHS; i++) {
+                paths += s.path_lengths[i];
+                bounces += i * s.path_lengths[i];
+        }
+
+        for (int i = 0; i < int (StatsStage::Count); i++)
+                stage_total += s.stage_ns[i];
+
+        fprintf (stderr, "Render statistics:\n");
+        fprintf (stderr, "  %-28s %14llu\n", "primary rays", (unsigned long long)s.primary_rays);
+        fprintf (stderr, "  %-28s %14llu\n", "secondary rays", (unsigned long long)s.secondary_rays);
+        fprintf (stderr, "  %-28s %14llu\n", "shadow rays", (unsigned long long)s.shadow_rays);
+        fprintf (stderr, "  %-28s %14.2f\n", "BVH nodes per ray", ratio (s.bvh_nodes, rays));
+        fprintf (stderr, "  %-28s %14.2f\n", "BVH leaf objects per ray", ratio (s.bvh_leaf_objects, rays));
+        fprintf (stderr, "  %-28s %14.2f\n", "mesh nodes per ray", ratio (s.mesh_nodes, rays));
+        fprintf (stderr, "  %-28s %14.2f\n", "triangle tests per ray", ratio (s.triangle_tests, rays));
+        fprintf (stderr, "  %-28s %13.1f%%\n", "triangle tests that hit", 100 * ratio (s.triangle_hits, s.triangle_tests));
+        fprintf (stderr, "  %-28s %14.2f\n", "mean path length", ratio (bounces, paths));
+        fprintf (stderr, "  %-28s %13.1f%%\n", "paths escaped", 100 * ratio (s.escaped, paths));
+        fprintf (stderr, "  %-28s %13.1f%%\n", "paths ended on an emitter", 100 * ratio (s.emitted, paths));
+        fprintf (stderr, "  %-28s %13.1f%%\n", "paths ended at max depth", 100 * ratio (s.max_depth, paths));
+
+        for (int i = 0; i < int (StatsStage::Count); i++)
+                if (s.stage_ns[i])
+                        fprintf (stderr, "  %-28s %12.3fs %5.1f%%\n", stage_names[i], s.stage_ns[i] / 1e9,
+                                 100 * ratio (s.stage_ns[i], stage_total));
+
+        fprintf (stderr, "  leaf sizes visited:\n");
+
+        for (int b = 0; b < STATS_LEAF_SIZES; b++)
+                if (s.leaf_sizes[b])
+                        fprintf (stderr, "    %6llu - %-6llu %14llu\n", b ? 1ull << (b - 1) : 0ull,
+                                 b ? (1ull << b) - 1 : 0ull, (unsigned long long)s.leaf_sizes[b]);
+
+        if (json_file) {
+                json report;
+
+                report["rays"] = { { "primary", s.primary_rays },
+                                   { "secondary", s.secondary_rays },
+                                   { "shadow", s.shadow_rays } };
+                report["bvh"] = { { "nodes", s.bvh_nodes }, { "leaf_objects", s.bvh_leaf_objects } };
+                report["mesh"] = { { "nodes", s.mesh_nodes },
+                                   { "triangle_tests", s.triangle_tests },
+                                   { "triangle_hits", s.triangle_hits } };
+                report["leaf_sizes"] = s.leaf_sizes;
+                report["path_lengths"] = s.path_lengths;
+                report["terminations"] = { { "escaped", s.escaped },
+                                           { "emitted", s.emitted },
+                                           { "max_depth", s.max_depth } };
+
+                for (int i = 0; i < int (StatsStage::Count); i++)
+                        report["stage_seconds"][stage_names[i]] = s.stage_ns[i] / 1e9;
+
+                std::ofstream out (json_file);
+
+                if (out)
+                        out << report.dump (4) << std::endl;
+                else
+                        log_error ("Failed to write render statistics to %s", json_file);
+        }
+
+        stats_total = {};
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include "trace.hpp"
+#include <cstdio>
+#include <mutex>
+#include <unistd.h>
+
+/**
+        Complete ("X") events with microsecond timestamps, one track per
+        thread that recorded anything.
+ */
+bool Trace::write (const char *filename)
+{
+        FILE *fp = fopen (filename, "w");
+
+        if (!fp)
+                return false;
+
+        std::lock_guard<std::mutex> guard (Trace::_lock);
+        int pid = getpid ();
+        bool first = true;
+
+        fprintf (fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+        for (std::unique_ptr<Buffer> &buffer : Trace::_buffers) {
+                fprintf (fp, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %u, "
+                             "\"args\": {\"name\": \"%s %u\"}}",
+                         first ? "" : ",\n", pid, buffer->thread, buffer->thread == 1 ? "main" : "thread",
+                         buffer->thread);
+                first = false;
+
+                for (Event &event : buffer->events) {
+                        fprintf (fp, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f",
+                                 event.name, pid, buffer->thread, event.start / 1e3, (event.end - event.start) / 1e3);
+
+                        if (event.arg_name)
+                                fprintf (fp, ", \"args\": {\"%s\": %lld}", event.arg_name, (long long)event.arg);
+
+                        fprintf (fp, "}");
+                }
+        }
+
+        fprintf (fp, "\n]}\n");
+        fclose (fp);
+
+        return true;
+}
@@ -0,0 +1,128 @@
+#include "views.hpp"
+#include "animation.hpp"
+#include "camera.hpp"
+#include "lib/json.hpp"
+#include "vec3.hpp"
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+
+static Vec3 read_vec3 (json &value)
+{
+        if (!value.is_array () || value.size () != 3)
+                throw std::runtime_error ("views: expected [x, y, z]");
+
+        return Vec3 (value[0].get<double> (), value[1].get<double> (), value[2].get<double> ());
+}
+
+static Camera::View read_view (json &value, Camera::View view)
+{
+        if (!value.is_object ())
+                throw std::runtime_error ("views: expected a view object");
+
+        if (value.contains ("lookfrom"))
+                view.lookfrom = read_vec3 (value["lookfrom"]);
+
+        if (value.contains ("lookat"))
+                view.lookat = read_vec3 (value["lookat"]);
+
+        if (value.contains ("vup"))
+                view.vup = read_vec3 (value["vup"]);
+
+        if (value.contains ("sensor_shift")) {
+                json &shift = value["sensor_shift"];
+
+                if (!shift.is_array () || shift.size () != 2)
+                        throw std::runtime_error ("views: expected a [x, y] sensor_shift");
+
+                view.sensor_shift[0] = shift[0].get<double> ();
+                view.sensor_shift[1] = shift[1].get<double> ();
+        }
+
+        view.vfov = value.value ("vfov", view.vfov);
+        view.focus_dist = value.value ("focus_dist", view.focus_dist);
+        view.defocus_angle = value.value ("defocus_angle", view.defocus_angle);
+
+        return view;
+}
+
+Views::Views ()
+{
+}
+
+Views::Views (const char *filename, Camera::View camera)
+{
+        std::ifstream file (filename);
+
+        if (!file)
+                throw std::runtime_error (std::string ("could not open views file ") + filename);
+
+        try {
+                json views = json::parse (file);
+
+                if (views.contains ("views")) {
+                        if (!views["views"].is_array ())
+                                throw std::runtime_error ("views: expected a list of views");
+
+                        for (json &view : views["views"])
+                                this->views.push_back (
+                                        std::make_pair (view.value ("name", std::string ()), read_view (view, camera)));
+                }
+
+                if (views.contains ("turntable")) {
+                        json &turntable = views["turntable"];
+
+                        this->turntable (turntable.value ("views", 0), read_view (turntable, camera));
+                }
+        } catch (json::exception &e) {
+                throw std::runtime_error (std::string ("error reading views file ") + filename + ": " + e.what ());
+        }
+}
+
+bool Views::empty ()
+{
+        return this->views.empty ();
+}
+
+/**
+        Adds n views of the camera turned around the vup axis through
+        lookat, starting with the camera as it is.
+ */
+void Views::turntable (int n, Camera::View camera)
+{
+        Vec3 axis = camera.vup.unit ();
+        Vec3 offset = camera.lookfrom - camera.lookat;
+
+        for (int k = 0; k < n; k++) {
+                Camera::View view = camera;
+
+                view.lookfrom = camera.lookat + offset.rotate (axis, 2 * M_PI * k / n);
+                this->views.push_back (std::make_pair (std::string (), view));
+        }
+}
+
+/**
+        The output file of a view, see views.hpp. A single unnamed view is
+        written to filename.
+ */
+std::string Views::filename (const char *filename, size_t view)
+{
+        std::string &name = this->views[view].first;
+
+        if (name.empty ())
+                return Animation::frame_filename (filename, int (view), int (this->views.size ()));
+
+        std::string file (filename);
+        size_t dot = file.rfind ('.');
+        size_t slash = file.rfind ('/');
+
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+                dot = file.size ();
+
+        return file.substr (0, dot) + "_" + name + file.substr (dot);
+}
@@ -0,0 +1,370 @@
+#include "wavefront.hpp"
+#include "camera.hpp"
+#include "hitrecord.hpp"
+#include "material_table.hpp"
+#include "progress_bar.hpp"
+#include "ray.hpp"
+#include "smooth_object.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
+#include "vec3.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// paths in flight per thread
+#define WAVEFRONT_QUEUE_SIZE 8192
+
+WavefrontIntegrator::WavefrontIntegrator (Camera *camera, World *world)
+        : camera (camera), world (world), next_row (0), progress (0)
+{
+}
+
+std::vector<Vec3> WavefrontIntegrator::render (int nthreads)
+{
+        int image_height = this->camera->image_height;
+
+        this->pixels.assign (size_t (this->camera->image_width) * image_height, Vec3 (0, 0, 0));
+        this->row_samples.assign (image_height, 0);
+        this->next_row = 0;
+
+        std::vector<Queue> queues (std::max (1, nthreads));
+        std::vector<std::thread> threads;
+
+        progressbar bar (image_height);
+
+        threads.push_back (std::thread ([&] {
+                auto start_time = std::chrono::high_resolution_clock::now ();
+                for (int p = 0; p < image_height; p++) {
+                        this->progress.acquire ();
+                        bar.update ();
+                }
+                auto end_time = std::chrono::high_resolution_clock::now ();
+                int time_elapsed =
+                        std::chrono::duration_cast<std::chrono::milliseconds> (end_time - start_time).count ();
+                std::cerr << "Render took " << time_elapsed / 1000.0 << " secs.";
+                std::cerr << "\n";
+        }));
+
+        for (Queue &queue : queues)
+                threads.push_back (std::thread ([&] { this->_worker (queue); }));
+
+        for (std::thread &t : threads)
+                t.join ();
+
+        return this->pixels;
+}
+
+void WavefrontIntegrator::_worker (Queue &queue)
+{
+        TRACE_SCOPE ("wavefront worker");
+
+        Paths &paths = queue.paths;
+
+        paths.rays.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.records.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.throughput.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.radiance.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.pending.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.pending_light.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.mis_pdf.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.depth.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.terminal.resize (WAVEFRONT_QUEUE_SIZE);
+        paths.pixel.resize (WAVEFRONT_QUEUE_SIZE);
+
+        // handed out from the back, lowest slots first
+        for (uint32_t s = WAVEFRONT_QUEUE_SIZE; s > 0; s--)
+                queue.free.push_back (s - 1);
+
+        queue.row = -1;
+        queue.column = 0;
+        queue.sample = 0;
+
+        for (;;) {
+                {
+                        STATS_TIME (StatsStage::Generate);
+                        this->_generate (queue);
+                }
+
+                if (queue.active.empty ())
+                        break;
+
+                {
+                        STATS_TIME (StatsStage::Intersect);
+                        this->_extend (queue);
+                }
+
+                {
+                        STATS_TIME (StatsStage::Shade);
+                        this->_shade (queue);
+                }
+
+                {
+                        STATS_TIME (StatsStage::Shadow);
+                        this->_shadow (queue);
+                }
+        }
+
+        STATS_FLUSH ();
+}
+
+/**
+        Fills the free slots with camera rays, taking whole rows from the
+        shared row counter so that every pixel is only ever written by one
+        thread. Returns false once every row has been handed out.
+ */
+bool WavefrontIntegrator::_generate (Queue &queue)
+{
+        Paths &paths = queue.paths;
+
+        int image_width = this->camera->image_width;
+        int image_height = this->camera->image_height;
+        int samples_per_pixel = this->camera->samples_per_pixel;
+
+        // each sample only covers part of the pixel
+        double spread = std::max (0.125, 1 / std::sqrt (double (samples_per_pixel)));
+
+        while (!queue.free.empty ()) {
+                if (queue.row >= image_height)
+                        return false;
+
+                if (queue.row < 0 || queue.column == image_width) {
+                        queue.row = this->next_row++;
+                        queue.column = 0;
+                        queue.sample = 0;
+
+                        if (queue.row >= image_height)
+                                return false;
+
+                        this->row_samples[queue.row] = image_width * samples_per_pixel;
+                }
+
+                uint32_t s = queue.free.back ();
+                queue.free.pop_back ();
+
+                Ray r = this->camera->ray (queue.column + random_double (-0.5, 0.5),
+                                           queue.row + random_double (-0.5, 0.5));
+
+                r.scale_differentials (spread);
+
+                paths.rays[s] = r;
+                paths.throughput[s] = Vec3 (1, 1, 1);
+                paths.radiance[s] = Vec3 (0, 0, 0);
+                paths.pending_light[s] = nullptr;
+                paths.mis_pdf[s] = 0;
+                paths.depth[s] = 0;
+                paths.terminal[s] = this->camera->max_depth <= 0;
+                paths.pixel[s] = uint32_t (queue.row) * image_width + queue.column;
+
+                queue.active.push_back (s);
+
+                if (++queue.sample == samples_per_pixel) {
+                        queue.sample = 0;
+                        queue.column++;
+                }
+        }
+
+        return true;
+}
+
+/**
+        Intersects every active path and settles the light samples waiting
+        on that intersection. Paths that miss pick up the background and are
+        retired along with the terminal ones, the others go on to shade.
+ */
+void WavefrontIntegrator::_extend (Queue &queue)
+{
+        Paths &paths = queue.paths;
+
+        queue.hits.clear ();
+
+        for (uint32_t s : queue.active) {
+                HitRecord &record = paths.records[s];
+
+                record = HitRecord ();
+
+                if (paths.depth[s] == 0)
+                        Camera::ray_counts.primary++;
+                else
+                        Camera::ray_counts.secondary++;
+
+                bool hit = this->world->hit (paths.rays[s], record);
+
+                if (paths.pending_light[s]) {
+                        if (!hit || record.object != paths.pending_light[s])
+                                paths.radiance[s] += paths.pending[s];
+
+                        paths.pending_light[s] = nullptr;
+                }
+
+                if (paths.terminal[s]) {
+                        this->_retire (queue, s);
+                } else if (!hit) {
+                        paths.radiance[s] += paths.throughput[s] * this->camera->escaped (paths.rays[s], paths.mis_pdf[s]);
+                        STATS_ADD (escaped, 1);
+                        STATS_PATH (paths.depth[s]);
+                        this->_retire (queue, s);
+                } else {
+                        queue.hits.push_back (s);
+                }
+        }
+
+        queue.active.clear ();
+}
+
+/**
+        Scatters every path that hit something. The hits are counting sorted
+        by material id first, so each material is shaded as one batch.
+ */
+void WavefrontIntegrator::_shade (Queue &queue)
+{
+        Paths &paths = queue.paths;
+        ShadowRays &shadows = queue.shadows;
+
+        queue.counts.assign (MaterialTable::records.size () + 1, 0);
+
+        for (uint32_t s : queue.hits)
+                queue.counts[paths.records[s].material + 1]++;
+
+        for (size_t i = 1; i < queue.counts.size (); i++)
+                queue.counts[i] += queue.counts[i - 1];
+
+        queue.shade.resize (queue.hits.size ());
+
+        for (uint32_t s : queue.hits)
+                queue.shade[queue.counts[paths.records[s].material]++] = s;
+
+        for (uint32_t s : queue.shade) {
+                Ray &ray = paths.rays[s];
+                HitRecord &record = paths.records[s];
+
+                record.differentials (ray);
+
+                double pdf;
+                Vec3 brdf;
+                MaterialRecord &material = MaterialTable::get (record.material);
+                Vec3 scatter_dir = material.scatter (ray, record, brdf, pdf);
+                double lambert_cos = scatter_dir.unit ().dot (record.normal.unit ());
+
+                Vec3 throughput = paths.throughput[s];
+
+                paths.radiance[s] += throughput * material.emission;
+                paths.mis_pdf[s] = 0;
+
+                if (this->camera->environment_light) {
+                        Vec3 direction, radiance;
+
+                        if (this->camera->unoccluded_environment (ray, record, direction, radiance)) {
+                                paths.mis_pdf[s] = pdf;
+
+                                if (radiance != Vec3::zero ()) {
+                                        shadows.slot.push_back (s);
+                                        shadows.origin.push_back (record.hit_point);
+                                        shadows.target.push_back (Vec3 (0, 0, 0));
+                                        shadows.direction.push_back (direction);
+                                        shadows.radiance.push_back (throughput * radiance);
+                                        shadows.light.push_back (nullptr);
+                                }
+                        }
+                }
+
+                // bounces happen at the time of the camera ray, for motion blur
+                Ray next (record.hit_point, scatter_dir, ray.time);
+
+                material.differentials (ray, record, next);
+                next.nudge_forward ();
+
+                if (this->camera->use_light_sampling) {
+                        SmoothObject *light;
+                        Vec3 light_point;
+
+                        Vec3 radiance = this->camera->unoccluded_light (this->world, record, light, light_point);
+
+                        if (radiance != Vec3::zero ()) {
+                                shadows.slot.push_back (s);
+                                shadows.origin.push_back (record.hit_point);
+                                shadows.target.push_back (light_point);
+                                shadows.direction.push_back (Vec3 (0, 0, 0));
+                                shadows.radiance.push_back (throughput * radiance);
+                                shadows.light.push_back (light);
+                        }
+                }
+
+                paths.rays[s] = next;
+                paths.throughput[s] = throughput * brdf * lambert_cos / pdf;
+                paths.terminal[s] = material.emissive || ++paths.depth[s] >= this->camera->max_depth;
+
+                if (material.emissive) {
+                        STATS_ADD (emitted, 1);
+                        STATS_PATH (paths.depth[s] + 1);
+                } else if (paths.terminal[s]) {
+                        STATS_ADD (max_depth, 1);
+                        STATS_PATH (paths.depth[s]);
+                }
+        }
+}
+
+/**
+        Traces the queued shadow rays, then retires the terminal paths that
+        have no light sample waiting on their next intersection. The rest
+        make up the next extend stage.
+ */
+void WavefrontIntegrator::_shadow (Queue &queue)
+{
+        Paths &paths = queue.paths;
+        ShadowRays &shadows = queue.shadows;
+
+        Camera::ray_counts.shadow += shadows.slot.size ();
+
+        for (size_t i = 0; i < shadows.slot.size (); i++) {
+                uint32_t s = shadows.slot[i];
+
+                if (shadows.light[i]) {
+                        if (this->world->has_path (shadows.origin[i], shadows.target[i])) {
+                                paths.pending[s] = shadows.radiance[i];
+                                paths.pending_light[s] = shadows.light[i];
+                        }
+                } else {
+                        HitRecord blocker;
+                        Ray shadow (shadows.origin[i], shadows.direction[i]);
+
+                        shadow.nudge_forward ();
+
+                        if (!this->world->hit (shadow, blocker))
+                                paths.radiance[s] += shadows.radiance[i];
+                }
+        }
+
+        shadows.slot.clear ();
+        shadows.origin.clear ();
+        shadows.target.clear ();
+        shadows.direction.clear ();
+        shadows.radiance.clear ();
+        shadows.light.clear ();
+
+        for (uint32_t s : queue.shade) {
+                if (paths.terminal[s] && !paths.pending_light[s])
+                        this->_retire (queue, s);
+                else
+                        queue.active.push_back (s);
+        }
+}
+
+void WavefrontIntegrator::_retire (Queue &queue, uint32_t slot)
+{
+        uint32_t pixel = queue.paths.pixel[slot];
+
+        this->pixels[pixel] += queue.paths.radiance[slot] / double (this->camera->samples_per_pixel);
+
+        queue.free.push_back (slot);
+
+        if (--this->row_samples[pixel / this->camera->image_width] == 0)
+                this->progress.release ();
+}
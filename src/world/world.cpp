@@ -6,19 +6,29 @@
 #include "progress_bar.hpp"
 #include "ray.hpp"
 #include "smooth_object.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
 #include "vec3.hpp"
+#include <algorithm>
 #include <cfloat>
 #include <cstdlib>
+#include <string>
 #include <utility>
 #include <vector>
 
-World::World ()
+// see World::update ()
+#define WORLD_BVH_REBUILD_RATIO 1.5
+
+World::World () : _built (false)
 {
 }
 
 void World::add (Object *obj)
 {
         this->objects.push_back (obj);
+        this->_ids[obj] = this->objects.size ();
+        // fall back to testing every object until the BVH is rebuilt
+        this->_built = false;
 
         SmoothObject *smooth_obj = dynamic_cast<SmoothObject *> (obj);
 
@@ -29,31 +39,108 @@ void World::add (Object *obj)
                 this->emissives.push_back (smooth_obj);
 }
 
+void World::add (Object *obj, std::string name)
+{
+        this->add (obj);
+        this->named_objects[name] = obj;
+}
+
+Object *World::find (std::string name)
+{
+        auto it = this->named_objects.find (name);
+
+        return it == this->named_objects.end () ? nullptr : it->second;
+}
+
+uint32_t World::id (Object *obj)
+{
+        auto it = this->_ids.find (obj);
+
+        return it == this->_ids.end () ? 0 : it->second;
+}
+
 void World::add_light (Light *light)
 {
         this->lights.push_back (light);
 }
 
+/**
+        Builds the BVH over all objects that have bounds. Call once the scene
+        is complete, before rendering.
+ */
+void World::build ()
+{
+        TRACE_SCOPE ("BVH build");
+
+        std::vector<Object *> bounded;
+        Vec3 min, max;
+
+        this->unbounded.clear ();
+
+        for (Object *obj : this->objects) {
+                if (obj->bounds (0, min, max))
+                        bounded.push_back (obj);
+                else
+                        this->unbounded.push_back (obj);
+        }
+
+        this->bvh = BVH (bounded);
+        this->_built = true;
+}
+
+/**
+        Call after objects have moved, e.g. between the frames of an
+        animation. The BVH is refit in place, and only rebuilt once refitting
+        has grown its node area WORLD_BVH_REBUILD_RATIO times since the last
+        build.
+ */
+void World::update ()
+{
+        if (!this->_built) {
+                this->build ();
+                return;
+        }
+
+        double degradation;
+
+        {
+                TRACE_SCOPE ("BVH refit");
+                degradation = this->bvh.refit ();
+        }
+
+        if (degradation > WORLD_BVH_REBUILD_RATIO) {
+                log_info ("Rebuilding BVH, refit node area grew %.2fx since the last build", degradation);
+                this->build ();
+        }
+}
+
 bool World::hit (Ray r, HitRecord &record)
 {
-        HitRecord curr_record;
-        
         double lambda_min = 0.001;
         double lambda_max = DBL_MAX;
 
         bool hit_anything = false;
 
-        for (Object *obj : this->objects) {
+        if (this->_built)
+                hit_anything = this->bvh.hit (r, record, lambda_min, lambda_max);
+
+        for (Object *obj : this->_built ? this->unbounded : this->objects) {
+                HitRecord curr_record;
+
                 if (!obj->hit (r, curr_record))
                         continue;
 
                 if (curr_record.lambda < lambda_max && curr_record.lambda > lambda_min) {
                         lambda_max = curr_record.lambda;
                         record = curr_record;
+                        record.root = obj;
                         hit_anything = true;
                 }
         }
 
+        if (hit_anything && record.material == HIT_NO_MATERIAL && record.object->material)
+                record.material = record.object->material->id;
+
         return hit_anything;
 }
 
@@ -100,7 +187,9 @@ SmoothObject *World::random_light ()
         if (this->emissives.size() == 0)
                 return nullptr;
 
-        return this->emissives[rand () % this->emissives.size ()];
+        size_t index = size_t (random_double (0, 1) * this->emissives.size ());
+
+        return this->emissives[std::min (index, this->emissives.size () - 1)];
 }
 
 Vec3 World::photon_map_color (Vec3 point)
@@ -122,6 +211,8 @@ Vec3 World::photon_map_color (Vec3 point)
 
 void World::photon_map_forward_pass ()
 {
+        TRACE_SCOPE ("photon pass");
+
         int rays_per_light = 1e6;
         int max_depth = 10;
         progressbar bar (rays_per_light * this->lights.size ());